@@ -0,0 +1,248 @@
+//====================================================================================================
+// Filename:    GBBatteryWriter.cpp
+// Created by:  Jeff Padgham
+// Description: Background writer for battery saves. The emulation thread hands over a snapshot of the
+//              cartridge ram, or asks for a mapped .sav to be synced, and returns right away. Bursts
+//              of saves are coalesced into a single write, which goes to a temp file that is renamed
+//              over the .sav so a crash never leaves half a save behind.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBBatteryWriter.h"
+
+#include "GBMappedFile.h"
+
+#include "CLog.h"
+
+#include <stdio.h>
+#include <fstream>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#endif
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBBatteryWriter::GBBatteryWriter() :
+    m_pPendingFile( NULL ),
+    m_bPending( false ),
+    m_bBusy( false ),
+    m_bDrain( false ),
+    m_bStop( false ),
+    m_u32Writes( 0 ),
+    m_u32Coalesced( 0 ),
+    m_u64BytesWritten( 0 ),
+    m_u32LastLatency( 0 ),
+    m_u32MaxLatency( 0 )
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+GBBatteryWriter::~GBBatteryWriter()
+{
+    Stop();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::Submit( const std::string& strFilepath, const ubyte* pu8Data, uint32 u32Size )
+{
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    m_Pending.assign( pu8Data, pu8Data + u32Size );
+    m_strPendingPath    = strFilepath;
+    m_pPendingFile      = NULL;
+
+    QueueLocked();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::SubmitSync( GBMappedFile* pFile )
+{
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    m_pPendingFile = pFile;
+
+    QueueLocked();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::QueueLocked()
+{
+    Clock::time_point oNow = Clock::now();
+
+    if( m_bPending )
+    {
+        ++m_u32Coalesced;
+    }
+    else
+    {
+        m_oFirstSubmit = oNow;
+    }
+
+    m_oLastSubmit   = oNow;
+    m_bPending      = true;
+
+    if( !m_oWriter.joinable() )
+    {
+        m_bStop     = false;
+        m_oWriter   = std::thread( &GBBatteryWriter::WriterThread, this );
+    }
+
+    m_oWake.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::Drain()
+{
+    std::unique_lock<std::mutex> oLock( m_oMutex );
+
+    if( !m_oWriter.joinable() )
+    {
+        return;
+    }
+
+    m_bDrain = true;
+    m_oWake.notify_one();
+
+    while( m_bPending || m_bBusy )
+    {
+        m_oIdle.wait( oLock );
+    }
+
+    m_bDrain = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::Stop()
+{
+    {
+        std::lock_guard<std::mutex> oLock( m_oMutex );
+
+        if( !m_oWriter.joinable() )
+        {
+            return;
+        }
+
+        // The writer finishes what is pending before it exits
+        m_bStop = true;
+        m_oWake.notify_one();
+    }
+
+    m_oWriter.join();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBBatteryWriter::WriterThread()
+{
+    std::unique_lock<std::mutex> oLock( m_oMutex );
+
+    for( ;; )
+    {
+        if( !m_bPending )
+        {
+            if( m_bStop )
+            {
+                break;
+            }
+
+            m_oWake.wait( oLock );
+            continue;
+        }
+
+        // Let a burst of saves settle, but don't hold a save back forever while the game keeps writing
+        Clock::time_point oQuiet    = m_oLastSubmit + std::chrono::milliseconds( kBatteryQuietTime );
+        Clock::time_point oDeadline = m_oFirstSubmit + std::chrono::milliseconds( kBatteryMaxDelay );
+        Clock::time_point oDue      = ( oQuiet < oDeadline ) ? oQuiet : oDeadline;
+
+        if( !m_bStop && !m_bDrain && Clock::now() < oDue )
+        {
+            m_oWake.wait_until( oLock, oDue );
+            continue;
+        }
+
+        GBMappedFile*   pFile       = m_pPendingFile;
+        std::string     strFilepath = m_strPendingPath;
+        m_Writing.swap( m_Pending );
+        m_bPending  = false;
+        m_bBusy     = true;
+
+        oLock.unlock();
+
+        Clock::time_point oStart = Clock::now();
+
+        bool    bWritten    = false;
+        uint64  u64Bytes    = 0;
+        if( NULL != pFile )
+        {
+            pFile->Flush( true );
+
+            bWritten    = true;
+            u64Bytes    = pFile->GetSize();
+        }
+        else
+        {
+            bWritten    = WriteFile( strFilepath, m_Writing );
+            u64Bytes    = m_Writing.size();
+        }
+
+        uint32 u32Latency = static_cast<uint32>( std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - oStart ).count() );
+
+        if( bWritten )
+        {
+            ++m_u32Writes;
+            m_u64BytesWritten   += u64Bytes;
+            m_u32LastLatency    = u32Latency;
+            if( u32Latency > m_u32MaxLatency )
+            {
+                m_u32MaxLatency = u32Latency;
+            }
+        }
+
+        oLock.lock();
+
+        m_bBusy = false;
+        m_oIdle.notify_all();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBBatteryWriter::WriteFile( const std::string& strFilepath, const std::vector<ubyte>& Data )
+{
+    std::string strTempFilepath = strFilepath + ".tmp";
+
+    std::ofstream oFile( strTempFilepath, std::ios::binary );
+    if( !oFile )
+    {
+        Log()->Write( LOG_COLOR_YELLOW, "Unable to write save file!" );
+        return false;
+    }
+
+    oFile.write( reinterpret_cast<const char*>( Data.data() ), Data.size() );
+    oFile.close();
+
+    if( oFile.fail() )
+    {
+        Log()->Write( LOG_COLOR_YELLOW, "Unable to write save file!" );
+        remove( strTempFilepath.c_str() );
+        return false;
+    }
+
+    // The old save stays in place until the new one is complete
+#if defined( _WIN32 )
+    bool bRenamed = 0 != MoveFileExA( strTempFilepath.c_str(), strFilepath.c_str(), MOVEFILE_REPLACE_EXISTING );
+#else
+    bool bRenamed = 0 == rename( strTempFilepath.c_str(), strFilepath.c_str() );
+#endif
+
+    if( !bRenamed )
+    {
+        Log()->Write( LOG_COLOR_YELLOW, "Unable to replace save file!" );
+        remove( strTempFilepath.c_str() );
+    }
+
+    return bRenamed;
+}
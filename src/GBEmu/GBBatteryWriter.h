@@ -0,0 +1,100 @@
+#ifndef GBEMU_GBBATTERYWRITER_H
+#define GBEMU_GBBATTERYWRITER_H
+
+//====================================================================================================
+// Filename:    GBBatteryWriter.h
+// Created by:  Jeff Padgham
+// Description: Background writer for battery saves. The emulation thread hands over a snapshot of the
+//              cartridge ram, or asks for a mapped .sav to be synced, and returns right away. Bursts
+//              of saves are coalesced into a single write, which goes to a temp file that is renamed
+//              over the .sav so a crash never leaves half a save behind.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//====================================================================================================
+// Forward Declarations
+//====================================================================================================
+
+class GBMappedFile;
+
+//====================================================================================================
+// Global enums
+//====================================================================================================
+enum
+{
+    kBatteryQuietTime       = 250,          // Milliseconds without a new save before the writer starts
+    kBatteryMaxDelay        = 1000          // Longest a save waits while the game keeps writing
+};
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBBatteryWriter
+{
+    typedef std::chrono::steady_clock   Clock;
+
+public:
+    // Constructor / destructor
+    GBBatteryWriter();
+    ~GBBatteryWriter();
+
+    // Replace whatever hasn't been written yet. The thread is started by the first save.
+    void                    Submit( const std::string& strFilepath, const ubyte* pu8Data, uint32 u32Size );
+    void                    SubmitSync( GBMappedFile* pFile );
+
+    // Writes anything pending right away and waits for it, Stop also ends the thread
+    void                    Drain();
+    void                    Stop();
+
+    inline uint32           GetWriteCount() const                   { return m_u32Writes;               }
+    inline uint32           GetCoalescedCount() const               { return m_u32Coalesced;            }
+    inline uint64           GetBytesWritten() const                 { return m_u64BytesWritten;         }
+    inline uint32           GetLastLatency() const                  { return m_u32LastLatency;          }
+    inline uint32           GetMaxLatency() const                   { return m_u32MaxLatency;           }
+
+private:
+    void                    QueueLocked();
+    void                    WriterThread();
+    bool                    WriteFile( const std::string& strFilepath, const std::vector<ubyte>& Data );
+
+private:
+    std::mutex              m_oMutex;
+    std::condition_variable m_oWake;            // Signals the writer
+    std::condition_variable m_oIdle;            // Signals Drain
+    std::thread             m_oWriter;
+
+    // Protected by m_oMutex
+    std::vector<ubyte>      m_Pending;
+    std::vector<ubyte>      m_Writing;          // Swapped with m_Pending, so the writer never copies
+    std::string             m_strPendingPath;
+    GBMappedFile*           m_pPendingFile;
+    Clock::time_point       m_oFirstSubmit;
+    Clock::time_point       m_oLastSubmit;
+    bool                    m_bPending;
+    bool                    m_bBusy;
+    bool                    m_bDrain;
+    bool                    m_bStop;
+
+    // Counters, latencies are in microseconds
+    std::atomic<uint32>     m_u32Writes;
+    std::atomic<uint32>     m_u32Coalesced;
+    std::atomic<uint64>     m_u64BytesWritten;
+    std::atomic<uint32>     m_u32LastLatency;
+    std::atomic<uint32>     m_u32MaxLatency;
+};
+
+#endif
@@ -11,6 +11,9 @@
 #include "GBCartridge.h"
 
 #include <string.h>
+#include <stdio.h>
+#include <io.h>
+#include <algorithm>
 #include <fstream>
 
 #include "emutypes.h"
@@ -19,6 +22,7 @@
 #include "GBMemBankController1.h"
 #include "GBMemBankController2.h"
 #include "GBMemBankController3.h"
+#include "GBRomCache.h"
 
 #include "CLog.h"
 
@@ -34,8 +38,10 @@ const uint16 GBCartridge::CARTRIDGE_ENTRY_POINT = 0x100;
 
 GBCartridge::GBCartridge( GBMem* pMemoryModule ) :
     m_pMem( pMemoryModule ),
+    m_pRomImage( NULL ),
     m_pRom( NULL ),
     m_pRam( NULL ),
+    m_u32RamBytes( 0 ),
     m_pMemBankController( NULL ),
     m_szBatteryDirectory( NULL ),
     m_bLoaded( false )
@@ -52,12 +58,26 @@ void GBCartridge::Reset()
 {
     if( m_bLoaded )
     {
-        memset( m_pRam, 0, sizeof( m_pRam ) );
-        m_pMem->LoadMemory( m_pRom, 0, sizeof( ubyte ) * 0x4000 );
+        // A mapped .sav is the ram itself, otherwise save what hasn't been written yet before reloading it
+        if( !m_oRamFile.IsOpen() )
+        {
+            if( HasBattery() && IsRamDirty() )
+            {
+                FlushBattery( false );
+            }
+            m_oBatteryWriter.Drain();
+
+            memset( m_pRam, 0, m_u32RamBytes );
+        }
+
+        m_pMem->MapFixedRomBank( m_pRom );
         m_pMem->SetMemBankController( CreateMemBankController( m_oHeader.u8CartridgeType ) );
 
         // Attempt to load the .sav file for this rom
-        LoadBattery();
+        if( !m_oRamFile.IsOpen() )
+        {
+            LoadBattery();
+        }
     }
 }
 
@@ -77,7 +97,7 @@ bool GBCartridge::LoadFromFile( const char* szFilepath, const char* szBatteryDir
             m_szBatteryDirectory = szBatteryDirectory;
 
             LoadCartridgeHeader( u8CartridgeHeader );
-            bLoaded = LoadCartridge( oFile );
+            bLoaded = LoadCartridge( szFilepath );
         }
 
         oFile.close();
@@ -113,39 +133,68 @@ bool GBCartridge::HasBattery() const
 
 bool GBCartridge::IsRamDirty() const
 {
-    return m_pMemBankController->IsRamDirty();
+    return NULL != m_pMemBankController && m_pMemBankController->IsRamDirty();
 }
 
 //----------------------------------------------------------------------------------------------------
-void GBCartridge::FlushRamToSaveFile( const char *szBatteryDirectory )
+string GBCartridge::GetTitle() const
 {
-    string oPath;
-    oPath.append( szBatteryDirectory )
-         .append( m_oHeader.szTitle )
-         .append( ".sav" );
+    // Titles that fill the whole field have no terminator
+    string oTitle( m_oHeader.szTitle, sizeof( m_oHeader.szTitle ) );
 
-    ofstream oFile( oPath, ios::binary );
-    if( oFile )
-    {
-        oFile.write( reinterpret_cast<char*>( m_pRam ), GetRamSize() );
-        oFile.close();
-    }
-    else
+    return oTitle.substr( 0, oTitle.find( '\0' ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCartridge::UpdateBattery()
+{
+    // Only hands the save to the writer, which coalesces a game saving every frame into a few writes
+    if( HasBattery() && IsRamDirty() )
     {
-        Log()->Write( LOG_COLOR_YELLOW, "Unable to write save file!" );
+        FlushBattery( false );
     }
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBCartridge::Unload()
 {
-    delete m_pRom;
+    // Whatever is still pending has to reach the disk before the ram goes away
+    if( HasBattery() && IsRamDirty() )
+    {
+        FlushBattery( false );
+    }
+    m_oBatteryWriter.Stop();
+
+    if( 0 != m_oBatteryWriter.GetWriteCount() )
+    {
+        Log()->Write( LOG_COLOR_WHITE, "%s: %u battery writes (%u coalesced), %llu bytes, latency last %u us max %u us",
+                      GetTitle().c_str(),
+                      m_oBatteryWriter.GetWriteCount(),
+                      m_oBatteryWriter.GetCoalescedCount(),
+                      m_oBatteryWriter.GetBytesWritten(),
+                      m_oBatteryWriter.GetLastLatency(),
+                      m_oBatteryWriter.GetMaxLatency() );
+    }
+
+    // Unmap the image before it goes away
+    m_pMem->MapFixedRomBank( NULL );
+    m_pMem->SetMemBankController( NULL );
+
+    RomCache()->Release( m_pRomImage );
+    m_pRomImage = NULL;
     m_pRom = NULL;
 
-    delete m_pRam;
+    if( m_oRamFile.IsOpen() )
+    {
+        m_oRamFile.Close();
+    }
+    else
+    {
+        delete[] m_pRam;
+    }
     m_pRam = NULL;
+    m_u32RamBytes = 0;
 
-    m_pMem->SetMemBankController( NULL );
     delete m_pMemBankController;
     m_pMemBankController = NULL;
 
@@ -174,25 +223,44 @@ bool GBCartridge::ValidateCartridgeHeader( ubyte* pHeaderData )
 }
 
 //----------------------------------------------------------------------------------------------------
-bool GBCartridge::LoadCartridge( ifstream& oFile )
+bool GBCartridge::LoadCartridge( const char* szFilepath )
 {
     uint32 u32RomSize = GetRomSize();
     uint32 u32RamSize = GetRamSize();
 
-    m_pRom = new ubyte[ u32RomSize ];
-    memset( m_pRom, 0, u32RomSize );
-
-    oFile.clear();
-    oFile.seekg( 0 );
-    oFile.read( reinterpret_cast<char*>( m_pRom ), u32RomSize );
+    m_pRomImage = RomCache()->Acquire( szFilepath, u32RomSize );
+    if( NULL == m_pRomImage )
+    {
+        return false;
+    }
+    m_pRom = m_pRomImage->pu8Data;
 
-    // Minimum 2k ram
-    if( u32RamSize < 2048 )
+    if(     HasBattery()
+        &&  NULL != m_szBatteryDirectory )
     {
-        u32RamSize = 2048;
+        RenameLegacyBattery();
     }
-    m_pRam = new ubyte[ u32RamSize ];
 
+    // Battery ram is the .sav file itself when one exists and can be mapped, the OS writes it back. A game
+    // without a save yet runs from a buffer and gets its file on the first flush.
+    if(     HasBattery()
+        &&  NULL != m_szBatteryDirectory
+        &&  m_oRamFile.OpenWritable( GetBatteryFilepath( m_szBatteryDirectory ).c_str(), u32RamSize ) )
+    {
+        m_pRam = m_oRamFile.GetData();
+
+        Log()->Write( LOG_COLOR_WHITE, "Save file mapped." );
+    }
+    else
+    {
+        // Minimum 2k ram
+        if( u32RamSize < 2048 )
+        {
+            u32RamSize = 2048;
+        }
+        m_pRam = new ubyte[ u32RamSize ];
+    }
+    m_u32RamBytes = u32RamSize;
     m_bLoaded = true;
 
     Reset();
@@ -205,12 +273,7 @@ void GBCartridge::LoadBattery()
 {
     if( m_szBatteryDirectory )
     {
-        string oPath;
-        oPath.append( m_szBatteryDirectory )
-             .append( m_oHeader.szTitle )
-             .append( ".sav" );
-
-        ifstream oFile( oPath, ios::binary );
+        ifstream oFile( GetBatteryFilepath( m_szBatteryDirectory ), ios::binary );
         if( oFile )
         {
             uint32 u32RamSize = GetRamSize();
@@ -227,10 +290,78 @@ void GBCartridge::LoadBattery()
     }
 }
 
+//----------------------------------------------------------------------------------------------------
+void GBCartridge::FlushBattery( bool bWait )
+{
+    if( m_oRamFile.IsOpen() )
+    {
+        m_oBatteryWriter.SubmitSync( &m_oRamFile );
+    }
+    else if( NULL != m_szBatteryDirectory )
+    {
+        m_oBatteryWriter.Submit( GetBatteryFilepath( m_szBatteryDirectory ), m_pRam, GetRamSize() );
+    }
+
+    if( bWait )
+    {
+        m_oBatteryWriter.Drain();
+    }
+
+    m_pMemBankController->SetRamDirty( false );
+}
+
+//----------------------------------------------------------------------------------------------------
+string GBCartridge::GetBatteryFilepath( const char* szBatteryDirectory ) const
+{
+    string oPath;
+    oPath.append( szBatteryDirectory )
+         .append( GetTitle() )
+         .append( ".sav" );
+
+    return oPath;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCartridge::RenameLegacyBattery()
+{
+    // Saves used to be named after the title field read up to the first zero, which for a title filling
+    // all 11 characters ran on into the manufacturer code
+    const char* szTitle     = m_oHeader.szTitle;
+    const char* szHeaderEnd = reinterpret_cast<const char*>( &m_oHeader ) + sizeof( m_oHeader );
+    string      strLegacyTitle( szTitle, std::find( szTitle, szHeaderEnd, '\0' ) );
+
+    if( strLegacyTitle == GetTitle() )
+    {
+        return;
+    }
+
+    string strFilepath = GetBatteryFilepath( m_szBatteryDirectory );
+    string strLegacyFilepath;
+    strLegacyFilepath.append( m_szBatteryDirectory )
+                     .append( strLegacyTitle )
+                     .append( ".sav" );
+
+    // An existing save under the current name always wins
+    if(     0 != _access( strFilepath.c_str(), 0 )
+        &&  0 == _access( strLegacyFilepath.c_str(), 0 ) )
+    {
+        if( 0 == rename( strLegacyFilepath.c_str(), strFilepath.c_str() ) )
+        {
+            Log()->Write( LOG_COLOR_WHITE, "Renamed save file %s to %s", strLegacyFilepath.c_str(), strFilepath.c_str() );
+        }
+        else
+        {
+            Log()->Write( LOG_COLOR_YELLOW, "Unable to rename save file %s to %s", strLegacyFilepath.c_str(), strFilepath.c_str() );
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------------------
 IGBMemBankController* GBCartridge::CreateMemBankController( ubyte u8CartridgeType )
 {
     IGBMemBankController* pMBC    = NULL;
+    uint32                u32RomBanks = GetRomSize() >> 14;
+    uint32                u32RamBytes = GetRamSize();
 
     // 0-ROM ONLY                   12-ROM+MBC3+RAM
     // 1-ROM+MBC1                   13-ROM+MBC3+RAM+BATT
@@ -263,19 +394,19 @@ IGBMemBankController* GBCartridge::CreateMemBankController( ubyte u8CartridgeTyp
         case 0x01:
         case 0x02:
         case 0x03:
-            pMBC = new GBMemBankController1( m_pRom, m_pRam );
+            pMBC = new GBMemBankController1( m_pRom, u32RomBanks, m_pRam, u32RamBytes );
             break;
         case 0x05:
         case 0x06:
-            pMBC = new GBMemBankController2( m_pRom, m_pRam );
+            pMBC = new GBMemBankController2( m_pRom, u32RomBanks, m_pRam );
             break;
         case 0x0F:
         case 0x10:
-            pMBC = new GBMemBankController3( m_pRom, m_pRam, true );
+            pMBC = new GBMemBankController3( m_pRom, u32RomBanks, m_pRam, u32RamBytes, true );
         case 0x11:
         case 0x12:
         case 0x13:
-            pMBC = new GBMemBankController3( m_pRom, m_pRam );
+            pMBC = new GBMemBankController3( m_pRom, u32RomBanks, m_pRam, u32RamBytes );
             break;
         default:
             assert( "Unimplemented cartridge type!" );
@@ -12,6 +12,8 @@
 //====================================================================================================
 
 #include "emutypes.h"
+#include "GBBatteryWriter.h"
+#include "GBMappedFile.h"
 
 #include <fstream>
 
@@ -27,6 +29,7 @@ using namespace std;
 
 class GBMem;
 class IGBMemBankController;
+struct GBRomImage;
 
 //====================================================================================================
 // Class
@@ -66,25 +69,35 @@ public:
     bool                    LoadFromFile( const char* szFilepath, const char* szBatteryDirectory );
     bool                    HasBattery() const;
     bool                    IsRamDirty() const;
-    void                    FlushRamToSaveFile( const char* szBatteryDirectory );
+    void                    UpdateBattery();
     void                    Unload();
 
     inline bool             IsLoaded() const                        { return m_bLoaded;                 }
+    inline uint32           GetRamBytes() const                     { return m_u32RamBytes;             }
+    string                  GetTitle() const;
+    inline const GBBatteryWriter& GetBatteryWriter() const          { return m_oBatteryWriter;          }
     inline ubyte            ReadRom( uint16 u16Address )            { return m_pRom[ u16Address ];      }
 
 private:
     bool                    ValidateCartridgeHeader( ubyte* pHeaderData );
     void                    LoadCartridgeHeader( ubyte* pHeaderData );
-    bool                    LoadCartridge( ifstream& oFile );
+    bool                    LoadCartridge( const char* szFilepath );
     void                    LoadBattery();
+    void                    FlushBattery( bool bWait );
+    string                  GetBatteryFilepath( const char* szBatteryDirectory ) const;
+    void                    RenameLegacyBattery();
     IGBMemBankController*   CreateMemBankController( ubyte u8CartridgeType );
     uint32                  GetRomSize() const;
     uint32                  GetRamSize() const;
 
 private:
     GBCartridgeHeader       m_oHeader;
+    GBRomImage*             m_pRomImage;            // Shared with every other instance of the game
     ubyte*                  m_pRom;
     ubyte*                  m_pRam;
+    uint32                  m_u32RamBytes;
+    GBMappedFile            m_oRamFile;             // Backs m_pRam with the .sav file when it could be mapped
+    GBBatteryWriter         m_oBatteryWriter;
 
     GBMem*                  m_pMem;
     IGBMemBankController*   m_pMemBankController;
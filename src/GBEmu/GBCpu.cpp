@@ -9,6 +9,9 @@
 //====================================================================================================
 
 #include "GBCpu.h"
+#include "GBCpuBlockCache.h"
+#include "GBCpuTrace.h"
+#include "GBCpuHotSpots.h"
 
 #include "emutypes.h"
 #include "GBMem.h"
@@ -18,29 +21,572 @@
 #include "CLog.h"
 
 #include <stdio.h>
+#include <intrin.h>
 
 //====================================================================================================
 // Static initializers
 //====================================================================================================
 const uint32 GBCpu::CLOCK_SPEED = 4194304;
 
+// Opcode descriptors. Everything here is constant data, the handlers are bound when the program is
+// linked instead of every time a CPU is constructed.
+const GBCpu::OpcodeInfo GBCpu::OPCODE_INFO[ 256 ] =
+{
+    //  Handler                          Mnemonic         Len Cyc Tkn Memory
+    { &GBCpu::OpNOP,                     "NOP",           1,  4,  4, kOpMemNone                 },    // 0x00
+    { &GBCpu::OpLD_rr_nn<BC>,            "LD BC,nn",      3, 12, 12, kOpMemNone                 },    // 0x01
+    { &GBCpu::OpLD_rr_r<BC,A>,           "LD (BC),A",     1,  8,  8, kOpMemWrite                },    // 0x02
+    { &GBCpu::OpINC_rr<BC>,              "INC BC",        1,  8,  8, kOpMemNone                 },    // 0x03
+    { &GBCpu::OpINC_r<B>,                "INC B",         1,  4,  4, kOpMemNone                 },    // 0x04
+    { &GBCpu::OpDEC_r<B>,                "DEC B",         1,  4,  4, kOpMemNone                 },    // 0x05
+    { &GBCpu::OpLD_r_n<B>,               "LD B,n",        2,  8,  8, kOpMemNone                 },    // 0x06
+    { &GBCpu::OpRLCA,                    "RLCA",          1,  4,  4, kOpMemNone                 },    // 0x07
+    { &GBCpu::OpLD_nn_SP,                "LD (nn),SP",    3, 20, 20, kOpMemWrite                },    // 0x08
+    { &GBCpu::OpADD_HL_rr<BC>,           "ADD HL,BC",     1,  8,  8, kOpMemNone                 },    // 0x09
+    { &GBCpu::OpLD_r_rr<A,BC>,           "LD A,(BC)",     1,  8,  8, kOpMemRead                 },    // 0x0A
+    { &GBCpu::OpDEC_rr<BC>,              "DEC BC",        1,  8,  8, kOpMemNone                 },    // 0x0B
+    { &GBCpu::OpINC_r<C>,                "INC C",         1,  4,  4, kOpMemNone                 },    // 0x0C
+    { &GBCpu::OpDEC_r<C>,                "DEC C",         1,  4,  4, kOpMemNone                 },    // 0x0D
+    { &GBCpu::OpLD_r_n<C>,               "LD C,n",        2,  8,  8, kOpMemNone                 },    // 0x0E
+    { &GBCpu::OpRRCA,                    "RRCA",          1,  4,  4, kOpMemNone                 },    // 0x0F
+    { &GBCpu::OpSTOP,                    "STOP",          1,  4,  4, kOpMemNone                 },    // 0x10
+    { &GBCpu::OpLD_rr_nn<DE>,            "LD DE,nn",      3, 12, 12, kOpMemNone                 },    // 0x11
+    { &GBCpu::OpLD_rr_r<DE,A>,           "LD (DE),A",     1,  8,  8, kOpMemWrite                },    // 0x12
+    { &GBCpu::OpINC_rr<DE>,              "INC DE",        1,  8,  8, kOpMemNone                 },    // 0x13
+    { &GBCpu::OpINC_r<D>,                "INC D",         1,  4,  4, kOpMemNone                 },    // 0x14
+    { &GBCpu::OpDEC_r<D>,                "DEC D",         1,  4,  4, kOpMemNone                 },    // 0x15
+    { &GBCpu::OpLD_r_n<D>,               "LD D,n",        2,  8,  8, kOpMemNone                 },    // 0x16
+    { &GBCpu::OpRLA,                     "RLA",           1,  4,  4, kOpMemNone                 },    // 0x17
+    { &GBCpu::OpJR_n,                    "JR e",          2, 12, 12, kOpMemNone                 },    // 0x18
+    { &GBCpu::OpADD_HL_rr<DE>,           "ADD HL,DE",     1,  8,  8, kOpMemNone                 },    // 0x19
+    { &GBCpu::OpLD_r_rr<A,DE>,           "LD A,(DE)",     1,  8,  8, kOpMemRead                 },    // 0x1A
+    { &GBCpu::OpDEC_rr<DE>,              "DEC DE",        1,  8,  8, kOpMemNone                 },    // 0x1B
+    { &GBCpu::OpINC_r<E>,                "INC E",         1,  4,  4, kOpMemNone                 },    // 0x1C
+    { &GBCpu::OpDEC_r<E>,                "DEC E",         1,  4,  4, kOpMemNone                 },    // 0x1D
+    { &GBCpu::OpLD_r_n<E>,               "LD E,n",        2,  8,  8, kOpMemNone                 },    // 0x1E
+    { &GBCpu::OpRRA,                     "RRA",           1,  4,  4, kOpMemNone                 },    // 0x1F
+    { &GBCpu::OpJR_NZ_n,                 "JR NZ,e",       2,  8, 12, kOpMemNone                 },    // 0x20
+    { &GBCpu::OpLD_rr_nn<HL>,            "LD HL,nn",      3, 12, 12, kOpMemNone                 },    // 0x21
+    { &GBCpu::OpLDI_HL_A,                "LDI (HL),A",    1,  8,  8, kOpMemWrite                },    // 0x22
+    { &GBCpu::OpINC_rr<HL>,              "INC HL",        1,  8,  8, kOpMemNone                 },    // 0x23
+    { &GBCpu::OpINC_r<H>,                "INC H",         1,  4,  4, kOpMemNone                 },    // 0x24
+    { &GBCpu::OpDEC_r<H>,                "DEC H",         1,  4,  4, kOpMemNone                 },    // 0x25
+    { &GBCpu::OpLD_r_n<H>,               "LD H,n",        2,  8,  8, kOpMemNone                 },    // 0x26
+    { &GBCpu::OpDAA,                     "DAA",           1,  4,  4, kOpMemNone                 },    // 0x27
+    { &GBCpu::OpJR_Z_n,                  "JR Z,e",        2,  8, 12, kOpMemNone                 },    // 0x28
+    { &GBCpu::OpADD_HL_rr<HL>,           "ADD HL,HL",     1,  8,  8, kOpMemNone                 },    // 0x29
+    { &GBCpu::OpLDI_A_HL,                "LDI A,(HL)",    1,  8,  8, kOpMemRead                 },    // 0x2A
+    { &GBCpu::OpDEC_rr<HL>,              "DEC HL",        1,  8,  8, kOpMemNone                 },    // 0x2B
+    { &GBCpu::OpINC_r<L>,                "INC L",         1,  4,  4, kOpMemNone                 },    // 0x2C
+    { &GBCpu::OpDEC_r<L>,                "DEC L",         1,  4,  4, kOpMemNone                 },    // 0x2D
+    { &GBCpu::OpLD_r_n<L>,               "LD L,n",        2,  8,  8, kOpMemNone                 },    // 0x2E
+    { &GBCpu::OpCPL,                     "CPL",           1,  4,  4, kOpMemNone                 },    // 0x2F
+    { &GBCpu::OpJR_NC_n,                 "JR NC,e",       2,  8, 12, kOpMemNone                 },    // 0x30
+    { &GBCpu::OpLD_SP_nn,                "LD SP,nn",      3, 12, 12, kOpMemNone                 },    // 0x31
+    { &GBCpu::OpLDD_HL_A,                "LDD (HL),A",    1,  8,  8, kOpMemWrite                },    // 0x32
+    { &GBCpu::OpINC_SP,                  "INC SP",        1,  8,  8, kOpMemNone                 },    // 0x33
+    { &GBCpu::OpINC_HL,                  "INC (HL)",      1, 12, 12, kOpMemReadWrite            },    // 0x34
+    { &GBCpu::OpDEC_HL,                  "DEC (HL)",      1, 12, 12, kOpMemReadWrite            },    // 0x35
+    { &GBCpu::OpLD_rr_n<HL>,             "LD (HL),n",     2, 12, 12, kOpMemWrite                },    // 0x36
+    { &GBCpu::OpSCF,                     "SCF",           1,  4,  4, kOpMemNone                 },    // 0x37
+    { &GBCpu::OpJR_C_n,                  "JR C,e",        2,  8, 12, kOpMemNone                 },    // 0x38
+    { &GBCpu::OpADD_HL_SP,               "ADD HL,SP",     1,  8,  8, kOpMemNone                 },    // 0x39
+    { &GBCpu::OpLDD_A_HL,                "LDD A,(HL)",    1,  8,  8, kOpMemRead                 },    // 0x3A
+    { &GBCpu::OpDEC_SP,                  "DEC SP",        1,  8,  8, kOpMemNone                 },    // 0x3B
+    { &GBCpu::OpINC_r<A>,                "INC A",         1,  4,  4, kOpMemNone                 },    // 0x3C
+    { &GBCpu::OpDEC_r<A>,                "DEC A",         1,  4,  4, kOpMemNone                 },    // 0x3D
+    { &GBCpu::OpLD_r_n<A>,               "LD A,n",        2,  8,  8, kOpMemNone                 },    // 0x3E
+    { &GBCpu::OpCCF,                     "CCF",           1,  4,  4, kOpMemNone                 },    // 0x3F
+    { &GBCpu::OpLD_r_r<B,B>,             "LD B,B",        1,  4,  4, kOpMemNone                 },    // 0x40
+    { &GBCpu::OpLD_r_r<B,C>,             "LD B,C",        1,  4,  4, kOpMemNone                 },    // 0x41
+    { &GBCpu::OpLD_r_r<B,D>,             "LD B,D",        1,  4,  4, kOpMemNone                 },    // 0x42
+    { &GBCpu::OpLD_r_r<B,E>,             "LD B,E",        1,  4,  4, kOpMemNone                 },    // 0x43
+    { &GBCpu::OpLD_r_r<B,H>,             "LD B,H",        1,  4,  4, kOpMemNone                 },    // 0x44
+    { &GBCpu::OpLD_r_r<B,L>,             "LD B,L",        1,  4,  4, kOpMemNone                 },    // 0x45
+    { &GBCpu::OpLD_r_rr<B,HL>,           "LD B,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x46
+    { &GBCpu::OpLD_r_r<B,A>,             "LD B,A",        1,  4,  4, kOpMemNone                 },    // 0x47
+    { &GBCpu::OpLD_r_r<C,B>,             "LD C,B",        1,  4,  4, kOpMemNone                 },    // 0x48
+    { &GBCpu::OpLD_r_r<C,C>,             "LD C,C",        1,  4,  4, kOpMemNone                 },    // 0x49
+    { &GBCpu::OpLD_r_r<C,D>,             "LD C,D",        1,  4,  4, kOpMemNone                 },    // 0x4A
+    { &GBCpu::OpLD_r_r<C,E>,             "LD C,E",        1,  4,  4, kOpMemNone                 },    // 0x4B
+    { &GBCpu::OpLD_r_r<C,H>,             "LD C,H",        1,  4,  4, kOpMemNone                 },    // 0x4C
+    { &GBCpu::OpLD_r_r<C,L>,             "LD C,L",        1,  4,  4, kOpMemNone                 },    // 0x4D
+    { &GBCpu::OpLD_r_rr<C,HL>,           "LD C,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x4E
+    { &GBCpu::OpLD_r_r<C,A>,             "LD C,A",        1,  4,  4, kOpMemNone                 },    // 0x4F
+    { &GBCpu::OpLD_r_r<D,B>,             "LD D,B",        1,  4,  4, kOpMemNone                 },    // 0x50
+    { &GBCpu::OpLD_r_r<D,C>,             "LD D,C",        1,  4,  4, kOpMemNone                 },    // 0x51
+    { &GBCpu::OpLD_r_r<D,D>,             "LD D,D",        1,  4,  4, kOpMemNone                 },    // 0x52
+    { &GBCpu::OpLD_r_r<D,E>,             "LD D,E",        1,  4,  4, kOpMemNone                 },    // 0x53
+    { &GBCpu::OpLD_r_r<D,H>,             "LD D,H",        1,  4,  4, kOpMemNone                 },    // 0x54
+    { &GBCpu::OpLD_r_r<D,L>,             "LD D,L",        1,  4,  4, kOpMemNone                 },    // 0x55
+    { &GBCpu::OpLD_r_rr<D,HL>,           "LD D,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x56
+    { &GBCpu::OpLD_r_r<D,A>,             "LD D,A",        1,  4,  4, kOpMemNone                 },    // 0x57
+    { &GBCpu::OpLD_r_r<E,B>,             "LD E,B",        1,  4,  4, kOpMemNone                 },    // 0x58
+    { &GBCpu::OpLD_r_r<E,C>,             "LD E,C",        1,  4,  4, kOpMemNone                 },    // 0x59
+    { &GBCpu::OpLD_r_r<E,D>,             "LD E,D",        1,  4,  4, kOpMemNone                 },    // 0x5A
+    { &GBCpu::OpLD_r_r<E,E>,             "LD E,E",        1,  4,  4, kOpMemNone                 },    // 0x5B
+    { &GBCpu::OpLD_r_r<E,H>,             "LD E,H",        1,  4,  4, kOpMemNone                 },    // 0x5C
+    { &GBCpu::OpLD_r_r<E,L>,             "LD E,L",        1,  4,  4, kOpMemNone                 },    // 0x5D
+    { &GBCpu::OpLD_r_rr<E,HL>,           "LD E,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x5E
+    { &GBCpu::OpLD_r_r<E,A>,             "LD E,A",        1,  4,  4, kOpMemNone                 },    // 0x5F
+    { &GBCpu::OpLD_r_r<H,B>,             "LD H,B",        1,  4,  4, kOpMemNone                 },    // 0x60
+    { &GBCpu::OpLD_r_r<H,C>,             "LD H,C",        1,  4,  4, kOpMemNone                 },    // 0x61
+    { &GBCpu::OpLD_r_r<H,D>,             "LD H,D",        1,  4,  4, kOpMemNone                 },    // 0x62
+    { &GBCpu::OpLD_r_r<H,E>,             "LD H,E",        1,  4,  4, kOpMemNone                 },    // 0x63
+    { &GBCpu::OpLD_r_r<H,H>,             "LD H,H",        1,  4,  4, kOpMemNone                 },    // 0x64
+    { &GBCpu::OpLD_r_r<H,L>,             "LD H,L",        1,  4,  4, kOpMemNone                 },    // 0x65
+    { &GBCpu::OpLD_r_rr<H,HL>,           "LD H,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x66
+    { &GBCpu::OpLD_r_r<H,A>,             "LD H,A",        1,  4,  4, kOpMemNone                 },    // 0x67
+    { &GBCpu::OpLD_r_r<L,B>,             "LD L,B",        1,  4,  4, kOpMemNone                 },    // 0x68
+    { &GBCpu::OpLD_r_r<L,C>,             "LD L,C",        1,  4,  4, kOpMemNone                 },    // 0x69
+    { &GBCpu::OpLD_r_r<L,D>,             "LD L,D",        1,  4,  4, kOpMemNone                 },    // 0x6A
+    { &GBCpu::OpLD_r_r<L,E>,             "LD L,E",        1,  4,  4, kOpMemNone                 },    // 0x6B
+    { &GBCpu::OpLD_r_r<L,H>,             "LD L,H",        1,  4,  4, kOpMemNone                 },    // 0x6C
+    { &GBCpu::OpLD_r_r<L,L>,             "LD L,L",        1,  4,  4, kOpMemNone                 },    // 0x6D
+    { &GBCpu::OpLD_r_rr<L,HL>,           "LD L,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x6E
+    { &GBCpu::OpLD_r_r<L,A>,             "LD L,A",        1,  4,  4, kOpMemNone                 },    // 0x6F
+    { &GBCpu::OpLD_rr_r<HL,B>,           "LD (HL),B",     1,  8,  8, kOpMemWrite                },    // 0x70
+    { &GBCpu::OpLD_rr_r<HL,C>,           "LD (HL),C",     1,  8,  8, kOpMemWrite                },    // 0x71
+    { &GBCpu::OpLD_rr_r<HL,D>,           "LD (HL),D",     1,  8,  8, kOpMemWrite                },    // 0x72
+    { &GBCpu::OpLD_rr_r<HL,E>,           "LD (HL),E",     1,  8,  8, kOpMemWrite                },    // 0x73
+    { &GBCpu::OpLD_rr_r<HL,H>,           "LD (HL),H",     1,  8,  8, kOpMemWrite                },    // 0x74
+    { &GBCpu::OpLD_rr_r<HL,L>,           "LD (HL),L",     1,  8,  8, kOpMemWrite                },    // 0x75
+    { &GBCpu::OpHALT,                    "HALT",          1,  4,  4, kOpMemNone                 },    // 0x76
+    { &GBCpu::OpLD_rr_r<HL,A>,           "LD (HL),A",     1,  8,  8, kOpMemWrite                },    // 0x77
+    { &GBCpu::OpLD_r_r<A,B>,             "LD A,B",        1,  4,  4, kOpMemNone                 },    // 0x78
+    { &GBCpu::OpLD_r_r<A,C>,             "LD A,C",        1,  4,  4, kOpMemNone                 },    // 0x79
+    { &GBCpu::OpLD_r_r<A,D>,             "LD A,D",        1,  4,  4, kOpMemNone                 },    // 0x7A
+    { &GBCpu::OpLD_r_r<A,E>,             "LD A,E",        1,  4,  4, kOpMemNone                 },    // 0x7B
+    { &GBCpu::OpLD_r_r<A,H>,             "LD A,H",        1,  4,  4, kOpMemNone                 },    // 0x7C
+    { &GBCpu::OpLD_r_r<A,L>,             "LD A,L",        1,  4,  4, kOpMemNone                 },    // 0x7D
+    { &GBCpu::OpLD_r_rr<A,HL>,           "LD A,(HL)",     1,  8,  8, kOpMemRead                 },    // 0x7E
+    { &GBCpu::OpLD_r_r<A,A>,             "LD A,A",        1,  4,  4, kOpMemNone                 },    // 0x7F
+    { &GBCpu::OpADD_r_r<A,B>,            "ADD A,B",       1,  4,  4, kOpMemNone                 },    // 0x80
+    { &GBCpu::OpADD_r_r<A,C>,            "ADD A,C",       1,  4,  4, kOpMemNone                 },    // 0x81
+    { &GBCpu::OpADD_r_r<A,D>,            "ADD A,D",       1,  4,  4, kOpMemNone                 },    // 0x82
+    { &GBCpu::OpADD_r_r<A,E>,            "ADD A,E",       1,  4,  4, kOpMemNone                 },    // 0x83
+    { &GBCpu::OpADD_r_r<A,H>,            "ADD A,H",       1,  4,  4, kOpMemNone                 },    // 0x84
+    { &GBCpu::OpADD_r_r<A,L>,            "ADD A,L",       1,  4,  4, kOpMemNone                 },    // 0x85
+    { &GBCpu::OpADD_r_rr<A,HL>,          "ADD A,(HL)",    1,  8,  8, kOpMemRead                 },    // 0x86
+    { &GBCpu::OpADD_r_r<A,A>,            "ADD A,A",       1,  4,  4, kOpMemNone                 },    // 0x87
+    { &GBCpu::OpADC_r_r<A,B>,            "ADC A,B",       1,  4,  4, kOpMemNone                 },    // 0x88
+    { &GBCpu::OpADC_r_r<A,C>,            "ADC A,C",       1,  4,  4, kOpMemNone                 },    // 0x89
+    { &GBCpu::OpADC_r_r<A,D>,            "ADC A,D",       1,  4,  4, kOpMemNone                 },    // 0x8A
+    { &GBCpu::OpADC_r_r<A,E>,            "ADC A,E",       1,  4,  4, kOpMemNone                 },    // 0x8B
+    { &GBCpu::OpADC_r_r<A,H>,            "ADC A,H",       1,  4,  4, kOpMemNone                 },    // 0x8C
+    { &GBCpu::OpADC_r_r<A,L>,            "ADC A,L",       1,  4,  4, kOpMemNone                 },    // 0x8D
+    { &GBCpu::OpADC_r_rr<A,HL>,          "ADC A,(HL)",    1,  8,  8, kOpMemRead                 },    // 0x8E
+    { &GBCpu::OpADC_r_r<A,A>,            "ADC A,A",       1,  4,  4, kOpMemNone                 },    // 0x8F
+    { &GBCpu::OpSUB_r_r<A,B>,            "SUB B",         1,  4,  4, kOpMemNone                 },    // 0x90
+    { &GBCpu::OpSUB_r_r<A,C>,            "SUB C",         1,  4,  4, kOpMemNone                 },    // 0x91
+    { &GBCpu::OpSUB_r_r<A,D>,            "SUB D",         1,  4,  4, kOpMemNone                 },    // 0x92
+    { &GBCpu::OpSUB_r_r<A,E>,            "SUB E",         1,  4,  4, kOpMemNone                 },    // 0x93
+    { &GBCpu::OpSUB_r_r<A,H>,            "SUB H",         1,  4,  4, kOpMemNone                 },    // 0x94
+    { &GBCpu::OpSUB_r_r<A,L>,            "SUB L",         1,  4,  4, kOpMemNone                 },    // 0x95
+    { &GBCpu::OpSUB_r_rr<A,HL>,          "SUB (HL)",      1,  8,  8, kOpMemRead                 },    // 0x96
+    { &GBCpu::OpSUB_r_r<A,A>,            "SUB A",         1,  4,  4, kOpMemNone                 },    // 0x97
+    { &GBCpu::OpSBC_r_r<A,B>,            "SBC A,B",       1,  4,  4, kOpMemNone                 },    // 0x98
+    { &GBCpu::OpSBC_r_r<A,C>,            "SBC A,C",       1,  4,  4, kOpMemNone                 },    // 0x99
+    { &GBCpu::OpSBC_r_r<A,D>,            "SBC A,D",       1,  4,  4, kOpMemNone                 },    // 0x9A
+    { &GBCpu::OpSBC_r_r<A,E>,            "SBC A,E",       1,  4,  4, kOpMemNone                 },    // 0x9B
+    { &GBCpu::OpSBC_r_r<A,H>,            "SBC A,H",       1,  4,  4, kOpMemNone                 },    // 0x9C
+    { &GBCpu::OpSBC_r_r<A,L>,            "SBC A,L",       1,  4,  4, kOpMemNone                 },    // 0x9D
+    { &GBCpu::OpSBC_r_rr<A,HL>,          "SBC A,(HL)",    1,  8,  8, kOpMemRead                 },    // 0x9E
+    { &GBCpu::OpSBC_r_r<A,A>,            "SBC A,A",       1,  4,  4, kOpMemNone                 },    // 0x9F
+    { &GBCpu::OpAND_r_r<A,B>,            "AND B",         1,  4,  4, kOpMemNone                 },    // 0xA0
+    { &GBCpu::OpAND_r_r<A,C>,            "AND C",         1,  4,  4, kOpMemNone                 },    // 0xA1
+    { &GBCpu::OpAND_r_r<A,D>,            "AND D",         1,  4,  4, kOpMemNone                 },    // 0xA2
+    { &GBCpu::OpAND_r_r<A,E>,            "AND E",         1,  4,  4, kOpMemNone                 },    // 0xA3
+    { &GBCpu::OpAND_r_r<A,H>,            "AND H",         1,  4,  4, kOpMemNone                 },    // 0xA4
+    { &GBCpu::OpAND_r_r<A,L>,            "AND L",         1,  4,  4, kOpMemNone                 },    // 0xA5
+    { &GBCpu::OpAND_r_rr<A,HL>,          "AND (HL)",      1,  8,  8, kOpMemRead                 },    // 0xA6
+    { &GBCpu::OpAND_r_r<A,A>,            "AND A",         1,  4,  4, kOpMemNone                 },    // 0xA7
+    { &GBCpu::OpXOR_r_r<A,B>,            "XOR B",         1,  4,  4, kOpMemNone                 },    // 0xA8
+    { &GBCpu::OpXOR_r_r<A,C>,            "XOR C",         1,  4,  4, kOpMemNone                 },    // 0xA9
+    { &GBCpu::OpXOR_r_r<A,D>,            "XOR D",         1,  4,  4, kOpMemNone                 },    // 0xAA
+    { &GBCpu::OpXOR_r_r<A,E>,            "XOR E",         1,  4,  4, kOpMemNone                 },    // 0xAB
+    { &GBCpu::OpXOR_r_r<A,H>,            "XOR H",         1,  4,  4, kOpMemNone                 },    // 0xAC
+    { &GBCpu::OpXOR_r_r<A,L>,            "XOR L",         1,  4,  4, kOpMemNone                 },    // 0xAD
+    { &GBCpu::OpXOR_r_rr<A,HL>,          "XOR (HL)",      1,  8,  8, kOpMemRead                 },    // 0xAE
+    { &GBCpu::OpXOR_r_r<A,A>,            "XOR A",         1,  4,  4, kOpMemNone                 },    // 0xAF
+    { &GBCpu::OpOR_r_r<A,B>,             "OR B",          1,  4,  4, kOpMemNone                 },    // 0xB0
+    { &GBCpu::OpOR_r_r<A,C>,             "OR C",          1,  4,  4, kOpMemNone                 },    // 0xB1
+    { &GBCpu::OpOR_r_r<A,D>,             "OR D",          1,  4,  4, kOpMemNone                 },    // 0xB2
+    { &GBCpu::OpOR_r_r<A,E>,             "OR E",          1,  4,  4, kOpMemNone                 },    // 0xB3
+    { &GBCpu::OpOR_r_r<A,H>,             "OR H",          1,  4,  4, kOpMemNone                 },    // 0xB4
+    { &GBCpu::OpOR_r_r<A,L>,             "OR L",          1,  4,  4, kOpMemNone                 },    // 0xB5
+    { &GBCpu::OpOR_r_rr<A,HL>,           "OR (HL)",       1,  8,  8, kOpMemRead                 },    // 0xB6
+    { &GBCpu::OpOR_r_r<A,A>,             "OR A",          1,  4,  4, kOpMemNone                 },    // 0xB7
+    { &GBCpu::OpCMP_r_r<A,B>,            "CP B",          1,  4,  4, kOpMemNone                 },    // 0xB8
+    { &GBCpu::OpCMP_r_r<A,C>,            "CP C",          1,  4,  4, kOpMemNone                 },    // 0xB9
+    { &GBCpu::OpCMP_r_r<A,D>,            "CP D",          1,  4,  4, kOpMemNone                 },    // 0xBA
+    { &GBCpu::OpCMP_r_r<A,E>,            "CP E",          1,  4,  4, kOpMemNone                 },    // 0xBB
+    { &GBCpu::OpCMP_r_r<A,H>,            "CP H",          1,  4,  4, kOpMemNone                 },    // 0xBC
+    { &GBCpu::OpCMP_r_r<A,L>,            "CP L",          1,  4,  4, kOpMemNone                 },    // 0xBD
+    { &GBCpu::OpCMP_r_rr<A,HL>,          "CP (HL)",       1,  8,  8, kOpMemRead                 },    // 0xBE
+    { &GBCpu::OpCMP_r_r<A,A>,            "CP A",          1,  4,  4, kOpMemNone                 },    // 0xBF
+    { &GBCpu::OpRET_NZ_nn,               "RET NZ",        1,  8, 20, kOpMemRead | kOpMemStack   },    // 0xC0
+    { &GBCpu::OpPOP_rr_nn<BC>,           "POP BC",        1, 12, 12, kOpMemRead | kOpMemStack   },    // 0xC1
+    { &GBCpu::OpJP_NZ_nn,                "JP NZ,nn",      3, 12, 16, kOpMemNone                 },    // 0xC2
+    { &GBCpu::OpJP_nn,                   "JP nn",         3, 16, 16, kOpMemNone                 },    // 0xC3
+    { &GBCpu::OpCALL_NZ_nn,              "CALL NZ,nn",    3, 12, 24, kOpMemWrite | kOpMemStack  },    // 0xC4
+    { &GBCpu::OpPUSH_rr_nn<BC>,          "PUSH BC",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xC5
+    { &GBCpu::OpADD_r_n<A>,              "ADD A,n",       2,  8,  8, kOpMemNone                 },    // 0xC6
+    { &GBCpu::OpRST_nn<0x00>,            "RST 00H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xC7
+    { &GBCpu::OpRET_Z_nn,                "RET Z",         1,  8, 20, kOpMemRead | kOpMemStack   },    // 0xC8
+    { &GBCpu::OpRET_nn,                  "RET",           1, 16, 16, kOpMemRead | kOpMemStack   },    // 0xC9
+    { &GBCpu::OpJP_Z_nn,                 "JP Z,nn",       3, 12, 16, kOpMemNone                 },    // 0xCA
+    { &GBCpu::OpExecuteExtOp,            "PREFIX CB",     2,  4,  4, kOpMemNone                 },    // 0xCB
+    { &GBCpu::OpCALL_Z_nn,               "CALL Z,nn",     3, 12, 24, kOpMemWrite | kOpMemStack  },    // 0xCC
+    { &GBCpu::OpCALL_nn,                 "CALL nn",       3, 24, 24, kOpMemWrite | kOpMemStack  },    // 0xCD
+    { &GBCpu::OpADC_r_n<A>,              "ADC A,n",       2,  8,  8, kOpMemNone                 },    // 0xCE
+    { &GBCpu::OpRST_nn<0x08>,            "RST 08H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xCF
+    { &GBCpu::OpRET_NC_nn,               "RET NC",        1,  8, 20, kOpMemRead | kOpMemStack   },    // 0xD0
+    { &GBCpu::OpPOP_rr_nn<DE>,           "POP DE",        1, 12, 12, kOpMemRead | kOpMemStack   },    // 0xD1
+    { &GBCpu::OpJP_NC_nn,                "JP NC,nn",      3, 12, 16, kOpMemNone                 },    // 0xD2
+    { &GBCpu::OpInvalid<0xD3>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xD3
+    { &GBCpu::OpCALL_NC_nn,              "CALL NC,nn",    3, 12, 24, kOpMemWrite | kOpMemStack  },    // 0xD4
+    { &GBCpu::OpPUSH_rr_nn<DE>,          "PUSH DE",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xD5
+    { &GBCpu::OpSUB_r_n<A>,              "SUB n",         2,  8,  8, kOpMemNone                 },    // 0xD6
+    { &GBCpu::OpRST_nn<0x10>,            "RST 10H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xD7
+    { &GBCpu::OpRET_C_nn,                "RET C",         1,  8, 20, kOpMemRead | kOpMemStack   },    // 0xD8
+    { &GBCpu::OpRETI_nn,                 "RETI",          1, 16, 16, kOpMemRead | kOpMemStack   },    // 0xD9
+    { &GBCpu::OpJP_C_nn,                 "JP C,nn",       3, 12, 16, kOpMemNone                 },    // 0xDA
+    { &GBCpu::OpInvalid<0xDB>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xDB
+    { &GBCpu::OpCALL_C_nn,               "CALL C,nn",     3, 12, 24, kOpMemWrite | kOpMemStack  },    // 0xDC
+    { &GBCpu::OpInvalid<0xDD>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xDD
+    { &GBCpu::OpSBC_r_n<A>,              "SBC A,n",       2,  8,  8, kOpMemNone                 },    // 0xDE
+    { &GBCpu::OpRST_nn<0x18>,            "RST 18H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xDF
+    { &GBCpu::OpLDH_n_A,                 "LDH (n),A",     2, 12, 12, kOpMemWrite                },    // 0xE0
+    { &GBCpu::OpPOP_rr_nn<HL>,           "POP HL",        1, 12, 12, kOpMemRead | kOpMemStack   },    // 0xE1
+    { &GBCpu::OpLDH_C_A,                 "LD (C),A",      1,  8,  8, kOpMemWrite                },    // 0xE2
+    { &GBCpu::OpInvalid<0xE3>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xE3
+    { &GBCpu::OpInvalid<0xE4>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xE4
+    { &GBCpu::OpPUSH_rr_nn<HL>,          "PUSH HL",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xE5
+    { &GBCpu::OpAND_r_n<A>,              "AND n",         2,  8,  8, kOpMemNone                 },    // 0xE6
+    { &GBCpu::OpRST_nn<0x20>,            "RST 20H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xE7
+    { &GBCpu::OpADD_SP_n,                "ADD SP,e",      2, 16, 16, kOpMemNone                 },    // 0xE8
+    { &GBCpu::OpJP_HL,                   "JP (HL)",       1,  4,  4, kOpMemNone                 },    // 0xE9
+    { &GBCpu::OpLD_nn_r<A>,              "LD (nn),A",     3, 16, 16, kOpMemWrite                },    // 0xEA
+    { &GBCpu::OpInvalid<0xEB>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xEB
+    { &GBCpu::OpInvalid<0xEC>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xEC
+    { &GBCpu::OpInvalid<0xED>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xED
+    { &GBCpu::OpXOR_r_n<A>,              "XOR n",         2,  8,  8, kOpMemNone                 },    // 0xEE
+    { &GBCpu::OpRST_nn<0x28>,            "RST 28H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xEF
+    { &GBCpu::OpLDH_A_n,                 "LDH A,(n)",     2, 12, 12, kOpMemRead                 },    // 0xF0
+    { &GBCpu::OpPOP_rr_nn<AF>,           "POP AF",        1, 12, 12, kOpMemRead | kOpMemStack   },    // 0xF1
+    { &GBCpu::OpLDH_A_C,                 "LD A,(C)",      1,  8,  8, kOpMemRead                 },    // 0xF2
+    { &GBCpu::OpDI,                      "DI",            1,  4,  4, kOpMemNone                 },    // 0xF3
+    { &GBCpu::OpInvalid<0xF4>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xF4
+    { &GBCpu::OpPUSH_rr_nn<AF>,          "PUSH AF",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xF5
+    { &GBCpu::OpOR_r_n<A>,               "OR n",          2,  8,  8, kOpMemNone                 },    // 0xF6
+    { &GBCpu::OpRST_nn<0x30>,            "RST 30H",       1, 16, 16, kOpMemWrite | kOpMemStack  },    // 0xF7
+    { &GBCpu::OpLD_HL_SP_n,              "LD HL,SP+e",    2, 12, 12, kOpMemNone                 },    // 0xF8
+    { &GBCpu::OpLD_SP_HL,                "LD SP,HL",      1,  8,  8, kOpMemNone                 },    // 0xF9
+    { &GBCpu::OpLD_r_nn<A>,              "LD A,(nn)",     3, 16, 16, kOpMemRead                 },    // 0xFA
+    { &GBCpu::OpEI,                      "EI",            1,  4,  4, kOpMemNone                 },    // 0xFB
+    { &GBCpu::OpInvalid<0xFC>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xFC
+    { &GBCpu::OpInvalid<0xFD>,           "INVALID",       0,  0,  0, kOpMemNone                 },    // 0xFD
+    { &GBCpu::OpCMP_r_n<A>,              "CP n",          2,  8,  8, kOpMemNone                 },    // 0xFE
+    { &GBCpu::OpRST_nn<0x38>,            "RST 38H",       1, 16, 16, kOpMemWrite | kOpMemStack  }     // 0xFF
+};
+
+const GBCpu::OpcodeInfo GBCpu::EXT_OPCODE_INFO[ 256 ] =
+{
+    //  Handler                          Mnemonic         Len Cyc Tkn Memory
+    { &GBCpu::OpRLC_r<B>,                "RLC B",         2,  8,  8, kOpMemNone                 },    // 0x00
+    { &GBCpu::OpRLC_r<C>,                "RLC C",         2,  8,  8, kOpMemNone                 },    // 0x01
+    { &GBCpu::OpRLC_r<D>,                "RLC D",         2,  8,  8, kOpMemNone                 },    // 0x02
+    { &GBCpu::OpRLC_r<E>,                "RLC E",         2,  8,  8, kOpMemNone                 },    // 0x03
+    { &GBCpu::OpRLC_r<H>,                "RLC H",         2,  8,  8, kOpMemNone                 },    // 0x04
+    { &GBCpu::OpRLC_r<L>,                "RLC L",         2,  8,  8, kOpMemNone                 },    // 0x05
+    { &GBCpu::OpRLC_HL,                  "RLC (HL)",      2, 16, 16, kOpMemReadWrite            },    // 0x06
+    { &GBCpu::OpRLC_r<A>,                "RLC A",         2,  8,  8, kOpMemNone                 },    // 0x07
+    { &GBCpu::OpRRC_r<B>,                "RRC B",         2,  8,  8, kOpMemNone                 },    // 0x08
+    { &GBCpu::OpRRC_r<C>,                "RRC C",         2,  8,  8, kOpMemNone                 },    // 0x09
+    { &GBCpu::OpRRC_r<D>,                "RRC D",         2,  8,  8, kOpMemNone                 },    // 0x0A
+    { &GBCpu::OpRRC_r<E>,                "RRC E",         2,  8,  8, kOpMemNone                 },    // 0x0B
+    { &GBCpu::OpRRC_r<H>,                "RRC H",         2,  8,  8, kOpMemNone                 },    // 0x0C
+    { &GBCpu::OpRRC_r<L>,                "RRC L",         2,  8,  8, kOpMemNone                 },    // 0x0D
+    { &GBCpu::OpRRC_HL,                  "RRC (HL)",      2, 16, 16, kOpMemReadWrite            },    // 0x0E
+    { &GBCpu::OpRRC_r<A>,                "RRC A",         2,  8,  8, kOpMemNone                 },    // 0x0F
+    { &GBCpu::OpRL_r<B>,                 "RL B",          2,  8,  8, kOpMemNone                 },    // 0x10
+    { &GBCpu::OpRL_r<C>,                 "RL C",          2,  8,  8, kOpMemNone                 },    // 0x11
+    { &GBCpu::OpRL_r<D>,                 "RL D",          2,  8,  8, kOpMemNone                 },    // 0x12
+    { &GBCpu::OpRL_r<E>,                 "RL E",          2,  8,  8, kOpMemNone                 },    // 0x13
+    { &GBCpu::OpRL_r<H>,                 "RL H",          2,  8,  8, kOpMemNone                 },    // 0x14
+    { &GBCpu::OpRL_r<L>,                 "RL L",          2,  8,  8, kOpMemNone                 },    // 0x15
+    { &GBCpu::OpRL_HL,                   "RL (HL)",       2, 16, 16, kOpMemReadWrite            },    // 0x16
+    { &GBCpu::OpRL_r<A>,                 "RL A",          2,  8,  8, kOpMemNone                 },    // 0x17
+    { &GBCpu::OpRR_r<B>,                 "RR B",          2,  8,  8, kOpMemNone                 },    // 0x18
+    { &GBCpu::OpRR_r<C>,                 "RR C",          2,  8,  8, kOpMemNone                 },    // 0x19
+    { &GBCpu::OpRR_r<D>,                 "RR D",          2,  8,  8, kOpMemNone                 },    // 0x1A
+    { &GBCpu::OpRR_r<E>,                 "RR E",          2,  8,  8, kOpMemNone                 },    // 0x1B
+    { &GBCpu::OpRR_r<H>,                 "RR H",          2,  8,  8, kOpMemNone                 },    // 0x1C
+    { &GBCpu::OpRR_r<L>,                 "RR L",          2,  8,  8, kOpMemNone                 },    // 0x1D
+    { &GBCpu::OpRR_HL,                   "RR (HL)",       2, 16, 16, kOpMemReadWrite            },    // 0x1E
+    { &GBCpu::OpRR_r<A>,                 "RR A",          2,  8,  8, kOpMemNone                 },    // 0x1F
+    { &GBCpu::OpSLA_r<B>,                "SLA B",         2,  8,  8, kOpMemNone                 },    // 0x20
+    { &GBCpu::OpSLA_r<C>,                "SLA C",         2,  8,  8, kOpMemNone                 },    // 0x21
+    { &GBCpu::OpSLA_r<D>,                "SLA D",         2,  8,  8, kOpMemNone                 },    // 0x22
+    { &GBCpu::OpSLA_r<E>,                "SLA E",         2,  8,  8, kOpMemNone                 },    // 0x23
+    { &GBCpu::OpSLA_r<H>,                "SLA H",         2,  8,  8, kOpMemNone                 },    // 0x24
+    { &GBCpu::OpSLA_r<L>,                "SLA L",         2,  8,  8, kOpMemNone                 },    // 0x25
+    { &GBCpu::OpSLA_HL,                  "SLA (HL)",      2, 16, 16, kOpMemReadWrite            },    // 0x26
+    { &GBCpu::OpSLA_r<A>,                "SLA A",         2,  8,  8, kOpMemNone                 },    // 0x27
+    { &GBCpu::OpSRA_r<B>,                "SRA B",         2,  8,  8, kOpMemNone                 },    // 0x28
+    { &GBCpu::OpSRA_r<C>,                "SRA C",         2,  8,  8, kOpMemNone                 },    // 0x29
+    { &GBCpu::OpSRA_r<D>,                "SRA D",         2,  8,  8, kOpMemNone                 },    // 0x2A
+    { &GBCpu::OpSRA_r<E>,                "SRA E",         2,  8,  8, kOpMemNone                 },    // 0x2B
+    { &GBCpu::OpSRA_r<H>,                "SRA H",         2,  8,  8, kOpMemNone                 },    // 0x2C
+    { &GBCpu::OpSRA_r<L>,                "SRA L",         2,  8,  8, kOpMemNone                 },    // 0x2D
+    { &GBCpu::OpSRA_HL,                  "SRA (HL)",      2, 16, 16, kOpMemReadWrite            },    // 0x2E
+    { &GBCpu::OpSRA_r<A>,                "SRA A",         2,  8,  8, kOpMemNone                 },    // 0x2F
+    { &GBCpu::OpSWAP_r<B>,               "SWAP B",        2,  8,  8, kOpMemNone                 },    // 0x30
+    { &GBCpu::OpSWAP_r<C>,               "SWAP C",        2,  8,  8, kOpMemNone                 },    // 0x31
+    { &GBCpu::OpSWAP_r<D>,               "SWAP D",        2,  8,  8, kOpMemNone                 },    // 0x32
+    { &GBCpu::OpSWAP_r<E>,               "SWAP E",        2,  8,  8, kOpMemNone                 },    // 0x33
+    { &GBCpu::OpSWAP_r<H>,               "SWAP H",        2,  8,  8, kOpMemNone                 },    // 0x34
+    { &GBCpu::OpSWAP_r<L>,               "SWAP L",        2,  8,  8, kOpMemNone                 },    // 0x35
+    { &GBCpu::OpSWAP_HL,                 "SWAP (HL)",     2, 16, 16, kOpMemReadWrite            },    // 0x36
+    { &GBCpu::OpSWAP_r<A>,               "SWAP A",        2,  8,  8, kOpMemNone                 },    // 0x37
+    { &GBCpu::OpSRL_r<B>,                "SRL B",         2,  8,  8, kOpMemNone                 },    // 0x38
+    { &GBCpu::OpSRL_r<C>,                "SRL C",         2,  8,  8, kOpMemNone                 },    // 0x39
+    { &GBCpu::OpSRL_r<D>,                "SRL D",         2,  8,  8, kOpMemNone                 },    // 0x3A
+    { &GBCpu::OpSRL_r<E>,                "SRL E",         2,  8,  8, kOpMemNone                 },    // 0x3B
+    { &GBCpu::OpSRL_r<H>,                "SRL H",         2,  8,  8, kOpMemNone                 },    // 0x3C
+    { &GBCpu::OpSRL_r<L>,                "SRL L",         2,  8,  8, kOpMemNone                 },    // 0x3D
+    { &GBCpu::OpSRL_HL,                  "SRL (HL)",      2, 16, 16, kOpMemReadWrite            },    // 0x3E
+    { &GBCpu::OpSRL_r<A>,                "SRL A",         2,  8,  8, kOpMemNone                 },    // 0x3F
+    { &GBCpu::OpBIT_r<0,B>,              "BIT 0,B",       2,  8,  8, kOpMemNone                 },    // 0x40
+    { &GBCpu::OpBIT_r<0,C>,              "BIT 0,C",       2,  8,  8, kOpMemNone                 },    // 0x41
+    { &GBCpu::OpBIT_r<0,D>,              "BIT 0,D",       2,  8,  8, kOpMemNone                 },    // 0x42
+    { &GBCpu::OpBIT_r<0,E>,              "BIT 0,E",       2,  8,  8, kOpMemNone                 },    // 0x43
+    { &GBCpu::OpBIT_r<0,H>,              "BIT 0,H",       2,  8,  8, kOpMemNone                 },    // 0x44
+    { &GBCpu::OpBIT_r<0,L>,              "BIT 0,L",       2,  8,  8, kOpMemNone                 },    // 0x45
+    { &GBCpu::OpBIT_HL<0>,               "BIT 0,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x46
+    { &GBCpu::OpBIT_r<0,A>,              "BIT 0,A",       2,  8,  8, kOpMemNone                 },    // 0x47
+    { &GBCpu::OpBIT_r<1,B>,              "BIT 1,B",       2,  8,  8, kOpMemNone                 },    // 0x48
+    { &GBCpu::OpBIT_r<1,C>,              "BIT 1,C",       2,  8,  8, kOpMemNone                 },    // 0x49
+    { &GBCpu::OpBIT_r<1,D>,              "BIT 1,D",       2,  8,  8, kOpMemNone                 },    // 0x4A
+    { &GBCpu::OpBIT_r<1,E>,              "BIT 1,E",       2,  8,  8, kOpMemNone                 },    // 0x4B
+    { &GBCpu::OpBIT_r<1,H>,              "BIT 1,H",       2,  8,  8, kOpMemNone                 },    // 0x4C
+    { &GBCpu::OpBIT_r<1,L>,              "BIT 1,L",       2,  8,  8, kOpMemNone                 },    // 0x4D
+    { &GBCpu::OpBIT_HL<1>,               "BIT 1,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x4E
+    { &GBCpu::OpBIT_r<1,A>,              "BIT 1,A",       2,  8,  8, kOpMemNone                 },    // 0x4F
+    { &GBCpu::OpBIT_r<2,B>,              "BIT 2,B",       2,  8,  8, kOpMemNone                 },    // 0x50
+    { &GBCpu::OpBIT_r<2,C>,              "BIT 2,C",       2,  8,  8, kOpMemNone                 },    // 0x51
+    { &GBCpu::OpBIT_r<2,D>,              "BIT 2,D",       2,  8,  8, kOpMemNone                 },    // 0x52
+    { &GBCpu::OpBIT_r<2,E>,              "BIT 2,E",       2,  8,  8, kOpMemNone                 },    // 0x53
+    { &GBCpu::OpBIT_r<2,H>,              "BIT 2,H",       2,  8,  8, kOpMemNone                 },    // 0x54
+    { &GBCpu::OpBIT_r<2,L>,              "BIT 2,L",       2,  8,  8, kOpMemNone                 },    // 0x55
+    { &GBCpu::OpBIT_HL<2>,               "BIT 2,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x56
+    { &GBCpu::OpBIT_r<2,A>,              "BIT 2,A",       2,  8,  8, kOpMemNone                 },    // 0x57
+    { &GBCpu::OpBIT_r<3,B>,              "BIT 3,B",       2,  8,  8, kOpMemNone                 },    // 0x58
+    { &GBCpu::OpBIT_r<3,C>,              "BIT 3,C",       2,  8,  8, kOpMemNone                 },    // 0x59
+    { &GBCpu::OpBIT_r<3,D>,              "BIT 3,D",       2,  8,  8, kOpMemNone                 },    // 0x5A
+    { &GBCpu::OpBIT_r<3,E>,              "BIT 3,E",       2,  8,  8, kOpMemNone                 },    // 0x5B
+    { &GBCpu::OpBIT_r<3,H>,              "BIT 3,H",       2,  8,  8, kOpMemNone                 },    // 0x5C
+    { &GBCpu::OpBIT_r<3,L>,              "BIT 3,L",       2,  8,  8, kOpMemNone                 },    // 0x5D
+    { &GBCpu::OpBIT_HL<3>,               "BIT 3,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x5E
+    { &GBCpu::OpBIT_r<3,A>,              "BIT 3,A",       2,  8,  8, kOpMemNone                 },    // 0x5F
+    { &GBCpu::OpBIT_r<4,B>,              "BIT 4,B",       2,  8,  8, kOpMemNone                 },    // 0x60
+    { &GBCpu::OpBIT_r<4,C>,              "BIT 4,C",       2,  8,  8, kOpMemNone                 },    // 0x61
+    { &GBCpu::OpBIT_r<4,D>,              "BIT 4,D",       2,  8,  8, kOpMemNone                 },    // 0x62
+    { &GBCpu::OpBIT_r<4,E>,              "BIT 4,E",       2,  8,  8, kOpMemNone                 },    // 0x63
+    { &GBCpu::OpBIT_r<4,H>,              "BIT 4,H",       2,  8,  8, kOpMemNone                 },    // 0x64
+    { &GBCpu::OpBIT_r<4,L>,              "BIT 4,L",       2,  8,  8, kOpMemNone                 },    // 0x65
+    { &GBCpu::OpBIT_HL<4>,               "BIT 4,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x66
+    { &GBCpu::OpBIT_r<4,A>,              "BIT 4,A",       2,  8,  8, kOpMemNone                 },    // 0x67
+    { &GBCpu::OpBIT_r<5,B>,              "BIT 5,B",       2,  8,  8, kOpMemNone                 },    // 0x68
+    { &GBCpu::OpBIT_r<5,C>,              "BIT 5,C",       2,  8,  8, kOpMemNone                 },    // 0x69
+    { &GBCpu::OpBIT_r<5,D>,              "BIT 5,D",       2,  8,  8, kOpMemNone                 },    // 0x6A
+    { &GBCpu::OpBIT_r<5,E>,              "BIT 5,E",       2,  8,  8, kOpMemNone                 },    // 0x6B
+    { &GBCpu::OpBIT_r<5,H>,              "BIT 5,H",       2,  8,  8, kOpMemNone                 },    // 0x6C
+    { &GBCpu::OpBIT_r<5,L>,              "BIT 5,L",       2,  8,  8, kOpMemNone                 },    // 0x6D
+    { &GBCpu::OpBIT_HL<5>,               "BIT 5,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x6E
+    { &GBCpu::OpBIT_r<5,A>,              "BIT 5,A",       2,  8,  8, kOpMemNone                 },    // 0x6F
+    { &GBCpu::OpBIT_r<6,B>,              "BIT 6,B",       2,  8,  8, kOpMemNone                 },    // 0x70
+    { &GBCpu::OpBIT_r<6,C>,              "BIT 6,C",       2,  8,  8, kOpMemNone                 },    // 0x71
+    { &GBCpu::OpBIT_r<6,D>,              "BIT 6,D",       2,  8,  8, kOpMemNone                 },    // 0x72
+    { &GBCpu::OpBIT_r<6,E>,              "BIT 6,E",       2,  8,  8, kOpMemNone                 },    // 0x73
+    { &GBCpu::OpBIT_r<6,H>,              "BIT 6,H",       2,  8,  8, kOpMemNone                 },    // 0x74
+    { &GBCpu::OpBIT_r<6,L>,              "BIT 6,L",       2,  8,  8, kOpMemNone                 },    // 0x75
+    { &GBCpu::OpBIT_HL<6>,               "BIT 6,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x76
+    { &GBCpu::OpBIT_r<6,A>,              "BIT 6,A",       2,  8,  8, kOpMemNone                 },    // 0x77
+    { &GBCpu::OpBIT_r<7,B>,              "BIT 7,B",       2,  8,  8, kOpMemNone                 },    // 0x78
+    { &GBCpu::OpBIT_r<7,C>,              "BIT 7,C",       2,  8,  8, kOpMemNone                 },    // 0x79
+    { &GBCpu::OpBIT_r<7,D>,              "BIT 7,D",       2,  8,  8, kOpMemNone                 },    // 0x7A
+    { &GBCpu::OpBIT_r<7,E>,              "BIT 7,E",       2,  8,  8, kOpMemNone                 },    // 0x7B
+    { &GBCpu::OpBIT_r<7,H>,              "BIT 7,H",       2,  8,  8, kOpMemNone                 },    // 0x7C
+    { &GBCpu::OpBIT_r<7,L>,              "BIT 7,L",       2,  8,  8, kOpMemNone                 },    // 0x7D
+    { &GBCpu::OpBIT_HL<7>,               "BIT 7,(HL)",    2, 12, 12, kOpMemRead                 },    // 0x7E
+    { &GBCpu::OpBIT_r<7,A>,              "BIT 7,A",       2,  8,  8, kOpMemNone                 },    // 0x7F
+    { &GBCpu::OpRES_r<0,B>,              "RES 0,B",       2,  8,  8, kOpMemNone                 },    // 0x80
+    { &GBCpu::OpRES_r<0,C>,              "RES 0,C",       2,  8,  8, kOpMemNone                 },    // 0x81
+    { &GBCpu::OpRES_r<0,D>,              "RES 0,D",       2,  8,  8, kOpMemNone                 },    // 0x82
+    { &GBCpu::OpRES_r<0,E>,              "RES 0,E",       2,  8,  8, kOpMemNone                 },    // 0x83
+    { &GBCpu::OpRES_r<0,H>,              "RES 0,H",       2,  8,  8, kOpMemNone                 },    // 0x84
+    { &GBCpu::OpRES_r<0,L>,              "RES 0,L",       2,  8,  8, kOpMemNone                 },    // 0x85
+    { &GBCpu::OpRES_HL<0>,               "RES 0,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0x86
+    { &GBCpu::OpRES_r<0,A>,              "RES 0,A",       2,  8,  8, kOpMemNone                 },    // 0x87
+    { &GBCpu::OpRES_r<1,B>,              "RES 1,B",       2,  8,  8, kOpMemNone                 },    // 0x88
+    { &GBCpu::OpRES_r<1,C>,              "RES 1,C",       2,  8,  8, kOpMemNone                 },    // 0x89
+    { &GBCpu::OpRES_r<1,D>,              "RES 1,D",       2,  8,  8, kOpMemNone                 },    // 0x8A
+    { &GBCpu::OpRES_r<1,E>,              "RES 1,E",       2,  8,  8, kOpMemNone                 },    // 0x8B
+    { &GBCpu::OpRES_r<1,H>,              "RES 1,H",       2,  8,  8, kOpMemNone                 },    // 0x8C
+    { &GBCpu::OpRES_r<1,L>,              "RES 1,L",       2,  8,  8, kOpMemNone                 },    // 0x8D
+    { &GBCpu::OpRES_HL<1>,               "RES 1,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0x8E
+    { &GBCpu::OpRES_r<1,A>,              "RES 1,A",       2,  8,  8, kOpMemNone                 },    // 0x8F
+    { &GBCpu::OpRES_r<2,B>,              "RES 2,B",       2,  8,  8, kOpMemNone                 },    // 0x90
+    { &GBCpu::OpRES_r<2,C>,              "RES 2,C",       2,  8,  8, kOpMemNone                 },    // 0x91
+    { &GBCpu::OpRES_r<2,D>,              "RES 2,D",       2,  8,  8, kOpMemNone                 },    // 0x92
+    { &GBCpu::OpRES_r<2,E>,              "RES 2,E",       2,  8,  8, kOpMemNone                 },    // 0x93
+    { &GBCpu::OpRES_r<2,H>,              "RES 2,H",       2,  8,  8, kOpMemNone                 },    // 0x94
+    { &GBCpu::OpRES_r<2,L>,              "RES 2,L",       2,  8,  8, kOpMemNone                 },    // 0x95
+    { &GBCpu::OpRES_HL<2>,               "RES 2,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0x96
+    { &GBCpu::OpRES_r<2,A>,              "RES 2,A",       2,  8,  8, kOpMemNone                 },    // 0x97
+    { &GBCpu::OpRES_r<3,B>,              "RES 3,B",       2,  8,  8, kOpMemNone                 },    // 0x98
+    { &GBCpu::OpRES_r<3,C>,              "RES 3,C",       2,  8,  8, kOpMemNone                 },    // 0x99
+    { &GBCpu::OpRES_r<3,D>,              "RES 3,D",       2,  8,  8, kOpMemNone                 },    // 0x9A
+    { &GBCpu::OpRES_r<3,E>,              "RES 3,E",       2,  8,  8, kOpMemNone                 },    // 0x9B
+    { &GBCpu::OpRES_r<3,H>,              "RES 3,H",       2,  8,  8, kOpMemNone                 },    // 0x9C
+    { &GBCpu::OpRES_r<3,L>,              "RES 3,L",       2,  8,  8, kOpMemNone                 },    // 0x9D
+    { &GBCpu::OpRES_HL<3>,               "RES 3,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0x9E
+    { &GBCpu::OpRES_r<3,A>,              "RES 3,A",       2,  8,  8, kOpMemNone                 },    // 0x9F
+    { &GBCpu::OpRES_r<4,B>,              "RES 4,B",       2,  8,  8, kOpMemNone                 },    // 0xA0
+    { &GBCpu::OpRES_r<4,C>,              "RES 4,C",       2,  8,  8, kOpMemNone                 },    // 0xA1
+    { &GBCpu::OpRES_r<4,D>,              "RES 4,D",       2,  8,  8, kOpMemNone                 },    // 0xA2
+    { &GBCpu::OpRES_r<4,E>,              "RES 4,E",       2,  8,  8, kOpMemNone                 },    // 0xA3
+    { &GBCpu::OpRES_r<4,H>,              "RES 4,H",       2,  8,  8, kOpMemNone                 },    // 0xA4
+    { &GBCpu::OpRES_r<4,L>,              "RES 4,L",       2,  8,  8, kOpMemNone                 },    // 0xA5
+    { &GBCpu::OpRES_HL<4>,               "RES 4,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xA6
+    { &GBCpu::OpRES_r<4,A>,              "RES 4,A",       2,  8,  8, kOpMemNone                 },    // 0xA7
+    { &GBCpu::OpRES_r<5,B>,              "RES 5,B",       2,  8,  8, kOpMemNone                 },    // 0xA8
+    { &GBCpu::OpRES_r<5,C>,              "RES 5,C",       2,  8,  8, kOpMemNone                 },    // 0xA9
+    { &GBCpu::OpRES_r<5,D>,              "RES 5,D",       2,  8,  8, kOpMemNone                 },    // 0xAA
+    { &GBCpu::OpRES_r<5,E>,              "RES 5,E",       2,  8,  8, kOpMemNone                 },    // 0xAB
+    { &GBCpu::OpRES_r<5,H>,              "RES 5,H",       2,  8,  8, kOpMemNone                 },    // 0xAC
+    { &GBCpu::OpRES_r<5,L>,              "RES 5,L",       2,  8,  8, kOpMemNone                 },    // 0xAD
+    { &GBCpu::OpRES_HL<5>,               "RES 5,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xAE
+    { &GBCpu::OpRES_r<5,A>,              "RES 5,A",       2,  8,  8, kOpMemNone                 },    // 0xAF
+    { &GBCpu::OpRES_r<6,B>,              "RES 6,B",       2,  8,  8, kOpMemNone                 },    // 0xB0
+    { &GBCpu::OpRES_r<6,C>,              "RES 6,C",       2,  8,  8, kOpMemNone                 },    // 0xB1
+    { &GBCpu::OpRES_r<6,D>,              "RES 6,D",       2,  8,  8, kOpMemNone                 },    // 0xB2
+    { &GBCpu::OpRES_r<6,E>,              "RES 6,E",       2,  8,  8, kOpMemNone                 },    // 0xB3
+    { &GBCpu::OpRES_r<6,H>,              "RES 6,H",       2,  8,  8, kOpMemNone                 },    // 0xB4
+    { &GBCpu::OpRES_r<6,L>,              "RES 6,L",       2,  8,  8, kOpMemNone                 },    // 0xB5
+    { &GBCpu::OpRES_HL<6>,               "RES 6,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xB6
+    { &GBCpu::OpRES_r<6,A>,              "RES 6,A",       2,  8,  8, kOpMemNone                 },    // 0xB7
+    { &GBCpu::OpRES_r<7,B>,              "RES 7,B",       2,  8,  8, kOpMemNone                 },    // 0xB8
+    { &GBCpu::OpRES_r<7,C>,              "RES 7,C",       2,  8,  8, kOpMemNone                 },    // 0xB9
+    { &GBCpu::OpRES_r<7,D>,              "RES 7,D",       2,  8,  8, kOpMemNone                 },    // 0xBA
+    { &GBCpu::OpRES_r<7,E>,              "RES 7,E",       2,  8,  8, kOpMemNone                 },    // 0xBB
+    { &GBCpu::OpRES_r<7,H>,              "RES 7,H",       2,  8,  8, kOpMemNone                 },    // 0xBC
+    { &GBCpu::OpRES_r<7,L>,              "RES 7,L",       2,  8,  8, kOpMemNone                 },    // 0xBD
+    { &GBCpu::OpRES_HL<7>,               "RES 7,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xBE
+    { &GBCpu::OpRES_r<7,A>,              "RES 7,A",       2,  8,  8, kOpMemNone                 },    // 0xBF
+    { &GBCpu::OpSET_r<0,B>,              "SET 0,B",       2,  8,  8, kOpMemNone                 },    // 0xC0
+    { &GBCpu::OpSET_r<0,C>,              "SET 0,C",       2,  8,  8, kOpMemNone                 },    // 0xC1
+    { &GBCpu::OpSET_r<0,D>,              "SET 0,D",       2,  8,  8, kOpMemNone                 },    // 0xC2
+    { &GBCpu::OpSET_r<0,E>,              "SET 0,E",       2,  8,  8, kOpMemNone                 },    // 0xC3
+    { &GBCpu::OpSET_r<0,H>,              "SET 0,H",       2,  8,  8, kOpMemNone                 },    // 0xC4
+    { &GBCpu::OpSET_r<0,L>,              "SET 0,L",       2,  8,  8, kOpMemNone                 },    // 0xC5
+    { &GBCpu::OpSET_HL<0>,               "SET 0,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xC6
+    { &GBCpu::OpSET_r<0,A>,              "SET 0,A",       2,  8,  8, kOpMemNone                 },    // 0xC7
+    { &GBCpu::OpSET_r<1,B>,              "SET 1,B",       2,  8,  8, kOpMemNone                 },    // 0xC8
+    { &GBCpu::OpSET_r<1,C>,              "SET 1,C",       2,  8,  8, kOpMemNone                 },    // 0xC9
+    { &GBCpu::OpSET_r<1,D>,              "SET 1,D",       2,  8,  8, kOpMemNone                 },    // 0xCA
+    { &GBCpu::OpSET_r<1,E>,              "SET 1,E",       2,  8,  8, kOpMemNone                 },    // 0xCB
+    { &GBCpu::OpSET_r<1,H>,              "SET 1,H",       2,  8,  8, kOpMemNone                 },    // 0xCC
+    { &GBCpu::OpSET_r<1,L>,              "SET 1,L",       2,  8,  8, kOpMemNone                 },    // 0xCD
+    { &GBCpu::OpSET_HL<1>,               "SET 1,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xCE
+    { &GBCpu::OpSET_r<1,A>,              "SET 1,A",       2,  8,  8, kOpMemNone                 },    // 0xCF
+    { &GBCpu::OpSET_r<2,B>,              "SET 2,B",       2,  8,  8, kOpMemNone                 },    // 0xD0
+    { &GBCpu::OpSET_r<2,C>,              "SET 2,C",       2,  8,  8, kOpMemNone                 },    // 0xD1
+    { &GBCpu::OpSET_r<2,D>,              "SET 2,D",       2,  8,  8, kOpMemNone                 },    // 0xD2
+    { &GBCpu::OpSET_r<2,E>,              "SET 2,E",       2,  8,  8, kOpMemNone                 },    // 0xD3
+    { &GBCpu::OpSET_r<2,H>,              "SET 2,H",       2,  8,  8, kOpMemNone                 },    // 0xD4
+    { &GBCpu::OpSET_r<2,L>,              "SET 2,L",       2,  8,  8, kOpMemNone                 },    // 0xD5
+    { &GBCpu::OpSET_HL<2>,               "SET 2,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xD6
+    { &GBCpu::OpSET_r<2,A>,              "SET 2,A",       2,  8,  8, kOpMemNone                 },    // 0xD7
+    { &GBCpu::OpSET_r<3,B>,              "SET 3,B",       2,  8,  8, kOpMemNone                 },    // 0xD8
+    { &GBCpu::OpSET_r<3,C>,              "SET 3,C",       2,  8,  8, kOpMemNone                 },    // 0xD9
+    { &GBCpu::OpSET_r<3,D>,              "SET 3,D",       2,  8,  8, kOpMemNone                 },    // 0xDA
+    { &GBCpu::OpSET_r<3,E>,              "SET 3,E",       2,  8,  8, kOpMemNone                 },    // 0xDB
+    { &GBCpu::OpSET_r<3,H>,              "SET 3,H",       2,  8,  8, kOpMemNone                 },    // 0xDC
+    { &GBCpu::OpSET_r<3,L>,              "SET 3,L",       2,  8,  8, kOpMemNone                 },    // 0xDD
+    { &GBCpu::OpSET_HL<3>,               "SET 3,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xDE
+    { &GBCpu::OpSET_r<3,A>,              "SET 3,A",       2,  8,  8, kOpMemNone                 },    // 0xDF
+    { &GBCpu::OpSET_r<4,B>,              "SET 4,B",       2,  8,  8, kOpMemNone                 },    // 0xE0
+    { &GBCpu::OpSET_r<4,C>,              "SET 4,C",       2,  8,  8, kOpMemNone                 },    // 0xE1
+    { &GBCpu::OpSET_r<4,D>,              "SET 4,D",       2,  8,  8, kOpMemNone                 },    // 0xE2
+    { &GBCpu::OpSET_r<4,E>,              "SET 4,E",       2,  8,  8, kOpMemNone                 },    // 0xE3
+    { &GBCpu::OpSET_r<4,H>,              "SET 4,H",       2,  8,  8, kOpMemNone                 },    // 0xE4
+    { &GBCpu::OpSET_r<4,L>,              "SET 4,L",       2,  8,  8, kOpMemNone                 },    // 0xE5
+    { &GBCpu::OpSET_HL<4>,               "SET 4,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xE6
+    { &GBCpu::OpSET_r<4,A>,              "SET 4,A",       2,  8,  8, kOpMemNone                 },    // 0xE7
+    { &GBCpu::OpSET_r<5,B>,              "SET 5,B",       2,  8,  8, kOpMemNone                 },    // 0xE8
+    { &GBCpu::OpSET_r<5,C>,              "SET 5,C",       2,  8,  8, kOpMemNone                 },    // 0xE9
+    { &GBCpu::OpSET_r<5,D>,              "SET 5,D",       2,  8,  8, kOpMemNone                 },    // 0xEA
+    { &GBCpu::OpSET_r<5,E>,              "SET 5,E",       2,  8,  8, kOpMemNone                 },    // 0xEB
+    { &GBCpu::OpSET_r<5,H>,              "SET 5,H",       2,  8,  8, kOpMemNone                 },    // 0xEC
+    { &GBCpu::OpSET_r<5,L>,              "SET 5,L",       2,  8,  8, kOpMemNone                 },    // 0xED
+    { &GBCpu::OpSET_HL<5>,               "SET 5,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xEE
+    { &GBCpu::OpSET_r<5,A>,              "SET 5,A",       2,  8,  8, kOpMemNone                 },    // 0xEF
+    { &GBCpu::OpSET_r<6,B>,              "SET 6,B",       2,  8,  8, kOpMemNone                 },    // 0xF0
+    { &GBCpu::OpSET_r<6,C>,              "SET 6,C",       2,  8,  8, kOpMemNone                 },    // 0xF1
+    { &GBCpu::OpSET_r<6,D>,              "SET 6,D",       2,  8,  8, kOpMemNone                 },    // 0xF2
+    { &GBCpu::OpSET_r<6,E>,              "SET 6,E",       2,  8,  8, kOpMemNone                 },    // 0xF3
+    { &GBCpu::OpSET_r<6,H>,              "SET 6,H",       2,  8,  8, kOpMemNone                 },    // 0xF4
+    { &GBCpu::OpSET_r<6,L>,              "SET 6,L",       2,  8,  8, kOpMemNone                 },    // 0xF5
+    { &GBCpu::OpSET_HL<6>,               "SET 6,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xF6
+    { &GBCpu::OpSET_r<6,A>,              "SET 6,A",       2,  8,  8, kOpMemNone                 },    // 0xF7
+    { &GBCpu::OpSET_r<7,B>,              "SET 7,B",       2,  8,  8, kOpMemNone                 },    // 0xF8
+    { &GBCpu::OpSET_r<7,C>,              "SET 7,C",       2,  8,  8, kOpMemNone                 },    // 0xF9
+    { &GBCpu::OpSET_r<7,D>,              "SET 7,D",       2,  8,  8, kOpMemNone                 },    // 0xFA
+    { &GBCpu::OpSET_r<7,E>,              "SET 7,E",       2,  8,  8, kOpMemNone                 },    // 0xFB
+    { &GBCpu::OpSET_r<7,H>,              "SET 7,H",       2,  8,  8, kOpMemNone                 },    // 0xFC
+    { &GBCpu::OpSET_r<7,L>,              "SET 7,L",       2,  8,  8, kOpMemNone                 },    // 0xFD
+    { &GBCpu::OpSET_HL<7>,               "SET 7,(HL)",    2, 16, 16, kOpMemReadWrite            },    // 0xFE
+    { &GBCpu::OpSET_r<7,A>,              "SET 7,A",       2,  8,  8, kOpMemNone                 }     // 0xFF
+};
+
 //====================================================================================================
 // Class
 //====================================================================================================
-GBCpu::GBCpu( GBMem* pMemoryModule, GBTimer* pTimer ) :
+GBCpu::GBCpu( GBMem* pMemoryModule, GBTimer* pTimer, const GBCpuOptions& oOptions ) :
     m_pMem( pMemoryModule ),
     m_pTimer( pTimer ),
-    m_PC( 0 ),
-    m_SP( 0 ),
+    m_oOptions( oOptions ),
     m_bInitialized( false ),
-    m_bHalt( false ),
-    m_bStop( false ),
-    m_bIME( false ),
-    m_u8InterruptFlags( 0 ),
-    m_u8InterruptEnable( 0 ),
+    m_pBlockCache( NULL ),
+    m_pBlock( NULL ),
+    m_u8BlockOp( 0 ),
+    m_u16BlockPC( 0 ),
+    m_pu8Operand( NULL ),
+#if CPU_TRACE
+    m_pTrace( NULL ),
+#endif
+#if CPU_HOTSPOTS
+    m_pHotSpots( NULL ),
+#endif
+    m_iCycleBudget( 0x7FFFFFFF ),
+    m_bYield( false ),
+    m_u32HaltSkippedCycles( 0 ),
+    m_u32RunCount( 0 ),
+    m_pIdleBlock( NULL ),
+    m_u32IdleRunCount( 0 ),
+    m_iIdleCycleBudget( 0 ),
+    m_u32IdleSkippedCycles( 0 ),
     m_DebugPC( 0 ),
+    m_pHistory( NULL ),
     m_u32HistoryIndex( 0 )
 {
+    memset( &m_State, 0, sizeof( m_State ) );
+    memset( &m_oIdleState, 0, sizeof( m_oIdleState ) );
+    m_State.u8FlagOp = kFlagOpNone;
+
     Initialize();
 }
     
@@ -58,521 +604,32 @@ void GBCpu::Initialize()
     SetMMIORegisterHandlers<GBCpu>( m_pMem, MMIOInterruptFlags,  &GBCpu::GetInterruptFlagsRegister,  &GBCpu::SetInterruptFlagsRegsiter );
     SetMMIORegisterHandlers<GBCpu>( m_pMem, MMIOInterruptEnable, &GBCpu::GetInterruptEnableRegister, &GBCpu::SetInterruptEnableRegsiter );
 
-    // Initialize regular opcode handlers
-    m_OpcodeHandlers[ 0x00 ] = &GBCpu::OpNOP;
-    m_OpcodeHandlers[ 0x01 ] = &GBCpu::OpLD_rr_nn<BC>;
-    m_OpcodeHandlers[ 0x02 ] = &GBCpu::OpLD_rr_r<BC,A>;
-    m_OpcodeHandlers[ 0x03 ] = &GBCpu::OpINC_rr<BC>;
-    m_OpcodeHandlers[ 0x04 ] = &GBCpu::OpINC_r<B>;
-    m_OpcodeHandlers[ 0x05 ] = &GBCpu::OpDEC_r<B>;
-    m_OpcodeHandlers[ 0x06 ] = &GBCpu::OpLD_r_n<B>;
-    m_OpcodeHandlers[ 0x07 ] = &GBCpu::OpRLCA;
-    m_OpcodeHandlers[ 0x08 ] = &GBCpu::OpLD_nn_SP;
-    m_OpcodeHandlers[ 0x09 ] = &GBCpu::OpADD_HL_rr<BC>;
-    m_OpcodeHandlers[ 0x0a ] = &GBCpu::OpLD_r_rr<A,BC>;
-    m_OpcodeHandlers[ 0x0b ] = &GBCpu::OpDEC_rr<BC>;
-    m_OpcodeHandlers[ 0x0c ] = &GBCpu::OpINC_r<C>;
-    m_OpcodeHandlers[ 0x0d ] = &GBCpu::OpDEC_r<C>;
-    m_OpcodeHandlers[ 0x0e ] = &GBCpu::OpLD_r_n<C>;
-    m_OpcodeHandlers[ 0x0f ] = &GBCpu::OpRRCA;
-    m_OpcodeHandlers[ 0x10 ] = &GBCpu::OpSTOP;
-    m_OpcodeHandlers[ 0x11 ] = &GBCpu::OpLD_rr_nn<DE>;
-    m_OpcodeHandlers[ 0x12 ] = &GBCpu::OpLD_rr_r<DE,A>;
-    m_OpcodeHandlers[ 0x13 ] = &GBCpu::OpINC_rr<DE>;
-    m_OpcodeHandlers[ 0x14 ] = &GBCpu::OpINC_r<D>;
-    m_OpcodeHandlers[ 0x15 ] = &GBCpu::OpDEC_r<D>;
-    m_OpcodeHandlers[ 0x16 ] = &GBCpu::OpLD_r_n<D>;
-    m_OpcodeHandlers[ 0x17 ] = &GBCpu::OpRLA;
-    m_OpcodeHandlers[ 0x18 ] = &GBCpu::OpJR_n;
-    m_OpcodeHandlers[ 0x19 ] = &GBCpu::OpADD_HL_rr<DE>;
-    m_OpcodeHandlers[ 0x1a ] = &GBCpu::OpLD_r_rr<A,DE>;
-    m_OpcodeHandlers[ 0x1b ] = &GBCpu::OpDEC_rr<DE>;
-    m_OpcodeHandlers[ 0x1c ] = &GBCpu::OpINC_r<E>;
-    m_OpcodeHandlers[ 0x1d ] = &GBCpu::OpDEC_r<E>;
-    m_OpcodeHandlers[ 0x1e ] = &GBCpu::OpLD_r_n<E>;
-    m_OpcodeHandlers[ 0x1f ] = &GBCpu::OpRRA;
-    m_OpcodeHandlers[ 0x20 ] = &GBCpu::OpJR_NZ_n;
-    m_OpcodeHandlers[ 0x21 ] = &GBCpu::OpLD_rr_nn<HL>;
-    m_OpcodeHandlers[ 0x22 ] = &GBCpu::OpLDI_HL_A;
-    m_OpcodeHandlers[ 0x23 ] = &GBCpu::OpINC_rr<HL>;
-    m_OpcodeHandlers[ 0x24 ] = &GBCpu::OpINC_r<H>;
-    m_OpcodeHandlers[ 0x25 ] = &GBCpu::OpDEC_r<H>;
-    m_OpcodeHandlers[ 0x26 ] = &GBCpu::OpLD_r_n<H>;
-    m_OpcodeHandlers[ 0x27 ] = &GBCpu::OpDAA;
-    m_OpcodeHandlers[ 0x28 ] = &GBCpu::OpJR_Z_n;
-    m_OpcodeHandlers[ 0x29 ] = &GBCpu::OpADD_HL_rr<HL>;
-    m_OpcodeHandlers[ 0x2a ] = &GBCpu::OpLDI_A_HL;
-    m_OpcodeHandlers[ 0x2b ] = &GBCpu::OpDEC_rr<HL>;
-    m_OpcodeHandlers[ 0x2c ] = &GBCpu::OpINC_r<L>;
-    m_OpcodeHandlers[ 0x2d ] = &GBCpu::OpDEC_r<L>;
-    m_OpcodeHandlers[ 0x2e ] = &GBCpu::OpLD_r_n<L>;
-    m_OpcodeHandlers[ 0x2f ] = &GBCpu::OpCPL;
-    m_OpcodeHandlers[ 0x30 ] = &GBCpu::OpJR_NC_n;
-    m_OpcodeHandlers[ 0x31 ] = &GBCpu::OpLD_SP_nn;
-    m_OpcodeHandlers[ 0x32 ] = &GBCpu::OpLDD_HL_A;
-    m_OpcodeHandlers[ 0x33 ] = &GBCpu::OpINC_SP;
-    m_OpcodeHandlers[ 0x34 ] = &GBCpu::OpINC_HL;
-    m_OpcodeHandlers[ 0x35 ] = &GBCpu::OpDEC_HL;
-    m_OpcodeHandlers[ 0x36 ] = &GBCpu::OpLD_rr_n<HL>;
-    m_OpcodeHandlers[ 0x37 ] = &GBCpu::OpSCF;
-    m_OpcodeHandlers[ 0x38 ] = &GBCpu::OpJR_C_n;
-    m_OpcodeHandlers[ 0x39 ] = &GBCpu::OpADD_HL_SP;
-    m_OpcodeHandlers[ 0x3a ] = &GBCpu::OpLDD_A_HL;
-    m_OpcodeHandlers[ 0x3b ] = &GBCpu::OpDEC_SP;
-    m_OpcodeHandlers[ 0x3c ] = &GBCpu::OpINC_r<A>;
-    m_OpcodeHandlers[ 0x3d ] = &GBCpu::OpDEC_r<A>;
-    m_OpcodeHandlers[ 0x3e ] = &GBCpu::OpLD_r_n<A>;
-    m_OpcodeHandlers[ 0x3f ] = &GBCpu::OpCCF;
-    m_OpcodeHandlers[ 0x40 ] = &GBCpu::OpLD_r_r<B,B>;
-    m_OpcodeHandlers[ 0x41 ] = &GBCpu::OpLD_r_r<B,C>;
-    m_OpcodeHandlers[ 0x42 ] = &GBCpu::OpLD_r_r<B,D>;
-    m_OpcodeHandlers[ 0x43 ] = &GBCpu::OpLD_r_r<B,E>;
-    m_OpcodeHandlers[ 0x44 ] = &GBCpu::OpLD_r_r<B,H>;
-    m_OpcodeHandlers[ 0x45 ] = &GBCpu::OpLD_r_r<B,L>;
-    m_OpcodeHandlers[ 0x46 ] = &GBCpu::OpLD_r_rr<B,HL>;
-    m_OpcodeHandlers[ 0x47 ] = &GBCpu::OpLD_r_r<B,A>;
-    m_OpcodeHandlers[ 0x48 ] = &GBCpu::OpLD_r_r<C,B>;
-    m_OpcodeHandlers[ 0x49 ] = &GBCpu::OpLD_r_r<C,C>;
-    m_OpcodeHandlers[ 0x4a ] = &GBCpu::OpLD_r_r<C,D>;
-    m_OpcodeHandlers[ 0x4b ] = &GBCpu::OpLD_r_r<C,E>;
-    m_OpcodeHandlers[ 0x4c ] = &GBCpu::OpLD_r_r<C,H>;
-    m_OpcodeHandlers[ 0x4d ] = &GBCpu::OpLD_r_r<C,L>;
-    m_OpcodeHandlers[ 0x4e ] = &GBCpu::OpLD_r_rr<C,HL>;
-    m_OpcodeHandlers[ 0x4f ] = &GBCpu::OpLD_r_r<C,A>;
-    m_OpcodeHandlers[ 0x50 ] = &GBCpu::OpLD_r_r<D,B>;
-    m_OpcodeHandlers[ 0x51 ] = &GBCpu::OpLD_r_r<D,C>;
-    m_OpcodeHandlers[ 0x52 ] = &GBCpu::OpLD_r_r<D,D>;
-    m_OpcodeHandlers[ 0x53 ] = &GBCpu::OpLD_r_r<D,E>;
-    m_OpcodeHandlers[ 0x54 ] = &GBCpu::OpLD_r_r<D,H>;
-    m_OpcodeHandlers[ 0x55 ] = &GBCpu::OpLD_r_r<D,L>;
-    m_OpcodeHandlers[ 0x56 ] = &GBCpu::OpLD_r_rr<D,HL>;
-    m_OpcodeHandlers[ 0x57 ] = &GBCpu::OpLD_r_r<D,A>;
-    m_OpcodeHandlers[ 0x58 ] = &GBCpu::OpLD_r_r<E,B>;
-    m_OpcodeHandlers[ 0x59 ] = &GBCpu::OpLD_r_r<E,C>;
-    m_OpcodeHandlers[ 0x5a ] = &GBCpu::OpLD_r_r<E,D>;
-    m_OpcodeHandlers[ 0x5b ] = &GBCpu::OpLD_r_r<E,E>;
-    m_OpcodeHandlers[ 0x5c ] = &GBCpu::OpLD_r_r<E,H>;
-    m_OpcodeHandlers[ 0x5d ] = &GBCpu::OpLD_r_r<E,L>;
-    m_OpcodeHandlers[ 0x5e ] = &GBCpu::OpLD_r_rr<E,HL>;
-    m_OpcodeHandlers[ 0x5f ] = &GBCpu::OpLD_r_r<E,A>;
-    m_OpcodeHandlers[ 0x60 ] = &GBCpu::OpLD_r_r<H,B>;
-    m_OpcodeHandlers[ 0x61 ] = &GBCpu::OpLD_r_r<H,C>;
-    m_OpcodeHandlers[ 0x62 ] = &GBCpu::OpLD_r_r<H,D>;
-    m_OpcodeHandlers[ 0x63 ] = &GBCpu::OpLD_r_r<H,E>;
-    m_OpcodeHandlers[ 0x64 ] = &GBCpu::OpLD_r_r<H,H>;
-    m_OpcodeHandlers[ 0x65 ] = &GBCpu::OpLD_r_r<H,L>;
-    m_OpcodeHandlers[ 0x66 ] = &GBCpu::OpLD_r_rr<H,HL>;
-    m_OpcodeHandlers[ 0x67 ] = &GBCpu::OpLD_r_r<H,A>;
-    m_OpcodeHandlers[ 0x68 ] = &GBCpu::OpLD_r_r<L,B>;
-    m_OpcodeHandlers[ 0x69 ] = &GBCpu::OpLD_r_r<L,C>;
-    m_OpcodeHandlers[ 0x6a ] = &GBCpu::OpLD_r_r<L,D>;
-    m_OpcodeHandlers[ 0x6b ] = &GBCpu::OpLD_r_r<L,E>;
-    m_OpcodeHandlers[ 0x6c ] = &GBCpu::OpLD_r_r<L,H>;
-    m_OpcodeHandlers[ 0x6d ] = &GBCpu::OpLD_r_r<L,L>;
-    m_OpcodeHandlers[ 0x6e ] = &GBCpu::OpLD_r_rr<L,HL>;
-    m_OpcodeHandlers[ 0x6f ] = &GBCpu::OpLD_r_r<L,A>;
-    m_OpcodeHandlers[ 0x70 ] = &GBCpu::OpLD_rr_r<HL,B>;
-    m_OpcodeHandlers[ 0x71 ] = &GBCpu::OpLD_rr_r<HL,C>;
-    m_OpcodeHandlers[ 0x72 ] = &GBCpu::OpLD_rr_r<HL,D>;
-    m_OpcodeHandlers[ 0x73 ] = &GBCpu::OpLD_rr_r<HL,E>;
-    m_OpcodeHandlers[ 0x74 ] = &GBCpu::OpLD_rr_r<HL,H>;
-    m_OpcodeHandlers[ 0x75 ] = &GBCpu::OpLD_rr_r<HL,L>;
-    m_OpcodeHandlers[ 0x76 ] = &GBCpu::OpHALT;
-    m_OpcodeHandlers[ 0x77 ] = &GBCpu::OpLD_rr_r<HL,A>;
-    m_OpcodeHandlers[ 0x78 ] = &GBCpu::OpLD_r_r<A,B>;
-    m_OpcodeHandlers[ 0x79 ] = &GBCpu::OpLD_r_r<A,C>;
-    m_OpcodeHandlers[ 0x7a ] = &GBCpu::OpLD_r_r<A,D>;
-    m_OpcodeHandlers[ 0x7b ] = &GBCpu::OpLD_r_r<A,E>;
-    m_OpcodeHandlers[ 0x7c ] = &GBCpu::OpLD_r_r<A,H>;
-    m_OpcodeHandlers[ 0x7d ] = &GBCpu::OpLD_r_r<A,L>;
-    m_OpcodeHandlers[ 0x7e ] = &GBCpu::OpLD_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0x7f ] = &GBCpu::OpLD_r_r<A,A>;
-    m_OpcodeHandlers[ 0x80 ] = &GBCpu::OpADD_r_r<A,B>;
-    m_OpcodeHandlers[ 0x81 ] = &GBCpu::OpADD_r_r<A,C>;
-    m_OpcodeHandlers[ 0x82 ] = &GBCpu::OpADD_r_r<A,D>;
-    m_OpcodeHandlers[ 0x83 ] = &GBCpu::OpADD_r_r<A,E>;
-    m_OpcodeHandlers[ 0x84 ] = &GBCpu::OpADD_r_r<A,H>;
-    m_OpcodeHandlers[ 0x85 ] = &GBCpu::OpADD_r_r<A,L>;
-    m_OpcodeHandlers[ 0x86 ] = &GBCpu::OpADD_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0x87 ] = &GBCpu::OpADD_r_r<A,A>;
-    m_OpcodeHandlers[ 0x88 ] = &GBCpu::OpADC_r_r<A,B>;
-    m_OpcodeHandlers[ 0x89 ] = &GBCpu::OpADC_r_r<A,C>;
-    m_OpcodeHandlers[ 0x8a ] = &GBCpu::OpADC_r_r<A,D>;
-    m_OpcodeHandlers[ 0x8b ] = &GBCpu::OpADC_r_r<A,E>;
-    m_OpcodeHandlers[ 0x8c ] = &GBCpu::OpADC_r_r<A,H>;
-    m_OpcodeHandlers[ 0x8d ] = &GBCpu::OpADC_r_r<A,L>;
-    m_OpcodeHandlers[ 0x8e ] = &GBCpu::OpADC_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0x8f ] = &GBCpu::OpADC_r_r<A,A>;
-    m_OpcodeHandlers[ 0x90 ] = &GBCpu::OpSUB_r_r<A,B>;
-    m_OpcodeHandlers[ 0x91 ] = &GBCpu::OpSUB_r_r<A,C>;
-    m_OpcodeHandlers[ 0x92 ] = &GBCpu::OpSUB_r_r<A,D>;
-    m_OpcodeHandlers[ 0x93 ] = &GBCpu::OpSUB_r_r<A,E>;
-    m_OpcodeHandlers[ 0x94 ] = &GBCpu::OpSUB_r_r<A,H>;
-    m_OpcodeHandlers[ 0x95 ] = &GBCpu::OpSUB_r_r<A,L>;
-    m_OpcodeHandlers[ 0x96 ] = &GBCpu::OpSUB_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0x97 ] = &GBCpu::OpSUB_r_r<A,A>;
-    m_OpcodeHandlers[ 0x98 ] = &GBCpu::OpSBC_r_r<A,B>;
-    m_OpcodeHandlers[ 0x99 ] = &GBCpu::OpSBC_r_r<A,C>;
-    m_OpcodeHandlers[ 0x9a ] = &GBCpu::OpSBC_r_r<A,D>;
-    m_OpcodeHandlers[ 0x9b ] = &GBCpu::OpSBC_r_r<A,E>;
-    m_OpcodeHandlers[ 0x9c ] = &GBCpu::OpSBC_r_r<A,H>;
-    m_OpcodeHandlers[ 0x9d ] = &GBCpu::OpSBC_r_r<A,L>;
-    m_OpcodeHandlers[ 0x9e ] = &GBCpu::OpSBC_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0x9f ] = &GBCpu::OpSBC_r_r<A,A>;
-    m_OpcodeHandlers[ 0xa0 ] = &GBCpu::OpAND_r_r<A,B>;
-    m_OpcodeHandlers[ 0xa1 ] = &GBCpu::OpAND_r_r<A,C>;
-    m_OpcodeHandlers[ 0xa2 ] = &GBCpu::OpAND_r_r<A,D>;
-    m_OpcodeHandlers[ 0xa3 ] = &GBCpu::OpAND_r_r<A,E>;
-    m_OpcodeHandlers[ 0xa4 ] = &GBCpu::OpAND_r_r<A,H>;
-    m_OpcodeHandlers[ 0xa5 ] = &GBCpu::OpAND_r_r<A,L>;
-    m_OpcodeHandlers[ 0xa6 ] = &GBCpu::OpAND_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0xa7 ] = &GBCpu::OpAND_r_r<A,A>;
-    m_OpcodeHandlers[ 0xa8 ] = &GBCpu::OpXOR_r_r<A,B>;
-    m_OpcodeHandlers[ 0xa9 ] = &GBCpu::OpXOR_r_r<A,C>;
-    m_OpcodeHandlers[ 0xaa ] = &GBCpu::OpXOR_r_r<A,D>;
-    m_OpcodeHandlers[ 0xab ] = &GBCpu::OpXOR_r_r<A,E>;
-    m_OpcodeHandlers[ 0xac ] = &GBCpu::OpXOR_r_r<A,H>;
-    m_OpcodeHandlers[ 0xad ] = &GBCpu::OpXOR_r_r<A,L>;
-    m_OpcodeHandlers[ 0xae ] = &GBCpu::OpXOR_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0xaf ] = &GBCpu::OpXOR_r_r<A,A>;
-    m_OpcodeHandlers[ 0xb0 ] = &GBCpu::OpOR_r_r<A,B>;
-    m_OpcodeHandlers[ 0xb1 ] = &GBCpu::OpOR_r_r<A,C>;
-    m_OpcodeHandlers[ 0xb2 ] = &GBCpu::OpOR_r_r<A,D>;
-    m_OpcodeHandlers[ 0xb3 ] = &GBCpu::OpOR_r_r<A,E>;
-    m_OpcodeHandlers[ 0xb4 ] = &GBCpu::OpOR_r_r<A,H>;
-    m_OpcodeHandlers[ 0xb5 ] = &GBCpu::OpOR_r_r<A,L>;
-    m_OpcodeHandlers[ 0xb6 ] = &GBCpu::OpOR_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0xb7 ] = &GBCpu::OpOR_r_r<A,A>;
-    m_OpcodeHandlers[ 0xb8 ] = &GBCpu::OpCMP_r_r<A,B>;
-    m_OpcodeHandlers[ 0xb9 ] = &GBCpu::OpCMP_r_r<A,C>;
-    m_OpcodeHandlers[ 0xba ] = &GBCpu::OpCMP_r_r<A,D>;
-    m_OpcodeHandlers[ 0xbb ] = &GBCpu::OpCMP_r_r<A,E>;
-    m_OpcodeHandlers[ 0xbc ] = &GBCpu::OpCMP_r_r<A,H>;
-    m_OpcodeHandlers[ 0xbd ] = &GBCpu::OpCMP_r_r<A,L>;
-    m_OpcodeHandlers[ 0xbe ] = &GBCpu::OpCMP_r_rr<A,HL>;
-    m_OpcodeHandlers[ 0xbf ] = &GBCpu::OpCMP_r_r<A,A>;
-    m_OpcodeHandlers[ 0xc0 ] = &GBCpu::OpRET_NZ_nn;
-    m_OpcodeHandlers[ 0xc1 ] = &GBCpu::OpPOP_rr_nn<BC>;
-    m_OpcodeHandlers[ 0xc2 ] = &GBCpu::OpJP_NZ_nn;
-    m_OpcodeHandlers[ 0xc3 ] = &GBCpu::OpJP_nn;
-    m_OpcodeHandlers[ 0xc4 ] = &GBCpu::OpCALL_NZ_nn;
-    m_OpcodeHandlers[ 0xc5 ] = &GBCpu::OpPUSH_rr_nn<BC>;
-    m_OpcodeHandlers[ 0xc6 ] = &GBCpu::OpADD_r_n<A>;
-    m_OpcodeHandlers[ 0xc7 ] = &GBCpu::OpRST_nn<0x00>;
-    m_OpcodeHandlers[ 0xc8 ] = &GBCpu::OpRET_Z_nn;
-    m_OpcodeHandlers[ 0xc9 ] = &GBCpu::OpRET_nn;
-    m_OpcodeHandlers[ 0xca ] = &GBCpu::OpJP_Z_nn;
-    m_OpcodeHandlers[ 0xcb ] = &GBCpu::OpExecuteExtOp;
-    m_OpcodeHandlers[ 0xcc ] = &GBCpu::OpCALL_Z_nn;
-    m_OpcodeHandlers[ 0xcd ] = &GBCpu::OpCALL_nn;
-    m_OpcodeHandlers[ 0xce ] = &GBCpu::OpADC_r_n<A>;
-    m_OpcodeHandlers[ 0xcf ] = &GBCpu::OpRST_nn<0x08>;
-    m_OpcodeHandlers[ 0xd0 ] = &GBCpu::OpRET_NC_nn;
-    m_OpcodeHandlers[ 0xd1 ] = &GBCpu::OpPOP_rr_nn<DE>;
-    m_OpcodeHandlers[ 0xd2 ] = &GBCpu::OpJP_NC_nn;
-    m_OpcodeHandlers[ 0xd3 ] = &GBCpu::OpInvalid<0xD3>;
-    m_OpcodeHandlers[ 0xd4 ] = &GBCpu::OpCALL_NC_nn;
-    m_OpcodeHandlers[ 0xd5 ] = &GBCpu::OpPUSH_rr_nn<DE>;
-    m_OpcodeHandlers[ 0xd6 ] = &GBCpu::OpSUB_r_n<A>;
-    m_OpcodeHandlers[ 0xd7 ] = &GBCpu::OpRST_nn<0x10>;
-    m_OpcodeHandlers[ 0xd8 ] = &GBCpu::OpRET_C_nn;
-    m_OpcodeHandlers[ 0xd9 ] = &GBCpu::OpRETI_nn;
-    m_OpcodeHandlers[ 0xda ] = &GBCpu::OpJP_C_nn;
-    m_OpcodeHandlers[ 0xdb ] = &GBCpu::OpInvalid<0xDB>;
-    m_OpcodeHandlers[ 0xdc ] = &GBCpu::OpCALL_C_nn;
-    m_OpcodeHandlers[ 0xdd ] = &GBCpu::OpInvalid<0xDD>;
-    m_OpcodeHandlers[ 0xde ] = &GBCpu::OpSBC_r_n<A>;
-    m_OpcodeHandlers[ 0xdf ] = &GBCpu::OpRST_nn<0x18>;
-    m_OpcodeHandlers[ 0xe0 ] = &GBCpu::OpLDH_n_A;
-    m_OpcodeHandlers[ 0xe1 ] = &GBCpu::OpPOP_rr_nn<HL>;
-    m_OpcodeHandlers[ 0xe2 ] = &GBCpu::OpLDH_C_A;
-    m_OpcodeHandlers[ 0xe3 ] = &GBCpu::OpInvalid<0xE3>;
-    m_OpcodeHandlers[ 0xe4 ] = &GBCpu::OpInvalid<0xE4>;
-    m_OpcodeHandlers[ 0xe5 ] = &GBCpu::OpPUSH_rr_nn<HL>;
-    m_OpcodeHandlers[ 0xe6 ] = &GBCpu::OpAND_r_n<A>;
-    m_OpcodeHandlers[ 0xe7 ] = &GBCpu::OpRST_nn<0x20>;
-    m_OpcodeHandlers[ 0xe8 ] = &GBCpu::OpADD_SP_n;
-    m_OpcodeHandlers[ 0xe9 ] = &GBCpu::OpJP_HL;
-    m_OpcodeHandlers[ 0xea ] = &GBCpu::OpLD_nn_r<A>;
-    m_OpcodeHandlers[ 0xeb ] = &GBCpu::OpInvalid<0xEB>;
-    m_OpcodeHandlers[ 0xec ] = &GBCpu::OpInvalid<0xEC>;
-    m_OpcodeHandlers[ 0xed ] = &GBCpu::OpInvalid<0xED>;
-    m_OpcodeHandlers[ 0xee ] = &GBCpu::OpXOR_r_n<A>;
-    m_OpcodeHandlers[ 0xef ] = &GBCpu::OpRST_nn<0x28>;
-    m_OpcodeHandlers[ 0xf0 ] = &GBCpu::OpLDH_A_n;
-    m_OpcodeHandlers[ 0xf1 ] = &GBCpu::OpPOP_rr_nn<AF>;
-    m_OpcodeHandlers[ 0xf2 ] = &GBCpu::OpLDH_A_C;
-    m_OpcodeHandlers[ 0xf3 ] = &GBCpu::OpDI;
-    m_OpcodeHandlers[ 0xf4 ] = &GBCpu::OpInvalid<0xF4>;
-    m_OpcodeHandlers[ 0xf5 ] = &GBCpu::OpPUSH_rr_nn<AF>;
-    m_OpcodeHandlers[ 0xf6 ] = &GBCpu::OpOR_r_n<A>;
-    m_OpcodeHandlers[ 0xf7 ] = &GBCpu::OpRST_nn<0x30>;
-    m_OpcodeHandlers[ 0xf8 ] = &GBCpu::OpLD_HL_SP_n;
-    m_OpcodeHandlers[ 0xf9 ] = &GBCpu::OpLD_SP_HL;
-    m_OpcodeHandlers[ 0xfa ] = &GBCpu::OpLD_r_nn<A>;
-    m_OpcodeHandlers[ 0xfb ] = &GBCpu::OpEI;
-    m_OpcodeHandlers[ 0xfc ] = &GBCpu::OpInvalid<0xFC>;
-    m_OpcodeHandlers[ 0xfd ] = &GBCpu::OpInvalid<0xFD>;
-    m_OpcodeHandlers[ 0xfe ] = &GBCpu::OpCMP_r_n<A>;
-    m_OpcodeHandlers[ 0xff ] = &GBCpu::OpRST_nn<0x38>;
-
-    // Initialize extended opcode handlers
-    m_OpcodeExtHandlers[ 0x00 ] = &GBCpu::OpRLC_r<B>;
-    m_OpcodeExtHandlers[ 0x01 ] = &GBCpu::OpRLC_r<C>;
-    m_OpcodeExtHandlers[ 0x02 ] = &GBCpu::OpRLC_r<D>;
-    m_OpcodeExtHandlers[ 0x03 ] = &GBCpu::OpRLC_r<E>;
-    m_OpcodeExtHandlers[ 0x04 ] = &GBCpu::OpRLC_r<H>;
-    m_OpcodeExtHandlers[ 0x05 ] = &GBCpu::OpRLC_r<L>;
-    m_OpcodeExtHandlers[ 0x06 ] = &GBCpu::OpRLC_HL;
-    m_OpcodeExtHandlers[ 0x07 ] = &GBCpu::OpRLC_r<A>;
-    m_OpcodeExtHandlers[ 0x08 ] = &GBCpu::OpRRC_r<B>;
-    m_OpcodeExtHandlers[ 0x09 ] = &GBCpu::OpRRC_r<C>;
-    m_OpcodeExtHandlers[ 0x0a ] = &GBCpu::OpRRC_r<D>;
-    m_OpcodeExtHandlers[ 0x0b ] = &GBCpu::OpRRC_r<E>;
-    m_OpcodeExtHandlers[ 0x0c ] = &GBCpu::OpRRC_r<H>;
-    m_OpcodeExtHandlers[ 0x0d ] = &GBCpu::OpRRC_r<L>;
-    m_OpcodeExtHandlers[ 0x0e ] = &GBCpu::OpRRC_HL;
-    m_OpcodeExtHandlers[ 0x0f ] = &GBCpu::OpRRC_r<A>;
-    m_OpcodeExtHandlers[ 0x10 ] = &GBCpu::OpRL_r<B>;
-    m_OpcodeExtHandlers[ 0x11 ] = &GBCpu::OpRL_r<C>;
-    m_OpcodeExtHandlers[ 0x12 ] = &GBCpu::OpRL_r<D>;
-    m_OpcodeExtHandlers[ 0x13 ] = &GBCpu::OpRL_r<E>;
-    m_OpcodeExtHandlers[ 0x14 ] = &GBCpu::OpRL_r<H>;
-    m_OpcodeExtHandlers[ 0x15 ] = &GBCpu::OpRL_r<L>;
-    m_OpcodeExtHandlers[ 0x16 ] = &GBCpu::OpRL_HL;
-    m_OpcodeExtHandlers[ 0x17 ] = &GBCpu::OpRL_r<A>;
-    m_OpcodeExtHandlers[ 0x18 ] = &GBCpu::OpRR_r<B>;
-    m_OpcodeExtHandlers[ 0x19 ] = &GBCpu::OpRR_r<C>;
-    m_OpcodeExtHandlers[ 0x1a ] = &GBCpu::OpRR_r<D>;
-    m_OpcodeExtHandlers[ 0x1b ] = &GBCpu::OpRR_r<E>;
-    m_OpcodeExtHandlers[ 0x1c ] = &GBCpu::OpRR_r<H>;
-    m_OpcodeExtHandlers[ 0x1d ] = &GBCpu::OpRR_r<L>;
-    m_OpcodeExtHandlers[ 0x1e ] = &GBCpu::OpRR_HL;
-    m_OpcodeExtHandlers[ 0x1f ] = &GBCpu::OpRR_r<A>;
-    m_OpcodeExtHandlers[ 0x20 ] = &GBCpu::OpSLA_r<B>;
-    m_OpcodeExtHandlers[ 0x21 ] = &GBCpu::OpSLA_r<C>;
-    m_OpcodeExtHandlers[ 0x22 ] = &GBCpu::OpSLA_r<D>;
-    m_OpcodeExtHandlers[ 0x23 ] = &GBCpu::OpSLA_r<E>;
-    m_OpcodeExtHandlers[ 0x24 ] = &GBCpu::OpSLA_r<H>;
-    m_OpcodeExtHandlers[ 0x25 ] = &GBCpu::OpSLA_r<L>;
-    m_OpcodeExtHandlers[ 0x26 ] = &GBCpu::OpSLA_HL;
-    m_OpcodeExtHandlers[ 0x27 ] = &GBCpu::OpSLA_r<A>;
-    m_OpcodeExtHandlers[ 0x28 ] = &GBCpu::OpSRA_r<B>;
-    m_OpcodeExtHandlers[ 0x29 ] = &GBCpu::OpSRA_r<C>;
-    m_OpcodeExtHandlers[ 0x2a ] = &GBCpu::OpSRA_r<D>;
-    m_OpcodeExtHandlers[ 0x2b ] = &GBCpu::OpSRA_r<E>;
-    m_OpcodeExtHandlers[ 0x2c ] = &GBCpu::OpSRA_r<H>;
-    m_OpcodeExtHandlers[ 0x2d ] = &GBCpu::OpSRA_r<L>;
-    m_OpcodeExtHandlers[ 0x2e ] = &GBCpu::OpSRA_HL;
-    m_OpcodeExtHandlers[ 0x2f ] = &GBCpu::OpSRA_r<A>;
-    m_OpcodeExtHandlers[ 0x30 ] = &GBCpu::OpSWAP_r<B>;
-    m_OpcodeExtHandlers[ 0x31 ] = &GBCpu::OpSWAP_r<C>;
-    m_OpcodeExtHandlers[ 0x32 ] = &GBCpu::OpSWAP_r<D>;
-    m_OpcodeExtHandlers[ 0x33 ] = &GBCpu::OpSWAP_r<E>;
-    m_OpcodeExtHandlers[ 0x34 ] = &GBCpu::OpSWAP_r<H>;
-    m_OpcodeExtHandlers[ 0x35 ] = &GBCpu::OpSWAP_r<L>;
-    m_OpcodeExtHandlers[ 0x36 ] = &GBCpu::OpSWAP_HL;
-    m_OpcodeExtHandlers[ 0x37 ] = &GBCpu::OpSWAP_r<A>;
-    m_OpcodeExtHandlers[ 0x38 ] = &GBCpu::OpSRL_r<B>;
-    m_OpcodeExtHandlers[ 0x39 ] = &GBCpu::OpSRL_r<C>;
-    m_OpcodeExtHandlers[ 0x3a ] = &GBCpu::OpSRL_r<D>;
-    m_OpcodeExtHandlers[ 0x3b ] = &GBCpu::OpSRL_r<E>;
-    m_OpcodeExtHandlers[ 0x3c ] = &GBCpu::OpSRL_r<H>;
-    m_OpcodeExtHandlers[ 0x3d ] = &GBCpu::OpSRL_r<L>;
-    m_OpcodeExtHandlers[ 0x3e ] = &GBCpu::OpSRL_HL;
-    m_OpcodeExtHandlers[ 0x3f ] = &GBCpu::OpSRL_r<A>;
-    m_OpcodeExtHandlers[ 0x40 ] = &GBCpu::OpBIT_r<0,B>;
-    m_OpcodeExtHandlers[ 0x41 ] = &GBCpu::OpBIT_r<0,C>;
-    m_OpcodeExtHandlers[ 0x42 ] = &GBCpu::OpBIT_r<0,D>;
-    m_OpcodeExtHandlers[ 0x43 ] = &GBCpu::OpBIT_r<0,E>;
-    m_OpcodeExtHandlers[ 0x44 ] = &GBCpu::OpBIT_r<0,H>;
-    m_OpcodeExtHandlers[ 0x45 ] = &GBCpu::OpBIT_r<0,L>;
-    m_OpcodeExtHandlers[ 0x46 ] = &GBCpu::OpBIT_HL<0>;
-    m_OpcodeExtHandlers[ 0x47 ] = &GBCpu::OpBIT_r<0,A>;
-    m_OpcodeExtHandlers[ 0x48 ] = &GBCpu::OpBIT_r<1,B>;
-    m_OpcodeExtHandlers[ 0x49 ] = &GBCpu::OpBIT_r<1,C>;
-    m_OpcodeExtHandlers[ 0x4a ] = &GBCpu::OpBIT_r<1,D>;
-    m_OpcodeExtHandlers[ 0x4b ] = &GBCpu::OpBIT_r<1,E>;
-    m_OpcodeExtHandlers[ 0x4c ] = &GBCpu::OpBIT_r<1,H>;
-    m_OpcodeExtHandlers[ 0x4d ] = &GBCpu::OpBIT_r<1,L>;
-    m_OpcodeExtHandlers[ 0x4e ] = &GBCpu::OpBIT_HL<1>;
-    m_OpcodeExtHandlers[ 0x4f ] = &GBCpu::OpBIT_r<1,A>;
-    m_OpcodeExtHandlers[ 0x50 ] = &GBCpu::OpBIT_r<2,B>;
-    m_OpcodeExtHandlers[ 0x51 ] = &GBCpu::OpBIT_r<2,C>;
-    m_OpcodeExtHandlers[ 0x52 ] = &GBCpu::OpBIT_r<2,D>;
-    m_OpcodeExtHandlers[ 0x53 ] = &GBCpu::OpBIT_r<2,E>;
-    m_OpcodeExtHandlers[ 0x54 ] = &GBCpu::OpBIT_r<2,H>;
-    m_OpcodeExtHandlers[ 0x55 ] = &GBCpu::OpBIT_r<2,L>;
-    m_OpcodeExtHandlers[ 0x56 ] = &GBCpu::OpBIT_HL<2>;
-    m_OpcodeExtHandlers[ 0x57 ] = &GBCpu::OpBIT_r<2,A>;
-    m_OpcodeExtHandlers[ 0x58 ] = &GBCpu::OpBIT_r<3,B>;
-    m_OpcodeExtHandlers[ 0x59 ] = &GBCpu::OpBIT_r<3,C>;
-    m_OpcodeExtHandlers[ 0x5a ] = &GBCpu::OpBIT_r<3,D>;
-    m_OpcodeExtHandlers[ 0x5b ] = &GBCpu::OpBIT_r<3,E>;
-    m_OpcodeExtHandlers[ 0x5c ] = &GBCpu::OpBIT_r<3,H>;
-    m_OpcodeExtHandlers[ 0x5d ] = &GBCpu::OpBIT_r<3,L>;
-    m_OpcodeExtHandlers[ 0x5e ] = &GBCpu::OpBIT_HL<3>;
-    m_OpcodeExtHandlers[ 0x5f ] = &GBCpu::OpBIT_r<3,A>;
-    m_OpcodeExtHandlers[ 0x60 ] = &GBCpu::OpBIT_r<4,B>;
-    m_OpcodeExtHandlers[ 0x61 ] = &GBCpu::OpBIT_r<4,C>;
-    m_OpcodeExtHandlers[ 0x62 ] = &GBCpu::OpBIT_r<4,D>;
-    m_OpcodeExtHandlers[ 0x63 ] = &GBCpu::OpBIT_r<4,E>;
-    m_OpcodeExtHandlers[ 0x64 ] = &GBCpu::OpBIT_r<4,H>;
-    m_OpcodeExtHandlers[ 0x65 ] = &GBCpu::OpBIT_r<4,L>;
-    m_OpcodeExtHandlers[ 0x66 ] = &GBCpu::OpBIT_HL<4>;
-    m_OpcodeExtHandlers[ 0x67 ] = &GBCpu::OpBIT_r<4,A>;
-    m_OpcodeExtHandlers[ 0x68 ] = &GBCpu::OpBIT_r<5,B>;
-    m_OpcodeExtHandlers[ 0x69 ] = &GBCpu::OpBIT_r<5,C>;
-    m_OpcodeExtHandlers[ 0x6a ] = &GBCpu::OpBIT_r<5,D>;
-    m_OpcodeExtHandlers[ 0x6b ] = &GBCpu::OpBIT_r<5,E>;
-    m_OpcodeExtHandlers[ 0x6c ] = &GBCpu::OpBIT_r<5,H>;
-    m_OpcodeExtHandlers[ 0x6d ] = &GBCpu::OpBIT_r<5,L>;
-    m_OpcodeExtHandlers[ 0x6e ] = &GBCpu::OpBIT_HL<5>;
-    m_OpcodeExtHandlers[ 0x6f ] = &GBCpu::OpBIT_r<5,A>;
-    m_OpcodeExtHandlers[ 0x70 ] = &GBCpu::OpBIT_r<6,B>;
-    m_OpcodeExtHandlers[ 0x71 ] = &GBCpu::OpBIT_r<6,C>;
-    m_OpcodeExtHandlers[ 0x72 ] = &GBCpu::OpBIT_r<6,D>;
-    m_OpcodeExtHandlers[ 0x73 ] = &GBCpu::OpBIT_r<6,E>;
-    m_OpcodeExtHandlers[ 0x74 ] = &GBCpu::OpBIT_r<6,H>;
-    m_OpcodeExtHandlers[ 0x75 ] = &GBCpu::OpBIT_r<6,L>;
-    m_OpcodeExtHandlers[ 0x76 ] = &GBCpu::OpBIT_HL<6>;
-    m_OpcodeExtHandlers[ 0x77 ] = &GBCpu::OpBIT_r<6,A>;
-    m_OpcodeExtHandlers[ 0x78 ] = &GBCpu::OpBIT_r<7,B>;
-    m_OpcodeExtHandlers[ 0x79 ] = &GBCpu::OpBIT_r<7,C>;
-    m_OpcodeExtHandlers[ 0x7a ] = &GBCpu::OpBIT_r<7,D>;
-    m_OpcodeExtHandlers[ 0x7b ] = &GBCpu::OpBIT_r<7,E>;
-    m_OpcodeExtHandlers[ 0x7c ] = &GBCpu::OpBIT_r<7,H>;
-    m_OpcodeExtHandlers[ 0x7d ] = &GBCpu::OpBIT_r<7,L>;
-    m_OpcodeExtHandlers[ 0x7e ] = &GBCpu::OpBIT_HL<7>;
-    m_OpcodeExtHandlers[ 0x7f ] = &GBCpu::OpBIT_r<7,A>;
-    m_OpcodeExtHandlers[ 0x80 ] = &GBCpu::OpRES_r<0,B>;
-    m_OpcodeExtHandlers[ 0x81 ] = &GBCpu::OpRES_r<0,C>;
-    m_OpcodeExtHandlers[ 0x82 ] = &GBCpu::OpRES_r<0,D>;
-    m_OpcodeExtHandlers[ 0x83 ] = &GBCpu::OpRES_r<0,E>;
-    m_OpcodeExtHandlers[ 0x84 ] = &GBCpu::OpRES_r<0,H>;
-    m_OpcodeExtHandlers[ 0x85 ] = &GBCpu::OpRES_r<0,L>;
-    m_OpcodeExtHandlers[ 0x86 ] = &GBCpu::OpRES_HL<0>;
-    m_OpcodeExtHandlers[ 0x87 ] = &GBCpu::OpRES_r<0,A>;
-    m_OpcodeExtHandlers[ 0x88 ] = &GBCpu::OpRES_r<1,B>;
-    m_OpcodeExtHandlers[ 0x89 ] = &GBCpu::OpRES_r<1,C>;
-    m_OpcodeExtHandlers[ 0x8a ] = &GBCpu::OpRES_r<1,D>;
-    m_OpcodeExtHandlers[ 0x8b ] = &GBCpu::OpRES_r<1,E>;
-    m_OpcodeExtHandlers[ 0x8c ] = &GBCpu::OpRES_r<1,H>;
-    m_OpcodeExtHandlers[ 0x8d ] = &GBCpu::OpRES_r<1,L>;
-    m_OpcodeExtHandlers[ 0x8e ] = &GBCpu::OpRES_HL<1>;
-    m_OpcodeExtHandlers[ 0x8f ] = &GBCpu::OpRES_r<1,A>;
-    m_OpcodeExtHandlers[ 0x90 ] = &GBCpu::OpRES_r<2,B>;
-    m_OpcodeExtHandlers[ 0x91 ] = &GBCpu::OpRES_r<2,C>;
-    m_OpcodeExtHandlers[ 0x92 ] = &GBCpu::OpRES_r<2,D>;
-    m_OpcodeExtHandlers[ 0x93 ] = &GBCpu::OpRES_r<2,E>;
-    m_OpcodeExtHandlers[ 0x94 ] = &GBCpu::OpRES_r<2,H>;
-    m_OpcodeExtHandlers[ 0x95 ] = &GBCpu::OpRES_r<2,L>;
-    m_OpcodeExtHandlers[ 0x96 ] = &GBCpu::OpRES_HL<2>;
-    m_OpcodeExtHandlers[ 0x97 ] = &GBCpu::OpRES_r<2,A>;
-    m_OpcodeExtHandlers[ 0x98 ] = &GBCpu::OpRES_r<3,B>;
-    m_OpcodeExtHandlers[ 0x99 ] = &GBCpu::OpRES_r<3,C>;
-    m_OpcodeExtHandlers[ 0x9a ] = &GBCpu::OpRES_r<3,D>;
-    m_OpcodeExtHandlers[ 0x9b ] = &GBCpu::OpRES_r<3,E>;
-    m_OpcodeExtHandlers[ 0x9c ] = &GBCpu::OpRES_r<3,H>;
-    m_OpcodeExtHandlers[ 0x9d ] = &GBCpu::OpRES_r<3,L>;
-    m_OpcodeExtHandlers[ 0x9e ] = &GBCpu::OpRES_HL<3>;
-    m_OpcodeExtHandlers[ 0x9f ] = &GBCpu::OpRES_r<3,A>;
-    m_OpcodeExtHandlers[ 0xa0 ] = &GBCpu::OpRES_r<4,B>;
-    m_OpcodeExtHandlers[ 0xa1 ] = &GBCpu::OpRES_r<4,C>;
-    m_OpcodeExtHandlers[ 0xa2 ] = &GBCpu::OpRES_r<4,D>;
-    m_OpcodeExtHandlers[ 0xa3 ] = &GBCpu::OpRES_r<4,E>;
-    m_OpcodeExtHandlers[ 0xa4 ] = &GBCpu::OpRES_r<4,H>;
-    m_OpcodeExtHandlers[ 0xa5 ] = &GBCpu::OpRES_r<4,L>;
-    m_OpcodeExtHandlers[ 0xa6 ] = &GBCpu::OpRES_HL<4>;
-    m_OpcodeExtHandlers[ 0xa7 ] = &GBCpu::OpRES_r<4,A>;
-    m_OpcodeExtHandlers[ 0xa8 ] = &GBCpu::OpRES_r<5,B>;
-    m_OpcodeExtHandlers[ 0xa9 ] = &GBCpu::OpRES_r<5,C>;
-    m_OpcodeExtHandlers[ 0xaa ] = &GBCpu::OpRES_r<5,D>;
-    m_OpcodeExtHandlers[ 0xab ] = &GBCpu::OpRES_r<5,E>;
-    m_OpcodeExtHandlers[ 0xac ] = &GBCpu::OpRES_r<5,H>;
-    m_OpcodeExtHandlers[ 0xad ] = &GBCpu::OpRES_r<5,L>;
-    m_OpcodeExtHandlers[ 0xae ] = &GBCpu::OpRES_HL<5>;
-    m_OpcodeExtHandlers[ 0xaf ] = &GBCpu::OpRES_r<5,A>;
-    m_OpcodeExtHandlers[ 0xb0 ] = &GBCpu::OpRES_r<6,B>;
-    m_OpcodeExtHandlers[ 0xb1 ] = &GBCpu::OpRES_r<6,C>;
-    m_OpcodeExtHandlers[ 0xb2 ] = &GBCpu::OpRES_r<6,D>;
-    m_OpcodeExtHandlers[ 0xb3 ] = &GBCpu::OpRES_r<6,E>;
-    m_OpcodeExtHandlers[ 0xb4 ] = &GBCpu::OpRES_r<6,H>;
-    m_OpcodeExtHandlers[ 0xb5 ] = &GBCpu::OpRES_r<6,L>;
-    m_OpcodeExtHandlers[ 0xb6 ] = &GBCpu::OpRES_HL<6>;
-    m_OpcodeExtHandlers[ 0xb7 ] = &GBCpu::OpRES_r<6,A>;
-    m_OpcodeExtHandlers[ 0xb8 ] = &GBCpu::OpRES_r<7,B>;
-    m_OpcodeExtHandlers[ 0xb9 ] = &GBCpu::OpRES_r<7,C>;
-    m_OpcodeExtHandlers[ 0xba ] = &GBCpu::OpRES_r<7,D>;
-    m_OpcodeExtHandlers[ 0xbb ] = &GBCpu::OpRES_r<7,E>;
-    m_OpcodeExtHandlers[ 0xbc ] = &GBCpu::OpRES_r<7,H>;
-    m_OpcodeExtHandlers[ 0xbd ] = &GBCpu::OpRES_r<7,L>;
-    m_OpcodeExtHandlers[ 0xbe ] = &GBCpu::OpRES_HL<7>;
-    m_OpcodeExtHandlers[ 0xbf ] = &GBCpu::OpRES_r<7,A>;
-    m_OpcodeExtHandlers[ 0xc0 ] = &GBCpu::OpSET_r<0,B>;
-    m_OpcodeExtHandlers[ 0xc1 ] = &GBCpu::OpSET_r<0,C>;
-    m_OpcodeExtHandlers[ 0xc2 ] = &GBCpu::OpSET_r<0,D>;
-    m_OpcodeExtHandlers[ 0xc3 ] = &GBCpu::OpSET_r<0,E>;
-    m_OpcodeExtHandlers[ 0xc4 ] = &GBCpu::OpSET_r<0,H>;
-    m_OpcodeExtHandlers[ 0xc5 ] = &GBCpu::OpSET_r<0,L>;
-    m_OpcodeExtHandlers[ 0xc6 ] = &GBCpu::OpSET_HL<0>;
-    m_OpcodeExtHandlers[ 0xc7 ] = &GBCpu::OpSET_r<0,A>;
-    m_OpcodeExtHandlers[ 0xc8 ] = &GBCpu::OpSET_r<1,B>;
-    m_OpcodeExtHandlers[ 0xc9 ] = &GBCpu::OpSET_r<1,C>;
-    m_OpcodeExtHandlers[ 0xca ] = &GBCpu::OpSET_r<1,D>;
-    m_OpcodeExtHandlers[ 0xcb ] = &GBCpu::OpSET_r<1,E>;
-    m_OpcodeExtHandlers[ 0xcc ] = &GBCpu::OpSET_r<1,H>;
-    m_OpcodeExtHandlers[ 0xcd ] = &GBCpu::OpSET_r<1,L>;
-    m_OpcodeExtHandlers[ 0xce ] = &GBCpu::OpSET_HL<1>;
-    m_OpcodeExtHandlers[ 0xcf ] = &GBCpu::OpSET_r<1,A>;
-    m_OpcodeExtHandlers[ 0xd0 ] = &GBCpu::OpSET_r<2,B>;
-    m_OpcodeExtHandlers[ 0xd1 ] = &GBCpu::OpSET_r<2,C>;
-    m_OpcodeExtHandlers[ 0xd2 ] = &GBCpu::OpSET_r<2,D>;
-    m_OpcodeExtHandlers[ 0xd3 ] = &GBCpu::OpSET_r<2,E>;
-    m_OpcodeExtHandlers[ 0xd4 ] = &GBCpu::OpSET_r<2,H>;
-    m_OpcodeExtHandlers[ 0xd5 ] = &GBCpu::OpSET_r<2,L>;
-    m_OpcodeExtHandlers[ 0xd6 ] = &GBCpu::OpSET_HL<2>;
-    m_OpcodeExtHandlers[ 0xd7 ] = &GBCpu::OpSET_r<2,A>;
-    m_OpcodeExtHandlers[ 0xd8 ] = &GBCpu::OpSET_r<3,B>;
-    m_OpcodeExtHandlers[ 0xd9 ] = &GBCpu::OpSET_r<3,C>;
-    m_OpcodeExtHandlers[ 0xda ] = &GBCpu::OpSET_r<3,D>;
-    m_OpcodeExtHandlers[ 0xdb ] = &GBCpu::OpSET_r<3,E>;
-    m_OpcodeExtHandlers[ 0xdc ] = &GBCpu::OpSET_r<3,H>;
-    m_OpcodeExtHandlers[ 0xdd ] = &GBCpu::OpSET_r<3,L>;
-    m_OpcodeExtHandlers[ 0xde ] = &GBCpu::OpSET_HL<3>;
-    m_OpcodeExtHandlers[ 0xdf ] = &GBCpu::OpSET_r<3,A>;
-    m_OpcodeExtHandlers[ 0xe0 ] = &GBCpu::OpSET_r<4,B>;
-    m_OpcodeExtHandlers[ 0xe1 ] = &GBCpu::OpSET_r<4,C>;
-    m_OpcodeExtHandlers[ 0xe2 ] = &GBCpu::OpSET_r<4,D>;
-    m_OpcodeExtHandlers[ 0xe3 ] = &GBCpu::OpSET_r<4,E>;
-    m_OpcodeExtHandlers[ 0xe4 ] = &GBCpu::OpSET_r<4,H>;
-    m_OpcodeExtHandlers[ 0xe5 ] = &GBCpu::OpSET_r<4,L>;
-    m_OpcodeExtHandlers[ 0xe6 ] = &GBCpu::OpSET_HL<4>;
-    m_OpcodeExtHandlers[ 0xe7 ] = &GBCpu::OpSET_r<4,A>;
-    m_OpcodeExtHandlers[ 0xe8 ] = &GBCpu::OpSET_r<5,B>;
-    m_OpcodeExtHandlers[ 0xe9 ] = &GBCpu::OpSET_r<5,C>;
-    m_OpcodeExtHandlers[ 0xea ] = &GBCpu::OpSET_r<5,D>;
-    m_OpcodeExtHandlers[ 0xeb ] = &GBCpu::OpSET_r<5,E>;
-    m_OpcodeExtHandlers[ 0xec ] = &GBCpu::OpSET_r<5,H>;
-    m_OpcodeExtHandlers[ 0xed ] = &GBCpu::OpSET_r<5,L>;
-    m_OpcodeExtHandlers[ 0xee ] = &GBCpu::OpSET_HL<5>;
-    m_OpcodeExtHandlers[ 0xef ] = &GBCpu::OpSET_r<5,A>;
-    m_OpcodeExtHandlers[ 0xf0 ] = &GBCpu::OpSET_r<6,B>;
-    m_OpcodeExtHandlers[ 0xf1 ] = &GBCpu::OpSET_r<6,C>;
-    m_OpcodeExtHandlers[ 0xf2 ] = &GBCpu::OpSET_r<6,D>;
-    m_OpcodeExtHandlers[ 0xf3 ] = &GBCpu::OpSET_r<6,E>;
-    m_OpcodeExtHandlers[ 0xf4 ] = &GBCpu::OpSET_r<6,H>;
-    m_OpcodeExtHandlers[ 0xf5 ] = &GBCpu::OpSET_r<6,L>;
-    m_OpcodeExtHandlers[ 0xf6 ] = &GBCpu::OpSET_HL<6>;
-    m_OpcodeExtHandlers[ 0xf7 ] = &GBCpu::OpSET_r<6,A>;
-    m_OpcodeExtHandlers[ 0xf8 ] = &GBCpu::OpSET_r<7,B>;
-    m_OpcodeExtHandlers[ 0xf9 ] = &GBCpu::OpSET_r<7,C>;
-    m_OpcodeExtHandlers[ 0xfa ] = &GBCpu::OpSET_r<7,D>;
-    m_OpcodeExtHandlers[ 0xfb ] = &GBCpu::OpSET_r<7,E>;
-    m_OpcodeExtHandlers[ 0xfc ] = &GBCpu::OpSET_r<7,H>;
-    m_OpcodeExtHandlers[ 0xfd ] = &GBCpu::OpSET_r<7,L>;
-    m_OpcodeExtHandlers[ 0xfe ] = &GBCpu::OpSET_HL<7>;
-    m_OpcodeExtHandlers[ 0xff ] = &GBCpu::OpSET_r<7,A>;
+#if CPU_BLOCK_CACHE
+    m_pBlockCache = new GBCpuBlockCache();
+#endif
+
+#if CPU_TRACE
+    if( !m_oOptions.strTraceFilepath.empty() )
+    {
+        m_pTrace = new GBCpuTrace();
+        if( !m_pTrace->Open( m_oOptions.strTraceFilepath.c_str() ) )
+        {
+            delete m_pTrace;
+            m_pTrace = NULL;
+        }
+    }
+#endif
+
+#if CPU_HOTSPOTS
+    if( !m_oOptions.strHotSpotFilepath.empty() )
+    {
+        m_pHotSpots = new GBCpuHotSpots();
+    }
+#endif
+
+#if !GB_COMPACT
+    m_pHistory = new CpuState[ DebugHistorySize ];
+#endif
 
     m_bInitialized = true;
 }
@@ -580,6 +637,37 @@ void GBCpu::Initialize()
 //----------------------------------------------------------------------------------------------------
 void GBCpu::Terminate()
 {
+    delete [] m_pHistory;
+    m_pHistory = NULL;
+
+#if CPU_TRACE
+    // Closing waits for the writer to get the rest of the buffer into the file
+    delete m_pTrace;
+    m_pTrace = NULL;
+#endif
+
+#if CPU_HOTSPOTS
+    if( NULL != m_pHotSpots )
+    {
+        const string& strFilepath = m_oOptions.strHotSpotFilepath;
+        if( m_pHotSpots->WriteReport( strFilepath.c_str() ) )
+        {
+            Log()->Write( LOG_COLOR_WHITE, "Wrote hot spots to %s", strFilepath.c_str() );
+        }
+        else
+        {
+            Log()->Write( LOG_COLOR_YELLOW, "Unable to write hot spots to %s", strFilepath.c_str() );
+        }
+
+        delete m_pHotSpots;
+        m_pHotSpots = NULL;
+    }
+#endif
+
+    delete m_pBlockCache;
+    m_pBlockCache = NULL;
+    m_pBlock = NULL;
+
     m_bInitialized = false;
 }
 
@@ -588,54 +676,64 @@ void GBCpu::Reset()
 {
     if( GBUserPrefs::Instance()->IsBiosEnabled() )
     {
-        m_PC = 0;
-        m_SP = 0xFFFF;
-
-        m_Registers[ A ] = 0;
-        m_Registers[ B ] = 0;
-        m_Registers[ C ] = 0;
-        m_Registers[ D ] = 0;
-        m_Registers[ E ] = 0;
-        m_Registers[ F ] = 0;
-        m_Registers[ H ] = 0;
-        m_Registers[ L ] = 0;
+        m_State.u16PC = 0;
+        m_State.u16SP = 0xFFFF;
+
+        m_State.u8Registers[ A ] = 0;
+        m_State.u8Registers[ B ] = 0;
+        m_State.u8Registers[ C ] = 0;
+        m_State.u8Registers[ D ] = 0;
+        m_State.u8Registers[ E ] = 0;
+        m_State.u8Registers[ F ] = 0;
+        m_State.u8Registers[ H ] = 0;
+        m_State.u8Registers[ L ] = 0;
     }
     else
     {
         // Register state after bios has executed
-        m_PC = 0x100;
-        m_SP = 0xFFFE;
-
-        m_Registers[ A ] = 0x01;
-        m_Registers[ B ] = 0x00;
-        m_Registers[ C ] = 0x13;
-        m_Registers[ D ] = 0x00;
-        m_Registers[ E ] = 0xD8;
-        m_Registers[ F ] = 0xB0;
-        m_Registers[ H ] = 0x01;
-        m_Registers[ L ] = 0x4D;
+        m_State.u16PC = 0x100;
+        m_State.u16SP = 0xFFFE;
+
+        m_State.u8Registers[ A ] = 0x01;
+        m_State.u8Registers[ B ] = 0x00;
+        m_State.u8Registers[ C ] = 0x13;
+        m_State.u8Registers[ D ] = 0x00;
+        m_State.u8Registers[ E ] = 0xD8;
+        m_State.u8Registers[ F ] = 0xB0;
+        m_State.u8Registers[ H ] = 0x01;
+        m_State.u8Registers[ L ] = 0x4D;
     }
 
-    m_bIME              = true;
-    m_bHalt             = false;
-    m_bStop             = false;
+    m_State.u8FlagOp          = kFlagOpNone;
+
+    m_State.bIME              = true;
+    m_State.bHalt             = false;
+    m_State.bStop             = false;
 
-    m_u8InterruptFlags  = 0;
-    m_u8InterruptEnable = 0;
+    m_u32HaltSkippedCycles = 0;
+    m_u32IdleSkippedCycles = 0;
+
+    m_State.u8InterruptFlags  = 0;
+    m_State.u8InterruptEnable = 0;
+    m_State.u8InterruptLines  = 0;
+    m_State.u8InterruptPending = 0;
+    m_State.u8EIDelay         = 0;
+
+    FlushBlockCache();
 
     /*
     // Init code to skip bios
 
-    m_Registers[ A ]    = 0x01;
-    m_Registers[ B ]    = 0x00;
-    m_Registers[ C ]    = 0x13;
-    m_Registers[ D ]    = 0x00;
-    m_Registers[ E ]    = 0xD8;
-    m_Registers[ F ]    = 0xB0;
-    m_Registers[ H ]    = 0x01;
-    m_Registers[ L ]    = 0x4D;
+    m_State.u8Registers[ A ]    = 0x01;
+    m_State.u8Registers[ B ]    = 0x00;
+    m_State.u8Registers[ C ]    = 0x13;
+    m_State.u8Registers[ D ]    = 0x00;
+    m_State.u8Registers[ E ]    = 0xD8;
+    m_State.u8Registers[ F ]    = 0xB0;
+    m_State.u8Registers[ H ]    = 0x01;
+    m_State.u8Registers[ L ]    = 0x4D;
 
-    m_SP                = 0xFFFE;
+    m_State.u16SP                = 0xFFFE;
 
     [$FF05] = $00   ; TIMA
     [$FF06] = $00   ; TMA
@@ -672,15 +770,36 @@ void GBCpu::Reset()
 
     CpuState state;
     m_u32HistoryIndex = 0;
-    for( int i = 0; i < DebugHistorySize; ++i )
+    for( int i = 0; NULL != m_pHistory && i < DebugHistorySize; ++i )
     {
-        m_u16History[ i ] = state;
+        m_pHistory[ i ] = state;
     }
 
     m_DebugPC = 0x60a7;
     m_bInit = false;
 }
 
+//----------------------------------------------------------------------------------------------------
+uint32 GBCpu::GetHistoryBytes() const
+{
+    return ( NULL != m_pHistory ) ? DebugHistorySize * sizeof( CpuState ) : 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+uint32 GBCpu::GetBlockCacheBytes() const
+{
+    uint32 u32Bytes = 0;
+
+#if CPU_BLOCK_CACHE
+    if( NULL != m_pBlockCache )
+    {
+        u32Bytes += sizeof( GBCpuBlockCache ) + kCpuBlockCacheSize * sizeof( GBCpuBlock );
+    }
+#endif
+
+    return u32Bytes;
+}
+
 //----------------------------------------------------------------------------------------------------
 void GBCpu::SetPC( uint16 u16PC )
 {
@@ -702,10 +821,16 @@ void GBCpu::SetPC( uint16 u16PC )
 //----------------------------------------------------------------------------------------------------
 int GBCpu::ExecuteOpcode()
 {
+    return ExecuteOpcodeCore<CPU_SWITCH_CORE != 0>();
+}
+
+//----------------------------------------------------------------------------------------------------
+template<bool SWITCH_CORE>
+int GBCpu::ExecuteOpcodeCore()
+{
     PROFILE( "Cpu::ExecuteOpcode" );
 
     uint32              iCycles        = 4;
-    GBCpuOpcodeHandler  pfnHandler;
     ubyte               opcode;
 
     if( IsRunning() )
@@ -714,7 +839,7 @@ int GBCpu::ExecuteOpcode()
 #ifdef _DEBUG
         if( !m_pMem->IsBootRomEnabled() )
         {
-            if( m_PC > 0 && m_PC == m_DebugPC )
+            if( m_State.u16PC > 0 && m_State.u16PC == m_DebugPC )
             {
                 m_bInit = true;
             }
@@ -722,7 +847,7 @@ int GBCpu::ExecuteOpcode()
             if( m_bInit )
             {
                 CpuState state( this );
-                m_u16History[ m_u32HistoryIndex++ ] = state;
+                m_pHistory[ m_u32HistoryIndex++ ] = state;
                 if( m_u32HistoryIndex >= DebugHistorySize )
                 {
                     m_u32HistoryIndex = 0;
@@ -731,16 +856,46 @@ int GBCpu::ExecuteOpcode()
         }
 #endif
         */
-        //SetPC( m_PC );
+        //SetPC( m_State.u16PC );
 
-        // Grab the current opcode
-        opcode = ReadMemory( m_PC++ );
+#if CPU_TRACE
+        if( NULL != m_pTrace )
+        {
+            RecordTrace();
+        }
+#endif
 
-        // Get the handler for this opcode
-        pfnHandler  = m_OpcodeHandlers[ opcode ];
+#if CPU_BLOCK_CACHE
+        const GBCpuDecodedOp* pOp = FetchDecodedOp();
+        if( NULL != pOp )
+        {
+            int iSkippedCycles = 0;
+
+#if CPU_IDLE_LOOPS
+            // Polling loops that can't see anything change before the next event are skipped whole
+            if(     1 == m_u8BlockOp
+                &&  kCpuBlockNotIdle != m_pBlock->u8IdleLoop )
+            {
+                iSkippedCycles = SkipIdleLoop();
+            }
+#endif
+
+            return iSkippedCycles + ExecuteDecodedOp<SWITCH_CORE>( pOp );
+        }
+#endif
 
-        // Invoke the handler
-        iCycles = (this->*pfnHandler)();
+        // Grab the current opcode
+        opcode = ReadMemory( m_State.u16PC++ );
+
+        if( SWITCH_CORE )
+        {
+            iCycles = DispatchOpcode( opcode );
+        }
+        else
+        {
+            // Get the handler for this opcode and invoke it
+            iCycles = (this->*OPCODE_INFO[ opcode ].pfnHandler)();
+        }
     }
     else
     {
@@ -751,80 +906,166 @@ int GBCpu::ExecuteOpcode()
     return iCycles;
 }
 
+// Both cores are always built so they can be benchmarked against each other
+template int GBCpu::ExecuteOpcodeCore<true>();
+template int GBCpu::ExecuteOpcodeCore<false>();
+
 //----------------------------------------------------------------------------------------------------
-void GBCpu::RaiseInterrupt( Interrupt interrupt )
+int GBCpu::RunUntil( int iCycleDeadline )
 {
-    // Set the interrupt request
-    m_u8InterruptFlags |= interrupt;
+    return RunUntilCore<CPU_SWITCH_CORE != 0>( iCycleDeadline );
 }
 
 //----------------------------------------------------------------------------------------------------
-int GBCpu::HandleInterrupts()
-{
-    PROFILE( "Cpu::HandleInterrupts" );
+template<bool SWITCH_CORE>
+int GBCpu::RunUntilCore( int iCycleDeadline )
+{
+    PROFILE( "Cpu::RunUntil" );
+
+    int iCycles = 0;
 
-    if(     m_u8InterruptEnable & VBlank
-        &&  m_u8InterruptFlags & VBlank )
+    m_bYield = false;
+    ++m_u32RunCount;
+
+    // At least one instruction always runs, the deadline is already behind us if the last run overshot it
+    do
     {
-        m_bHalt = false;
+        m_iCycleBudget = iCycleDeadline - iCycles;
 
-        if( m_bIME )
+        // A halted CPU without an enabled request pending can only be woken by the timer before the deadline
+        if(     !IsRunning()
+            &&  0 == ( m_State.u8InterruptEnable & ( m_State.u8InterruptFlags | m_State.u8InterruptLines ) & 0x1F ) )
         {
-            m_u8InterruptFlags &= ~VBlank;
-            return ExecuteInterrupt( 0x40 );
+            iCycles += SkipHalt( iCycleDeadline - iCycles );
         }
-    }
-    
-    if(     m_u8InterruptEnable & LCDStatus
-        &&  m_u8InterruptFlags & LCDStatus )
-    {
-        m_bHalt = false;
-        
-        if( m_bIME )
+        else
         {
-            m_u8InterruptFlags &= ~LCDStatus;
-            return ExecuteInterrupt( 0x48 );
+#if CPU_HOTSPOTS
+            iCycles += ( NULL != m_pHotSpots ) ? ExecuteHotSpotOpcode() : ExecuteOpcodeCore<SWITCH_CORE>();
+#else
+            iCycles += ExecuteOpcodeCore<SWITCH_CORE>();
+#endif
         }
-    }
-    
-    if(     m_u8InterruptEnable & Timer
-        &&  m_u8InterruptFlags & Timer )
-    {
-        m_bHalt = false;
-        
-        if( m_bIME )
+
+        // Nothing to do unless a delayed EI is waiting, or an enabled request can be serviced or wake the
+        // CPU. With IME clear a running CPU just leaves the request pending.
+        if(     0 != m_State.u8InterruptPending
+            &&  (   m_State.bIME
+                ||  !IsRunning()
+                ||  0 != ( m_State.u8InterruptPending & kInterruptEIDelay ) ) )
         {
-            m_u8InterruptFlags &= ~Timer;
-            return ExecuteInterrupt( 0x50 );
+            iCycles += HandleInterrupts();
         }
-    }
-    
-    if(     m_u8InterruptEnable & Serial
-        &&  m_u8InterruptFlags & Serial )
-    {
-        m_bHalt = false;
-        
-        if( m_bIME )
+
+        if( 0 != ( m_State.u8InterruptLines & ~m_State.u8InterruptFlags ) )
         {
-            m_u8InterruptFlags &= ~Serial;
-            return ExecuteInterrupt( 0x58 );
+            m_State.u8InterruptFlags |= m_State.u8InterruptLines;
+            UpdateInterruptPending();
         }
     }
-    
-    if(     m_u8InterruptEnable & Input
-        &&  m_u8InterruptFlags & Input )
+    while(      iCycles < iCycleDeadline
+            &&  !m_bYield );
+
+    return iCycles;
+}
+
+template int GBCpu::RunUntilCore<true>( int iCycleDeadline );
+template int GBCpu::RunUntilCore<false>( int iCycleDeadline );
+
+//----------------------------------------------------------------------------------------------------
+int GBCpu::SkipHalt( int iCycles )
+{
+    PROFILE( "Cpu::SkipHalt" );
+
+    // Same as stepping the halted CPU 4 cycles at a time, stopping at the step that overflows TIMA.
+    // At least one step is always taken.
+    int iSkip = ( iCycles + 3 ) & ~3;
+
+    int iOverflow = m_pTimer->GetCyclesUntilOverflow();
+    if( iSkip > iOverflow )
+    {
+        iSkip = iOverflow;
+    }
+
+    if( iSkip < 4 )
+    {
+        iSkip = 4;
+    }
+
+    m_pTimer->Update( iSkip );
+
+    m_u32HaltSkippedCycles += iSkip;
+
+    return iSkip;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpu::RaiseInterrupt( Interrupt interrupt )
+{
+    // Set the interrupt request
+    m_State.u8InterruptFlags |= interrupt;
+    UpdateInterruptPending();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpu::SetInterruptLine( Interrupt interrupt, bool bAsserted )
+{
+    // A held line raises the request after every instruction until the peripheral releases it
+    if( bAsserted )
     {
-        m_bHalt = false;
-        m_bStop = false;
-        
-        if( m_bIME )
+        m_State.u8InterruptLines |= interrupt;
+    }
+    else
+    {
+        m_State.u8InterruptLines &= ~interrupt;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+int GBCpu::HandleInterrupts()
+{
+    PROFILE( "Cpu::HandleInterrupts" );
+
+    // EI only sets IME once the instruction after it is done
+    if( 0 != m_State.u8EIDelay )
+    {
+        if( 0 != --m_State.u8EIDelay )
         {
-            m_u8InterruptFlags &= ~Input;
-            return ExecuteInterrupt( 0x60 );
+            return 0;
         }
+
+        m_State.bIME = true;
+        UpdateInterruptPending();
     }
 
-    return 0;
+    ubyte u8Pending = m_State.u8InterruptPending & kInterruptRequests;
+    if( 0 == u8Pending )
+    {
+        return 0;
+    }
+
+    // Any enabled request wakes the CPU, it is only serviced with IME set
+    m_State.bHalt = false;
+
+    // Only the joypad brings the CPU out of STOP
+    if( u8Pending & Input )
+    {
+        m_State.bStop = false;
+    }
+
+    if( !m_State.bIME )
+    {
+        return 0;
+    }
+
+    // The lowest bit has the highest priority, VBlank at 0x40 through Input at 0x60
+    unsigned long ulInterrupt;
+    _BitScanForward( &ulInterrupt, u8Pending );
+
+    m_State.u8InterruptFlags &= ~( 1 << ulInterrupt );
+    UpdateInterruptPending();
+
+    return ExecuteInterrupt( static_cast<uint16>( 0x40 + ulInterrupt * 8 ) );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -840,6 +1081,17 @@ void GBCpu::WriteMemory( uint16 u16Addr, ubyte u8Data )
 {
     m_pMem->WriteMemory( u16Addr, u8Data );
     m_pTimer->Update( 4 );
+
+    // I/O writes can need the other modules to update before the next instruction
+    if(     u16Addr >= 0xFF00
+        &&  ( u16Addr < 0xFF80 || 0xFFFF == u16Addr ) )
+    {
+        m_bYield = true;
+    }
+
+#if CPU_BLOCK_CACHE
+    InvalidateBlocks( u16Addr );
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -848,14 +1100,93 @@ void GBCpu::SimulateIO( ubyte u8Clocks )
     m_pTimer->Update( u8Clocks );
 }
 
+//----------------------------------------------------------------------------------------------------
+inline ubyte GBCpu::FetchOperand()
+{
+    // Immediates of a predecoded op come from the block cache, the bus read is only simulated
+    if( NULL != m_pu8Operand )
+    {
+        SimulateIO( 4 );
+        ++m_State.u16PC;
+        return *m_pu8Operand++;
+    }
+
+    return ReadMemory( m_State.u16PC++ );
+}
+
+//----------------------------------------------------------------------------------------------------
+inline void GBCpu::SetLazyFlags( FlagOp op, uint16 u16Result, ubyte u8Operands )
+{
+    m_State.u8FlagOp          = op;
+    m_State.u16FlagResult     = u16Result;
+    m_State.u8FlagOperands    = u8Operands;
+
+#if !CPU_LAZY_FLAGS
+    EvaluateFlags();
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+inline void GBCpu::SetLazyFlagsKeepCarry( FlagOp op, ubyte u8Result )
+{
+    SetLazyFlags( op, u8Result, GetRegisterFlag( CF ) ? CF : 0 );
+}
+
+//----------------------------------------------------------------------------------------------------
+inline bool GBCpu::GetRegisterFlag( RegisterFlag flag )
+{
+    // Zero and carry are what branches test, they come straight from the recorded result
+    if( ZF == flag && kFlagOpNone != m_State.u8FlagOp && kFlagOpRotateA != m_State.u8FlagOp )
+    {
+        return 0 == static_cast<ubyte>( m_State.u16FlagResult );
+    }
+
+    if( CF == flag && kFlagOpNone != m_State.u8FlagOp )
+    {
+        return ( m_State.u8FlagOp >= kFlagOpInc ) ? 0 != m_State.u8FlagOperands : m_State.u16FlagResult > 0xFF;
+    }
+
+    MaterializeFlags();
+
+    return 0 != ( m_State.u8Registers[ F ] & flag );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpu::EvaluateFlags()
+{
+    ubyte u8Result  = static_cast<ubyte>( m_State.u16FlagResult );
+    ubyte u8Zero    = u8Result ? 0 : ZF;
+    ubyte u8Half    = ( ( m_State.u8FlagOperands ^ m_State.u16FlagResult ) & 0x10 ) ? HF : 0;
+    ubyte u8Carry   = ( m_State.u16FlagResult > 0xFF ) ? CF : 0;
+
+    switch( m_State.u8FlagOp )
+    {
+    case kFlagOpAdd:      m_State.u8Registers[ F ] = u8Zero | u8Half | u8Carry;                                                     break;
+    case kFlagOpSub:      m_State.u8Registers[ F ] = u8Zero | NF | u8Half | u8Carry;                                                break;
+    case kFlagOpAnd:      m_State.u8Registers[ F ] = u8Zero | HF;                                                                   break;
+    case kFlagOpLogic:    m_State.u8Registers[ F ] = u8Zero | u8Carry;                                                              break;
+    case kFlagOpRotateA:  m_State.u8Registers[ F ] = u8Carry;                                                                       break;
+    case kFlagOpInc:      m_State.u8Registers[ F ] = m_State.u8FlagOperands | u8Zero | ( ( u8Result & 0x0F ) ? 0 : HF );                  break;
+    case kFlagOpDec:      m_State.u8Registers[ F ] = m_State.u8FlagOperands | u8Zero | NF | ( ( 0x0F == ( u8Result & 0x0F ) ) ? HF : 0 ); break;
+    case kFlagOpBit:      m_State.u8Registers[ F ] = m_State.u8FlagOperands | u8Zero | HF;                                                break;
+    }
+
+    m_State.u8FlagOp = kFlagOpNone;
+}
+
 //----------------------------------------------------------------------------------------------------
 void GBCpu::DebugDumpHistory()
 {
     CpuState* state;
+    if( NULL == m_pHistory )
+    {
+        return;
+    }
+
     Log()->BeginBatchWrite();
     for( int i = 0; i < DebugHistorySize; ++i )
     {
-        state = &m_u16History[ m_u32HistoryIndex++ ];
+        state = &m_pHistory[ m_u32HistoryIndex++ ];
         Log()->BatchWrite( LOG_COLOR_WHITE, "PC=0x%04x AF=0x%04x BC=0x%04x DE=0x%04x HL=0x%04x SP=0x%04x ", state->PC, state->AF, state->BC, state->DE, state->HL, state->SP );
         if( m_u32HistoryIndex >= DebugHistorySize )
         {
@@ -873,10 +1204,10 @@ int GBCpu::ExecuteExtOpcode()
     uint32              iCycles        = 0;
 
     // Grab the current opcode
-    extopcode   = ReadMemory( m_PC++ );
+    extopcode   = ReadMemory( m_State.u16PC++ );
 
     // Get the handler for this opcode
-    pfnHandler  = m_OpcodeExtHandlers[ extopcode ];
+    pfnHandler  = EXT_OPCODE_INFO[ extopcode ].pfnHandler;
 
     // Invoke the handler
     iCycles = (this->*pfnHandler)();
@@ -890,18 +1221,441 @@ int GBCpu::ExecuteInterrupt( uint16 addr )
 {
     PROFILE( "ExecuteInterrupt" );
 
-    m_bIME = false;
+    m_State.bIME = false;
 
-    WriteMemory( --m_SP, m_PC >> 8 );
-    WriteMemory( --m_SP, m_PC & 0xFF );
+    WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+    WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
     SimulateIO( 8 );
 
-    m_PC = addr;
+    m_State.u16PC = addr;
 
     return 20;
 }
 
+//----------------------------------------------------------------------------------------------------
+bool GBCpu::GetBlockRegion( uint16 u16PC, uint32& u32Key, uint32& u32End )
+{
+    // Only code that can't be changed behind the CPU's back is cached. ROM is keyed by the bank that
+    // is mapped in, WRAM and HRAM blocks never leave their page so a write to the page retires them.
+    // While OAM DMA runs only HRAM can be fetched, the rest is left to the interpreter.
+    if( m_pMem->IsOamDmaActive() && u16PC < 0xFF80 )
+    {
+        return false;
+    }
+
+    if( u16PC >= 0x0100 && u16PC < 0x4000 )
+    {
+        u32Key  = u16PC;
+        u32End  = 0x4000;
+        return true;
+    }
+
+    if( u16PC >= 0x4000 && u16PC < 0x8000 )
+    {
+        u32Key  = ( m_pMem->GetRomBank() << 16 ) | u16PC;
+        u32End  = 0x8000;
+        return true;
+    }
+
+    if( u16PC >= 0xC000 && u16PC < 0xE000 )
+    {
+        u32Key  = u16PC;
+        u32End  = ( u16PC & 0xFF00 ) + 0x100;
+        return true;
+    }
+
+    if( u16PC >= 0xFF80 && u16PC < 0xFFFF )
+    {
+        u32Key  = u16PC;
+        u32End  = 0xFFFF;
+        return true;
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBlock* GBCpu::DecodeBlock( uint32 u32Key, uint32 u32End )
+{
+    PROFILE( "Cpu::DecodeBlock" );
+
+    GBCpuBlock* pBlock  = m_pBlockCache->Allocate( u32Key );
+    uint32      u32PC   = pBlock->u16StartPC;
+
+    while( pBlock->u8OpCount < kCpuBlockMaxOps )
+    {
+        // Decoding reads straight from memory, the CPU hasn't spent any cycles on these bytes yet
+        ubyte u8Opcode  = m_pMem->ReadMemory( static_cast<uint16>( u32PC ) );
+        const OpcodeInfo* pInfo = &OPCODE_INFO[ u8Opcode ];
+        ubyte u8Length          = pInfo->u8Length;
+
+        // Invalid opcodes and instructions that straddle the end of the region are left to the interpreter
+        if(     0 == u8Length
+            ||  u32PC + u8Length > u32End )
+        {
+            break;
+        }
+
+        GBCpuDecodedOp* pOp = &pBlock->oOps[ pBlock->u8OpCount++ ];
+        pOp->u8Opcode       = u8Opcode;
+        pOp->u8ExtOpcode    = 0;
+        pOp->u8Operands[ 0 ]= 0;
+        pOp->u8Operands[ 1 ]= 0;
+        pOp->u8Length       = u8Length;
+
+        if( 0xCB == u8Opcode )
+        {
+            pOp->u8ExtOpcode    = m_pMem->ReadMemory( static_cast<uint16>( u32PC + 1 ) );
+            pOp->pfnHandler     = EXT_OPCODE_INFO[ pOp->u8ExtOpcode ].pfnHandler;
+            pOp->u8Cycles       = EXT_OPCODE_INFO[ pOp->u8ExtOpcode ].u8Cycles;
+        }
+        else
+        {
+            pOp->pfnHandler     = pInfo->pfnHandler;
+            pOp->u8Cycles       = pInfo->u8Cycles;
+
+            for( ubyte i = 1; i < u8Length; ++i )
+            {
+                pOp->u8Operands[ i - 1 ] = m_pMem->ReadMemory( static_cast<uint16>( u32PC + i ) );
+            }
+        }
+
+        pBlock->u32Cycles  += pOp->u8Cycles;
+        u32PC              += u8Length;
+
+        // Anything that changes control flow or the interrupt state ends the block
+        switch( u8Opcode )
+        {
+            case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:   // STOP, JR
+            case 0x76:                                                          // HALT
+            case 0xC0: case 0xC2: case 0xC3: case 0xC4: case 0xC8: case 0xC9:   // RET, JP, CALL
+            case 0xCA: case 0xCC: case 0xCD: case 0xD0: case 0xD2: case 0xD4:
+            case 0xD8: case 0xD9: case 0xDA: case 0xDC: case 0xE9:              // RETI, JP (HL)
+            case 0xC7: case 0xCF: case 0xD7: case 0xDF:                         // RST
+            case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            case 0xF3: case 0xFB:                                               // DI, EI
+                return pBlock;
+        }
+    }
+
+    return pBlock;
+}
+
+//----------------------------------------------------------------------------------------------------
+const GBCpuDecodedOp* GBCpu::FetchDecodedOp()
+{
+    // Fall through to the next op of the current block
+    if(     NULL != m_pBlock
+        &&  m_State.u16PC == m_u16BlockPC
+        &&  m_u8BlockOp < m_pBlock->u8OpCount )
+    {
+        const GBCpuDecodedOp* pOp = &m_pBlock->oOps[ m_u8BlockOp++ ];
+        m_u16BlockPC += pOp->u8Length;
+        return pOp;
+    }
+
+    m_pBlock = NULL;
+
+    uint32 u32Key;
+    uint32 u32End;
+    if( !GetBlockRegion( m_State.u16PC, u32Key, u32End ) )
+    {
+        return NULL;
+    }
+
+    GBCpuBlock* pBlock = m_pBlockCache->Find( u32Key );
+    if( NULL == pBlock )
+    {
+        pBlock = DecodeBlock( u32Key, u32End );
+    }
+
+    if( 0 == pBlock->u8OpCount )
+    {
+        return NULL;
+    }
+
+    m_pBlock        = pBlock;
+    m_u8BlockOp     = 1;
+    m_u16BlockPC    = m_State.u16PC + pBlock->oOps[ 0 ].u8Length;
+
+    return &pBlock->oOps[ 0 ];
+}
+
+//----------------------------------------------------------------------------------------------------
+template<bool SWITCH_CORE>
+int GBCpu::ExecuteDecodedOp( const GBCpuDecodedOp* pOp )
+{
+    int iCycles;
+
+    // The opcode fetch still takes a bus cycle, it just doesn't touch the bus
+    SimulateIO( 4 );
+    ++m_State.u16PC;
+
+    m_pu8Operand = pOp->u8Operands;
+
+    if( 0xCB == pOp->u8Opcode )
+    {
+        SimulateIO( 4 );
+        ++m_State.u16PC;
+
+        iCycles = SWITCH_CORE ? DispatchExtOpcode( pOp->u8ExtOpcode ) : (this->*pOp->pfnHandler)();
+    }
+    else
+    {
+        iCycles = SWITCH_CORE ? DispatchOpcode( pOp->u8Opcode ) : (this->*pOp->pfnHandler)();
+    }
+
+    m_pu8Operand = NULL;
+
+    return iCycles;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpu::InvalidateBlocks( uint16 u16Addr )
+{
+    // Writes to ROM are MBC commands and may have switched the bank under the current block
+    if( u16Addr < 0x8000 )
+    {
+        m_pBlock    = NULL;
+        m_bYield    = true;
+        return;
+    }
+
+    // Starting OAM DMA takes everything but HRAM off the bus, the next fetch has to go through
+    // GetBlockRegion instead of falling through the current block
+    if( MMIODMATransfer == u16Addr )
+    {
+        m_pBlock = NULL;
+        return;
+    }
+
+    // Echo RAM writes land in WRAM
+    if( u16Addr >= 0xE000 && u16Addr < 0xFE00 )
+    {
+        u16Addr -= 0x2000;
+    }
+
+    if(     ( u16Addr >= 0xC000 && u16Addr < 0xE000 )
+        ||  ( u16Addr >= 0xFF80 && u16Addr < 0xFFFF ) )
+    {
+        ubyte u8Page = u16Addr >> 8;
+
+        m_pBlockCache->InvalidatePage( u8Page );
+
+        if(     NULL != m_pBlock
+            &&  ( m_pBlock->u16StartPC >> 8 ) == u8Page )
+        {
+            m_pBlock = NULL;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpu::FlushBlockCache()
+{
+    if( NULL != m_pBlockCache )
+    {
+        m_pBlockCache->Flush();
+    }
+
+    m_pBlock        = NULL;
+    m_pIdleBlock    = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+static bool IsTimerRegister( uint16 u16Addr )
+{
+    // DIV and TIMA change on their own, a loop reading them never settles
+    return 0xFF04 == u16Addr || 0xFF05 == u16Addr;
+}
+
+//----------------------------------------------------------------------------------------------------
+static bool IsIdleLoopOp( const GBCpuDecodedOp* pOp )
+{
+    ubyte u8Opcode = pOp->u8Opcode;
+
+    // LD r,r' into B/C/D/E/A, H and L have to keep their value so (HL) reads keep their address.
+    // This also rules out HALT and stores to (HL).
+    if( u8Opcode >= 0x40 && u8Opcode < 0x80 )
+    {
+        ubyte u8Dst = ( u8Opcode >> 3 ) & 0x07;
+        return u8Dst < 4 || 7 == u8Dst;
+    }
+
+    // ALU ops on A
+    if( u8Opcode >= 0x80 && u8Opcode < 0xC0 )
+    {
+        return true;
+    }
+
+    switch( u8Opcode )
+    {
+        case 0x00:                                                  // NOP
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x3E:      // LD r,n
+        case 0x07: case 0x0F: case 0x17: case 0x1F:                 // RLCA, RRCA, RLA, RRA
+        case 0x2F: case 0x37: case 0x3F:                            // CPL, SCF, CCF
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE:                 // ALU A,n
+        case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+            return true;
+
+        case 0xF0:                                                  // LDH A,(n)
+            return !IsTimerRegister( 0xFF00 | pOp->u8Operands[ 0 ] );
+
+        case 0xFA:                                                  // LD A,(nn)
+            return !IsTimerRegister( pOp->u8Operands[ 0 ] | ( pOp->u8Operands[ 1 ] << 8 ) );
+
+        case 0xCB:                                                  // BIT b,r
+            return pOp->u8ExtOpcode >= 0x40 && pOp->u8ExtOpcode < 0x80;
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpu::IsIdleLoopBlock( const GBCpuBlock* pBlock ) const
+{
+    uint16 u16PC = pBlock->u16StartPC;
+
+    // Everything before the branch may only read memory and write registers
+    for( ubyte i = 0; i + 1 < pBlock->u8OpCount; ++i )
+    {
+        const GBCpuDecodedOp* pOp = &pBlock->oOps[ i ];
+        if( !IsIdleLoopOp( pOp ) )
+        {
+            return false;
+        }
+
+        u16PC += pOp->u8Length;
+    }
+
+    // The block has to end with a branch back to its own start
+    const GBCpuDecodedOp* pBranch = &pBlock->oOps[ pBlock->u8OpCount - 1 ];
+    uint16 u16Target;
+
+    switch( pBranch->u8Opcode )
+    {
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:     // JR
+            u16Target = u16PC + 2 + static_cast<sbyte>( pBranch->u8Operands[ 0 ] );
+            break;
+
+        case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:     // JP
+            u16Target = pBranch->u8Operands[ 0 ] | ( pBranch->u8Operands[ 1 ] << 8 );
+            break;
+
+        default:
+            return false;
+    }
+
+    return u16Target == pBlock->u16StartPC;
+}
+
+#if CPU_HOTSPOTS
+//----------------------------------------------------------------------------------------------------
+int GBCpu::ExecuteHotSpotOpcode()
+{
+    if( !IsRunning() )
+    {
+        return ExecuteOpcodeCore<CPU_SWITCH_CORE != 0>();
+    }
+
+    // The op is charged for everything it cost, including an idle loop it let us skip
+    uint16  u16PC       = m_State.u16PC;
+    ubyte   u8Bank      = ( u16PC >= 0x4000 && u16PC < 0x8000 ) ? m_pMem->GetRomBank() : 0;
+    ubyte   u8Opcode    = m_pMem->ReadMemory( u16PC );
+    ubyte   u8ExtOpcode = ( 0xCB == u8Opcode ) ? m_pMem->ReadMemory( u16PC + 1 ) : 0;
+
+    int iCycles = ExecuteOpcodeCore<CPU_SWITCH_CORE != 0>();
+
+    m_pHotSpots->Record( u8Bank, u16PC, u8Opcode, u8ExtOpcode, iCycles );
+
+    return iCycles;
+}
+#endif
+
+#if CPU_TRACE
+//----------------------------------------------------------------------------------------------------
+void GBCpu::RecordTrace()
+{
+    MaterializeFlags();
+
+    GBCpuTraceEntry oEntry;
+    oEntry.u64Cycle     = m_pTimer->GetTotalCycles();
+    oEntry.u16PC        = m_State.u16PC;
+    oEntry.u16SP        = m_State.u16SP;
+    memcpy( oEntry.u8Registers, m_State.u8Registers, sizeof( oEntry.u8Registers ) );
+    oEntry.u8Bank       = m_pMem->GetRomBank();
+    oEntry.u8Opcode     = m_pMem->ReadMemory( m_State.u16PC );
+    oEntry.u8State      = ( m_State.bIME ? kCpuTraceIME : 0 ) | ( m_State.bHalt ? kCpuTraceHalt : 0 ) | ( m_State.bStop ? kCpuTraceStop : 0 );
+    oEntry.u8Reserved   = 0;
+
+    m_pTrace->Record( oEntry );
+}
+#endif
+
+//----------------------------------------------------------------------------------------------------
+int GBCpu::SkipIdleLoop()
+{
+    const GBCpuBlock* pBlock = m_pBlock;
+
+    if( kCpuBlockIdleUnknown == pBlock->u8IdleLoop )
+    {
+        m_pBlock->u8IdleLoop = IsIdleLoopBlock( pBlock ) ? kCpuBlockIdleLoop : kCpuBlockNotIdle;
+    }
+
+    if( kCpuBlockIdleLoop != pBlock->u8IdleLoop )
+    {
+        return 0;
+    }
+
+    // Cycles of one pass with the branch taken
+    const OpcodeInfo* pBranch = &OPCODE_INFO[ pBlock->oOps[ pBlock->u8OpCount - 1 ].u8Opcode ];
+    int iLoopCycles = pBlock->u32Cycles + pBranch->u8TakenCycles - pBranch->u8Cycles;
+
+    MaterializeFlags();
+
+    // The loop only settled if the last entry was exactly one pass ago in this run and the pass left
+    // the whole machine state as it was. Until the next event every read returns the same value again,
+    // so every further pass does the same.
+    bool bSettled =     m_pIdleBlock == pBlock
+                    &&  m_u32IdleRunCount == m_u32RunCount
+                    &&  m_iIdleCycleBudget - m_iCycleBudget == iLoopCycles
+                    &&  0 == memcmp( &m_oIdleState, &m_State, sizeof( m_State ) );
+
+    m_pIdleBlock            = pBlock;
+    m_u32IdleRunCount       = m_u32RunCount;
+    m_iIdleCycleBudget      = m_iCycleBudget;
+    memcpy( &m_oIdleState, &m_State, sizeof( m_State ) );
+
+    if(     !bSettled
+        ||  IsTimerRegister( GetRegisterPair( HL ) ) )
+    {
+        return 0;
+    }
+
+    // Skip the passes that end before the deadline and before TIMA overflows and raises an interrupt
+    int iLimit = m_pTimer->GetCyclesUntilOverflow();
+    if( iLimit > m_iCycleBudget )
+    {
+        iLimit = m_iCycleBudget;
+    }
+
+    if( iLimit <= iLoopCycles )
+    {
+        return 0;
+    }
+
+    int iSkip = ( ( iLimit - 1 ) / iLoopCycles ) * iLoopCycles;
+
+    m_pTimer->Update( iSkip );
+
+    m_iCycleBudget          -= iSkip;
+    m_iIdleCycleBudget       = m_iCycleBudget;
+    m_u32IdleSkippedCycles  += iSkip;
+
+    return iSkip;
+}
+
 //----------------------------------------------------------------------------------------------------
 template<unsigned OP>
 int GBCpu::OpInvalid()
@@ -922,7 +1676,7 @@ int GBCpu::OpLD_r_n()
 {
     PROFILE( "OpLD_r_n" );
 
-    m_Registers[ X ] = ReadMemory( m_PC++ );
+    m_State.u8Registers[ X ] = FetchOperand();
 
     return 8;
 }
@@ -933,7 +1687,7 @@ int GBCpu::OpLD_r_r()
 {
     PROFILE( "OpLD_r_r" );
 
-    m_Registers[ X ] = m_Registers[ Y ];
+    m_State.u8Registers[ X ] = m_State.u8Registers[ Y ];
 
     return 4;
 }
@@ -944,7 +1698,7 @@ int GBCpu::OpLD_r_rr()
 {
     PROFILE( "OpLD_r_rr" );
 
-    m_Registers[ X ] = ReadMemory( GetRegisterPair( XY ) );
+    m_State.u8Registers[ X ] = ReadMemory( GetRegisterPair( XY ) );
 
     return 8;
 }
@@ -955,7 +1709,7 @@ int GBCpu::OpLD_rr_r()
 {
     PROFILE( "OpLD_rr_r" );
 
-    WriteMemory( GetRegisterPair( XY ), m_Registers[ X ] );
+    WriteMemory( GetRegisterPair( XY ), m_State.u8Registers[ X ] );
 
     return 8;
 }
@@ -966,7 +1720,7 @@ int GBCpu::OpLD_rr_n()
 {
     PROFILE( "OpLD_rr_n" );
 
-    WriteMemory( GetRegisterPair( XY ), ReadMemory( m_PC++ ) );
+    WriteMemory( GetRegisterPair( XY ), FetchOperand() );
 
     return 12;
 }
@@ -977,10 +1731,10 @@ int GBCpu::OpLD_r_nn()
 {
     PROFILE( "OpLD_r_nn" );
 
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
     
-    m_Registers[ X ] = ReadMemory( ( hi << 8 ) | lo );
+    m_State.u8Registers[ X ] = ReadMemory( ( hi << 8 ) | lo );
 
     return 16;
 }
@@ -991,10 +1745,10 @@ int GBCpu::OpLD_nn_r()
 {
     PROFILE( "OpLD_nn_r" );
 
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
 
-    WriteMemory( ( hi << 8 ) | lo, m_Registers[ X ] );
+    WriteMemory( ( hi << 8 ) | lo, m_State.u8Registers[ X ] );
 
     return 16;
 }
@@ -1004,7 +1758,7 @@ int GBCpu::OpLDH_A_C()
 {
     PROFILE( "OpLDH_A_C" );
 
-    m_Registers[ A ] = ReadMemory( 0xFF00 + m_Registers[ C ] );
+    m_State.u8Registers[ A ] = ReadMemory( 0xFF00 + m_State.u8Registers[ C ] );
 
     return 8;
 }
@@ -1014,7 +1768,7 @@ int GBCpu::OpLDH_A_n()
 {
     PROFILE( "OpLDH_A_n" );
 
-    m_Registers[ A ] = ReadMemory( 0xFF00 + ReadMemory( m_PC++ ) );
+    m_State.u8Registers[ A ] = ReadMemory( 0xFF00 + FetchOperand() );
 
     return 12;
 }
@@ -1024,7 +1778,7 @@ int GBCpu::OpLDH_C_A()
 {
     PROFILE( "OpLDH_C_A" );
 
-    WriteMemory( 0xFF00 + m_Registers[ C ], m_Registers[ A ] );
+    WriteMemory( 0xFF00 + m_State.u8Registers[ C ], m_State.u8Registers[ A ] );
 
     return 8;
 }
@@ -1034,7 +1788,7 @@ int GBCpu::OpLDH_n_A()
 {
     PROFILE( "OpLDH_n_A" );
 
-    WriteMemory( 0xFF00 + ReadMemory( m_PC++ ), m_Registers[ A ] );
+    WriteMemory( 0xFF00 + FetchOperand(), m_State.u8Registers[ A ] );
 
     return 12;
 }
@@ -1046,7 +1800,7 @@ int GBCpu::OpLDD_A_HL()
 
     uint16 u16HL = GetRegisterPair( HL );
 
-    m_Registers[ A ] = ReadMemory( u16HL );
+    m_State.u8Registers[ A ] = ReadMemory( u16HL );
     SetRegisterPair( HL, --u16HL );
 
     return 8;
@@ -1059,7 +1813,7 @@ int GBCpu::OpLDD_HL_A()
 
     uint16 u16HL = GetRegisterPair( HL );
 
-    WriteMemory( u16HL, m_Registers[ A ] );
+    WriteMemory( u16HL, m_State.u8Registers[ A ] );
     SetRegisterPair( HL, --u16HL );
 
     return 8;
@@ -1072,7 +1826,7 @@ int GBCpu::OpLDI_A_HL()
 
     uint16 u16HL = GetRegisterPair( HL );
 
-    m_Registers[ A ] = ReadMemory( u16HL );
+    m_State.u8Registers[ A ] = ReadMemory( u16HL );
     SetRegisterPair( HL, ++u16HL );
 
     return 8;
@@ -1085,7 +1839,7 @@ int GBCpu::OpLDI_HL_A()
 
     uint16 u16HL = GetRegisterPair( HL );
 
-    WriteMemory( u16HL, m_Registers[ A ] );
+    WriteMemory( u16HL, m_State.u8Registers[ A ] );
     SetRegisterPair( HL, ++u16HL );
 
     return 8;
@@ -1097,7 +1851,7 @@ int GBCpu::OpLD_rr_nn()
 {
     PROFILE( "OpLD_rr_nn" );
 
-    uint16 nn = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 nn = FetchOperand() | ( FetchOperand() << 8 );
     SetRegisterPair( XY, nn );
 
     return 12;
@@ -1108,8 +1862,8 @@ int GBCpu::OpLD_SP_nn()
 {
     PROFILE( "OpLD_SP_nn" );
 
-    uint16 nn = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
-    m_SP = nn;
+    uint16 nn = FetchOperand() | ( FetchOperand() << 8 );
+    m_State.u16SP = nn;
 
     return 12;
 }
@@ -1119,7 +1873,7 @@ int GBCpu::OpLD_SP_HL()
 {
     PROFILE( "OpLD_SP_HL" );
 
-    m_SP = GetRegisterPair( HL );
+    m_State.u16SP = GetRegisterPair( HL );
 
     SimulateIO( 4 );
 
@@ -1131,14 +1885,14 @@ int GBCpu::OpLD_HL_SP_n()
 {
     PROFILE( "OpLD_HL_SP_n" );
 
-    sbyte n = ReadMemory( m_PC++ );
-    SetRegisterPair( HL, m_SP + n );
+    sbyte n = FetchOperand();
+    SetRegisterPair( HL, m_State.u16SP + n );
 
     // Adjust flags
     SetRegisterFlag( ZF, false );
     SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( m_SP & 0x0F ) + ( n & 0x0F ) ) > 0x0F );
-    SetRegisterFlag( CF, ( ( m_SP & 0xFF ) + ( n & 0xFF ) ) > 0xFF );
+    SetRegisterFlag( HF, ( ( m_State.u16SP & 0x0F ) + ( n & 0x0F ) ) > 0x0F );
+    SetRegisterFlag( CF, ( ( m_State.u16SP & 0xFF ) + ( n & 0xFF ) ) > 0xFF );
 
     SimulateIO( 4 );
 
@@ -1150,10 +1904,10 @@ int GBCpu::OpLD_nn_SP()
 {
     PROFILE( "OpLD_nn_SP" );
 
-    uint16 addr    = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr    = FetchOperand() | ( FetchOperand() << 8 );
 
-    WriteMemory( addr, m_SP & 0xFF );
-    WriteMemory( addr + 1, m_SP >> 8 );
+    WriteMemory( addr, m_State.u16SP & 0xFF );
+    WriteMemory( addr + 1, m_State.u16SP >> 8 );
 
     return 20;
 }
@@ -1166,8 +1920,8 @@ int GBCpu::OpPUSH_rr_nn()
 
     uint16 u16XY = GetRegisterPair( XY );
 
-    WriteMemory( --m_SP, u16XY >> 8 );
-    WriteMemory( --m_SP, u16XY & 0xFF );
+    WriteMemory( --m_State.u16SP, u16XY >> 8 );
+    WriteMemory( --m_State.u16SP, u16XY & 0xFF );
 
     SimulateIO( 4 );
 
@@ -1180,8 +1934,8 @@ int GBCpu::OpPOP_rr_nn()
 {
     PROFILE( "OpPOP_rr_nn" );
 
-    ubyte lo = ReadMemory( m_SP++ );
-    ubyte hi = ReadMemory( m_SP++ );
+    ubyte lo = ReadMemory( m_State.u16SP++ );
+    ubyte hi = ReadMemory( m_State.u16SP++ );
 
     SetRegisterPair( XY, ( hi << 8 ) | lo );
 
@@ -1194,15 +1948,12 @@ void GBCpu::OpADD_r_v( ubyte value )
 {
     PROFILE( "OpADD_r_v" );
 
-    ubyte total = m_Registers[ X ] + value;
+    uint16 total = m_State.u8Registers[ X ] + value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !total );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( m_Registers[ X ] & 0x0F ) + ( value & 0x0F ) ) > 0x0F );
-    SetRegisterFlag( CF, ( ( m_Registers[ X ] & 0xFF ) + ( value & 0xFF ) ) > 0xFF );
+    SetLazyFlags( kFlagOpAdd, total, m_State.u8Registers[ X ] ^ value );
 
-    m_Registers[ X ] = total;
+    m_State.u8Registers[ X ] = static_cast<ubyte>( total );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1211,7 +1962,7 @@ int GBCpu::OpADD_r_r()
 {
     PROFILE( "OpADD_r_r" );
 
-    OpADD_r_v<X>( m_Registers[ Y ] );
+    OpADD_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1233,7 +1984,7 @@ int GBCpu::OpADD_r_n()
 {
     PROFILE( "OpADD_r_n" );
 
-    OpADD_r_v<X>( ReadMemory( m_PC++ ) );
+    OpADD_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1245,15 +1996,12 @@ void GBCpu::OpADC_r_v( ubyte value )
     PROFILE( "OpADC_r_v" );
 
     ubyte carry    = GetRegisterFlag( CF );
-    ubyte total = m_Registers[ X ] + value + carry;
+    uint16 total = m_State.u8Registers[ X ] + value + carry;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !total );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( m_Registers[ X ] & 0x0F ) + ( value & 0x0F ) + carry ) > 0x0F );
-    SetRegisterFlag( CF, ( ( m_Registers[ X ] & 0xFF ) + ( value & 0xFF ) + carry ) > 0xFF );
+    SetLazyFlags( kFlagOpAdd, total, m_State.u8Registers[ X ] ^ value );
 
-    m_Registers[ X ] = total;
+    m_State.u8Registers[ X ] = static_cast<ubyte>( total );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1262,7 +2010,7 @@ int GBCpu::OpADC_r_r()
 {
     PROFILE( "OpADC_r_r" );
 
-    OpADC_r_v<X>( m_Registers[ Y ] );
+    OpADC_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1284,7 +2032,7 @@ int GBCpu::OpADC_r_n()
 {
     PROFILE( "OpADC_r_n" );
 
-    OpADC_r_v<X>( ReadMemory( m_PC++ ) );
+    OpADC_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1295,16 +2043,12 @@ void GBCpu::OpSUB_r_v( ubyte value )
 {
     PROFILE( "OpSUB_r_v" );
 
-    uint16 total = m_Registers[ X ] - value;
-    uint16 lower = ( m_Registers[ X ] & 0x0F ) - ( value & 0x0F );
+    uint16 total = m_State.u8Registers[ X ] - value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !total );
-    SetRegisterFlag( NF, true );
-    SetRegisterFlag( HF, lower > 0x0F );
-    SetRegisterFlag( CF, total > 0xFF );
+    SetLazyFlags( kFlagOpSub, total, m_State.u8Registers[ X ] ^ value );
 
-    m_Registers[ X ] = static_cast<ubyte>( total );
+    m_State.u8Registers[ X ] = static_cast<ubyte>( total );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1313,7 +2057,7 @@ int GBCpu::OpSUB_r_r()
 {
     PROFILE( "OpSUB_r_r" );
 
-    OpSUB_r_v<X>( m_Registers[ Y ] );
+    OpSUB_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1335,7 +2079,7 @@ int GBCpu::OpSUB_r_n()
 {
     PROFILE( "OpSUB_r_n" );
 
-    OpSUB_r_v<X>( ReadMemory( m_PC++ ) );
+    OpSUB_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1347,16 +2091,12 @@ void GBCpu::OpSBC_r_v( ubyte value )
     PROFILE( "OpSBC_r_v" );
 
     ubyte carry        = GetRegisterFlag( CF );
-    uint16 total    = m_Registers[ X ] - value - carry;
-    uint16 lower    = ( m_Registers[ X ] & 0x0F ) - ( value & 0x0F ) - carry;
+    uint16 total    = m_State.u8Registers[ X ] - value - carry;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !static_cast<ubyte>( total ) );
-    SetRegisterFlag( NF, true );
-    SetRegisterFlag( HF, lower > 0x0F );
-    SetRegisterFlag( CF, total > 0xFF );
+    SetLazyFlags( kFlagOpSub, total, m_State.u8Registers[ X ] ^ value );
 
-    m_Registers[ X ] = static_cast<ubyte>( total );
+    m_State.u8Registers[ X ] = static_cast<ubyte>( total );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1365,7 +2105,7 @@ int GBCpu::OpSBC_r_r()
 {
     PROFILE( "OpSBC_r_r" );
 
-    OpSBC_r_v<X>( m_Registers[ Y ] );
+    OpSBC_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1387,7 +2127,7 @@ int GBCpu::OpSBC_r_n()
 {
     PROFILE( "OpSBC_r_n" );
 
-    OpSBC_r_v<X>( ReadMemory( m_PC++ ) );
+    OpSBC_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1398,15 +2138,12 @@ void GBCpu::OpAND_r_v( ubyte value )
 {
     PROFILE( "OpAND_r_v" );
 
-    ubyte mask = m_Registers[ X ] & value;
+    ubyte mask = m_State.u8Registers[ X ] & value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !mask );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, true );
-    SetRegisterFlag( CF, false );
+    SetLazyFlags( kFlagOpAnd, mask, 0 );
 
-    m_Registers[ X ] = mask;
+    m_State.u8Registers[ X ] = mask;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1415,7 +2152,7 @@ int GBCpu::OpAND_r_r()
 {
     PROFILE( "OpAND_r_r" );
 
-    OpAND_r_v<X>( m_Registers[ Y ] );
+    OpAND_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1437,7 +2174,7 @@ int GBCpu::OpAND_r_n()
 {
     PROFILE( "OpAND_r_n" );
 
-    OpAND_r_v<X>( ReadMemory( m_PC++ ) );
+    OpAND_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1448,15 +2185,12 @@ void GBCpu::OpOR_r_v( ubyte value )
 {
     PROFILE( "OpOR_r_v" );
 
-    ubyte mask = m_Registers[ X ] | value;
+    ubyte mask = m_State.u8Registers[ X ] | value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !mask );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, false );
+    SetLazyFlags( kFlagOpLogic, mask, 0 );
 
-    m_Registers[ X ] = mask;
+    m_State.u8Registers[ X ] = mask;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1465,7 +2199,7 @@ int GBCpu::OpOR_r_r()
 {
     PROFILE( "OpOR_r_r" );
 
-    OpOR_r_v<X>( m_Registers[ Y ] );
+    OpOR_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1487,7 +2221,7 @@ int GBCpu::OpOR_r_n()
 {
     PROFILE( "OpOR_r_n" );
 
-    OpOR_r_v<X>( ReadMemory( m_PC++ ) );
+    OpOR_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1498,15 +2232,12 @@ void GBCpu::OpXOR_r_v( ubyte value )
 {
     PROFILE( "OpXOR_r_v" );
 
-    ubyte mask = m_Registers[ X ] ^ value;
+    ubyte mask = m_State.u8Registers[ X ] ^ value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !mask );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, false );
+    SetLazyFlags( kFlagOpLogic, mask, 0 );
 
-    m_Registers[ X ] = mask;
+    m_State.u8Registers[ X ] = mask;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1515,7 +2246,7 @@ int GBCpu::OpXOR_r_r()
 {
     PROFILE( "OpXOR_r_r" );
 
-    OpXOR_r_v<X>( m_Registers[ Y ] );
+    OpXOR_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1537,7 +2268,7 @@ int GBCpu::OpXOR_r_n()
 {
     PROFILE( "OpXOR_r_n" );
 
-    OpXOR_r_v<X>( ReadMemory( m_PC++ ) );
+    OpXOR_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1546,14 +2277,10 @@ int GBCpu::OpXOR_r_n()
 template<unsigned X>
 void GBCpu::OpCMP_r_v( ubyte value )
 {
-    uint16 total = m_Registers[ X ] - value;
-    uint16 lower = ( m_Registers[ X ] & 0x0F ) - ( value & 0x0F );
+    uint16 total = m_State.u8Registers[ X ] - value;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !total );
-    SetRegisterFlag( NF, true );
-    SetRegisterFlag( HF, lower > 0x0F );
-    SetRegisterFlag( CF, total > 0xFF );
+    SetLazyFlags( kFlagOpSub, total, m_State.u8Registers[ X ] ^ value );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -1562,7 +2289,7 @@ int GBCpu::OpCMP_r_r()
 {
     PROFILE( "OpCMP_r_r" );
 
-    OpCMP_r_v<X>( m_Registers[ Y ] );
+    OpCMP_r_v<X>( m_State.u8Registers[ Y ] );
 
     return 4;
 }
@@ -1584,7 +2311,7 @@ int GBCpu::OpCMP_r_n()
 {
     PROFILE( "OpCMP_r_n" );
 
-    OpCMP_r_v<X>( ReadMemory( m_PC++ ) );
+    OpCMP_r_v<X>( FetchOperand() );
 
     return 8;
 }
@@ -1595,14 +2322,12 @@ int GBCpu::OpINC_r()
 {
     PROFILE( "OpINC_r" );
 
-    ubyte value = m_Registers[ X ] + 1;
+    ubyte value = m_State.u8Registers[ X ] + 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !value );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( m_Registers[ X ] & 0x0F ) + 1 ) > 0x0F );
+    SetLazyFlagsKeepCarry( kFlagOpInc, value );
     
-    m_Registers[ X ] = value;
+    m_State.u8Registers[ X ] = value;
 
     return 4;
 }
@@ -1617,9 +2342,7 @@ int GBCpu::OpINC_HL()
     ubyte newValue  = value + 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !newValue );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( value & 0x0F ) + 1 ) > 0x0F );
+    SetLazyFlagsKeepCarry( kFlagOpInc, newValue );
 
     WriteMemory( addr, newValue );
 
@@ -1632,14 +2355,12 @@ int GBCpu::OpDEC_r()
 {
     PROFILE( "OpDEC_r" );
 
-    ubyte value = m_Registers[ X ] - 1;
+    ubyte value = m_State.u8Registers[ X ] - 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !value );
-    SetRegisterFlag( NF, true );
-    SetRegisterFlag( HF, ( value & 0x0F ) == 0x0F );
+    SetLazyFlagsKeepCarry( kFlagOpDec, value );
     
-    m_Registers[ X ] = value;
+    m_State.u8Registers[ X ] = value;
 
     return 4;
 }
@@ -1654,9 +2375,7 @@ int GBCpu::OpDEC_HL()
     ubyte newValue  = value - 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !newValue );
-    SetRegisterFlag( NF, true );
-    SetRegisterFlag( HF, ( newValue & 0x0F ) == 0x0F );
+    SetLazyFlagsKeepCarry( kFlagOpDec, newValue );
 
     WriteMemory( addr, newValue );
 
@@ -1671,7 +2390,7 @@ int GBCpu::OpDAA()
     bool n      = GetRegisterFlag( NF );
     bool h      = GetRegisterFlag( HF );
     bool c      = GetRegisterFlag( CF );
-    uint16 a    = m_Registers[ A ];
+    uint16 a    = m_State.u8Registers[ A ];
 
     // Handle addition
     if( !n )
@@ -1701,9 +2420,9 @@ int GBCpu::OpDAA()
         }
     }
 
-    m_Registers[ A ] = static_cast<ubyte>( a );
+    m_State.u8Registers[ A ] = static_cast<ubyte>( a );
 
-    SetRegisterFlag( ZF, !m_Registers[ A ] );
+    SetRegisterFlag( ZF, !m_State.u8Registers[ A ] );
     SetRegisterFlag( HF, false );
     SetRegisterFlag( CF, c | ( 0 != ( a & 0x100 ) ) );
 
@@ -1715,7 +2434,7 @@ int GBCpu::OpCPL()
 {
     PROFILE( "OpCPL" );
 
-    m_Registers[ A ] ^= 0xFF;
+    m_State.u8Registers[ A ] ^= 0xFF;
 
     // Adjust flags
     SetRegisterFlag( NF, true );
@@ -1754,10 +2473,10 @@ int GBCpu::OpADD_HL_SP()
 
     // Adjust flags
     SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( u16HL & 0x0FFF ) + ( m_SP & 0x0FFF ) ) > 0x0FFF );
-    SetRegisterFlag( CF, ( ( u16HL & 0xFFFF ) + ( m_SP & 0xFFFF ) ) > 0xFFFF );
+    SetRegisterFlag( HF, ( ( u16HL & 0x0FFF ) + ( m_State.u16SP & 0x0FFF ) ) > 0x0FFF );
+    SetRegisterFlag( CF, ( ( u16HL & 0xFFFF ) + ( m_State.u16SP & 0xFFFF ) ) > 0xFFFF );
 
-    SetRegisterPair( HL, u16HL + m_SP );
+    SetRegisterPair( HL, u16HL + m_State.u16SP );
 
     SimulateIO( 4 );
 
@@ -1769,15 +2488,15 @@ int GBCpu::OpADD_SP_n()
 {
     PROFILE( "OpADD_SP_n" );
 
-    sbyte n = static_cast<sbyte>( ReadMemory( m_PC++ ) );
+    sbyte n = static_cast<sbyte>( FetchOperand() );
 
     // Adjust flags
     SetRegisterFlag( ZF, false );
     SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, ( ( m_SP & 0x0F ) + ( n & 0x0F ) ) > 0x0F );
-    SetRegisterFlag( CF, ( ( m_SP & 0xFF ) + ( n & 0xFF ) ) > 0xFF );
+    SetRegisterFlag( HF, ( ( m_State.u16SP & 0x0F ) + ( n & 0x0F ) ) > 0x0F );
+    SetRegisterFlag( CF, ( ( m_State.u16SP & 0xFF ) + ( n & 0xFF ) ) > 0xFF );
 
-    m_SP += n;
+    m_State.u16SP += n;
 
     SimulateIO( 8 );
 
@@ -1803,7 +2522,7 @@ int GBCpu::OpINC_SP()
 {
     PROFILE( "OpINC_SP" );
 
-    ++m_SP;
+    ++m_State.u16SP;
 
     SimulateIO( 4 );
 
@@ -1829,7 +2548,7 @@ int GBCpu::OpDEC_SP()
 {
     PROFILE( "OpDEC_SP" );
 
-    --m_SP;
+    --m_State.u16SP;
 
     SimulateIO( 4 );
 
@@ -1842,12 +2561,9 @@ int GBCpu::OpSWAP_r()
 {
     PROFILE( "OpSWAP_r" );
 
-    m_Registers[ X ] = ( m_Registers[ X ] << 4 ) | ( m_Registers[ X ] >> 4 );
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] << 4 ) | ( m_State.u8Registers[ X ] >> 4 );
 
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, false );
+    SetLazyFlags( kFlagOpLogic, m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -1863,10 +2579,7 @@ int GBCpu::OpSWAP_HL()
     value = ( value << 4 ) | ( value >> 4 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !value );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, false );
+    SetLazyFlags( kFlagOpLogic, value, 0 );
 
     WriteMemory( addr, value );
 
@@ -1934,7 +2647,7 @@ int GBCpu::OpHALT()
     instruction then the game could hang or registers could get scrambled.
     */
 
-    m_bHalt = true;
+    m_State.bHalt = true;
 
     return 4;
 }
@@ -1944,7 +2657,7 @@ int GBCpu::OpSTOP()
 {
     PROFILE( "OpSTOP" );
 
-    m_bStop = true;
+    m_State.bStop = true;
 
     DebugDumpHistory();
     __asm int 3;
@@ -1957,7 +2670,9 @@ int GBCpu::OpDI()
 {
     PROFILE( "OpDI" );
 
-    m_bIME = false;
+    m_State.bIME        = false;
+    m_State.u8EIDelay   = 0;
+    UpdateInterruptPending();
 
     return 4;
 }
@@ -1967,7 +2682,14 @@ int GBCpu::OpEI()
 {
     PROFILE( "OpEI" );
 
-    m_bIME = true;
+    // IME is only set once the next instruction is done, HandleInterrupts counts down the instruction
+    // ends.
+    if(     !m_State.bIME
+        &&  0 == m_State.u8EIDelay )
+    {
+        m_State.u8EIDelay = 2;
+        UpdateInterruptPending();
+    }
 
     return 4;
 }
@@ -1977,15 +2699,12 @@ int GBCpu::OpRLCA()
 {
     PROFILE( "OpRLCA" );
 
-    bool c = 0 != ( m_Registers[ A ] & 0x80 );
+    bool c = 0 != ( m_State.u8Registers[ A ] & 0x80 );
 
-    m_Registers[ A ] = ( m_Registers[ A ] << 1 ) | ( m_Registers[ A ] >> 7 );
+    m_State.u8Registers[ A ] = ( m_State.u8Registers[ A ] << 1 ) | ( m_State.u8Registers[ A ] >> 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, false );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpRotateA, c ? 0x100 : 0, 0 );
 
     return 4;
 }
@@ -1995,15 +2714,12 @@ int GBCpu::OpRLA()
 {
     PROFILE( "OpRLA" );
 
-    bool c = 0 != ( m_Registers[ A ] & 0x80 );
+    bool c = 0 != ( m_State.u8Registers[ A ] & 0x80 );
 
-    m_Registers[ A ] = ( m_Registers[ A ] << 1 ) | static_cast<ubyte>( GetRegisterFlag( CF ) );
+    m_State.u8Registers[ A ] = ( m_State.u8Registers[ A ] << 1 ) | static_cast<ubyte>( GetRegisterFlag( CF ) );
 
     // Adjust flags
-    SetRegisterFlag( ZF, false );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpRotateA, c ? 0x100 : 0, 0 );
 
     return 4;
 }
@@ -2013,15 +2729,12 @@ int GBCpu::OpRRCA()
 {
     PROFILE( "OpRRCA" );
 
-    bool c = 0 != ( m_Registers[ A ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ A ] & 0x01 );
 
-    m_Registers[ A ] = ( m_Registers[ A ] >> 1 ) | ( m_Registers[ A ] << 7 );
+    m_State.u8Registers[ A ] = ( m_State.u8Registers[ A ] >> 1 ) | ( m_State.u8Registers[ A ] << 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, false );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpRotateA, c ? 0x100 : 0, 0 );
 
     return 4;
 }
@@ -2031,15 +2744,12 @@ int GBCpu::OpRRA()
 {
     PROFILE( "OpRRA" );
 
-    bool c = 0 != ( m_Registers[ A ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ A ] & 0x01 );
 
-    m_Registers[ A ] = ( m_Registers[ A ] >> 1 ) | (  static_cast<ubyte>( GetRegisterFlag( CF ) ) << 7 );
+    m_State.u8Registers[ A ] = ( m_State.u8Registers[ A ] >> 1 ) | (  static_cast<ubyte>( GetRegisterFlag( CF ) ) << 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, false );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpRotateA, c ? 0x100 : 0, 0 );
 
     return 4;
 }
@@ -2050,15 +2760,12 @@ int GBCpu::OpRLC_r()
 {
     PROFILE( "OpRLC_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x80 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x80 );
 
-    m_Registers[ X ] = ( m_Registers[ X ] << 1 ) | ( m_Registers[ X ] >> 7 );
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] << 1 ) | ( m_State.u8Registers[ X ] >> 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2077,10 +2784,7 @@ int GBCpu::OpRLC_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2091,15 +2795,12 @@ int GBCpu::OpRL_r()
 {
     PROFILE( "OpRL_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x80 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x80 );
 
-    m_Registers[ X ] = ( m_Registers[ X ] << 1 ) | static_cast<ubyte>( GetRegisterFlag( CF ) );
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] << 1 ) | static_cast<ubyte>( GetRegisterFlag( CF ) );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2118,10 +2819,7 @@ int GBCpu::OpRL_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2132,15 +2830,12 @@ int GBCpu::OpRRC_r()
 {
     PROFILE( "OpRRC_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x01 );
 
-    m_Registers[ X ] = ( m_Registers[ X ] >> 1 ) | ( m_Registers[ X ] << 7 );
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] >> 1 ) | ( m_State.u8Registers[ X ] << 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2159,10 +2854,7 @@ int GBCpu::OpRRC_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2173,15 +2865,12 @@ int GBCpu::OpRR_r()
 {
     PROFILE( "OpRR_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x01 );
 
-    m_Registers[ X ] = ( m_Registers[ X ] >> 1 ) | (  static_cast<ubyte>( GetRegisterFlag( CF ) ) << 7 );
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] >> 1 ) | (  static_cast<ubyte>( GetRegisterFlag( CF ) ) << 7 );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2200,10 +2889,7 @@ int GBCpu::OpRR_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2214,15 +2900,12 @@ int GBCpu::OpSLA_r()
 {
     PROFILE( "OpSLA_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x80 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x80 );
 
-    m_Registers[ X ] = m_Registers[ X ] << 1;
+    m_State.u8Registers[ X ] = m_State.u8Registers[ X ] << 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2241,10 +2924,7 @@ int GBCpu::OpSLA_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2255,15 +2935,12 @@ int GBCpu::OpSRA_r()
 {
     PROFILE( "OpSRA_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x01 );
 
-    m_Registers[ X ] = ( m_Registers[ X ] & 0x80 ) | m_Registers[ X ] >> 1;
+    m_State.u8Registers[ X ] = ( m_State.u8Registers[ X ] & 0x80 ) | m_State.u8Registers[ X ] >> 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2282,10 +2959,7 @@ int GBCpu::OpSRA_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2296,15 +2970,12 @@ int GBCpu::OpSRL_r()
 {
     PROFILE( "OpSRL_r" );
 
-    bool c = 0 != ( m_Registers[ X ] & 0x01 );
+    bool c = 0 != ( m_State.u8Registers[ X ] & 0x01 );
 
-    m_Registers[ X ] = m_Registers[ X ] >> 1;
+    m_State.u8Registers[ X ] = m_State.u8Registers[ X ] >> 1;
 
     // Adjust flags
-    SetRegisterFlag( ZF, !m_Registers[ X ] );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | m_State.u8Registers[ X ], 0 );
 
     return 8;
 }
@@ -2323,10 +2994,7 @@ int GBCpu::OpSRL_HL()
     WriteMemory( addr, n );
 
     // Adjust flags
-    SetRegisterFlag( ZF, !n );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, false );
-    SetRegisterFlag( CF, c );
+    SetLazyFlags( kFlagOpLogic, ( c ? 0x100 : 0 ) | n, 0 );
 
     return 16;
 }
@@ -2337,11 +3005,9 @@ int GBCpu::OpBIT_r()
 {
     PROFILE( "OpBIT_r" );
 
-    ubyte test = m_Registers[ X ] & ( 1 << b );
+    ubyte test = m_State.u8Registers[ X ] & ( 1 << b );
 
-    SetRegisterFlag( ZF, !test );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, true );
+    SetLazyFlagsKeepCarry( kFlagOpBit, test );
 
     return 8;
 }
@@ -2356,9 +3022,7 @@ int GBCpu::OpBIT_HL()
     ubyte n         = ReadMemory( addr );
     ubyte test      = n & ( 1 << b );
 
-    SetRegisterFlag( ZF, !test );
-    SetRegisterFlag( NF, false );
-    SetRegisterFlag( HF, true );
+    SetLazyFlagsKeepCarry( kFlagOpBit, test );
 
     return 12;
 }
@@ -2369,7 +3033,7 @@ int GBCpu::OpSET_r()
 {
     PROFILE( "OpSET_r" );
 
-    m_Registers[ X ] |= ( 1 << b );
+    m_State.u8Registers[ X ] |= ( 1 << b );
 
     return 8;
 }
@@ -2394,7 +3058,7 @@ int GBCpu::OpRES_r()
 {
     PROFILE( "OpRES_r" );
 
-    m_Registers[ X ] &= ~( 1 << b );
+    m_State.u8Registers[ X ] &= ~( 1 << b );
 
     return 8;
 }
@@ -2418,7 +3082,7 @@ int GBCpu::OpJP_nn()
 {
     PROFILE( "OpJP_nn" );
 
-    m_PC = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    m_State.u16PC = FetchOperand() | ( FetchOperand() << 8 );
 
     SimulateIO( 4 );
 
@@ -2432,12 +3096,12 @@ int GBCpu::OpJP_NZ_nn()
 
     int iCycles = 12;
     
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
 
     if( !GetRegisterFlag( ZF ) )
     {
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2453,12 +3117,12 @@ int GBCpu::OpJP_Z_nn()
 
     int    iCycles = 12;
 
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
 
     if( GetRegisterFlag( ZF ) )
     {
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2474,12 +3138,12 @@ int GBCpu::OpJP_NC_nn()
 
     int iCycles = 12;
 
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
 
     if( !GetRegisterFlag( CF ) )
     {
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2495,12 +3159,12 @@ int GBCpu::OpJP_C_nn()
 
     int iCycles = 12;
 
-    ubyte lo = ReadMemory( m_PC++ );
-    ubyte hi = ReadMemory( m_PC++ );
+    ubyte lo = FetchOperand();
+    ubyte hi = FetchOperand();
 
     if( GetRegisterFlag( CF ) )
     {
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2514,7 +3178,7 @@ int GBCpu::OpJP_HL()
 {
     PROFILE( "OpJP_HL" );
 
-    m_PC = GetRegisterPair( HL );
+    m_State.u16PC = GetRegisterPair( HL );
 
     return 4;
 }
@@ -2524,7 +3188,7 @@ int GBCpu::OpJR_n()
 {
     PROFILE( "OpJR_n" );
 
-    m_PC += static_cast<sbyte>( ReadMemory( m_PC++ ) );
+    m_State.u16PC += static_cast<sbyte>( FetchOperand() );
 
     SimulateIO( 4 );
 
@@ -2537,11 +3201,11 @@ int GBCpu::OpJR_NZ_n()
     PROFILE( "OpJR_NZ_n" );
 
     int iCycles     = 8;
-    sbyte n         = ReadMemory( m_PC++ );
+    sbyte n         = FetchOperand();
 
     if( !GetRegisterFlag( ZF ) )
     {
-        m_PC += n;
+        m_State.u16PC += n;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2556,11 +3220,11 @@ int GBCpu::OpJR_Z_n()
     PROFILE( "OpJR_Z_n" );
 
     int iCycles     = 8;
-    sbyte n         = ReadMemory( m_PC++ );
+    sbyte n         = FetchOperand();
 
     if( GetRegisterFlag( ZF ) )
     {
-        m_PC += n;
+        m_State.u16PC += n;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2575,11 +3239,11 @@ int GBCpu::OpJR_NC_n()
     PROFILE( "OpJR_NC_n" );
 
     int iCycles     = 8;
-    sbyte n         = ReadMemory( m_PC++ );
+    sbyte n         = FetchOperand();
 
     if( !GetRegisterFlag( CF ) )
     {
-        m_PC += n;
+        m_State.u16PC += n;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2594,11 +3258,11 @@ int GBCpu::OpJR_C_n()
     PROFILE( "OpJR_C_n" );
 
     int iCycles     = 8;
-    sbyte n         = ReadMemory( m_PC++ );
+    sbyte n         = FetchOperand();
 
     if( GetRegisterFlag( CF ) )
     {
-        m_PC += n;
+        m_State.u16PC += n;
         iCycles += 4;
 
         SimulateIO( 4 );
@@ -2612,12 +3276,12 @@ int GBCpu::OpCALL_nn()
 {
     PROFILE( "OpCALL_nn" );
 
-    uint16 addr = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr = FetchOperand() | ( FetchOperand() << 8 );
 
-    WriteMemory( --m_SP, m_PC >> 8 );
-    WriteMemory( --m_SP, m_PC & 0xFF );
+    WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+    WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-    m_PC = addr;
+    m_State.u16PC = addr;
 
     SimulateIO( 4 );
 
@@ -2630,14 +3294,14 @@ int GBCpu::OpCALL_NZ_nn()
     PROFILE( "OpCALL_NZ_nn" );
 
     int iCycles    = 12;
-    uint16 addr    = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr    = FetchOperand() | ( FetchOperand() << 8 );
 
     if( !GetRegisterFlag( ZF ) )
     {
-        WriteMemory( --m_SP, m_PC >> 8 );
-        WriteMemory( --m_SP, m_PC & 0xFF );
+        WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+        WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-        m_PC = addr;
+        m_State.u16PC = addr;
 
         iCycles += 12;
 
@@ -2653,14 +3317,14 @@ int GBCpu::OpCALL_Z_nn()
     PROFILE( "OpCALL_Z_nn" );
 
     int iCycles    = 12;
-    uint16 addr    = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr    = FetchOperand() | ( FetchOperand() << 8 );
 
     if( GetRegisterFlag( ZF ) )
     {
-        WriteMemory( --m_SP, m_PC >> 8 );
-        WriteMemory( --m_SP, m_PC & 0xFF );
+        WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+        WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-        m_PC = addr;
+        m_State.u16PC = addr;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2675,14 +3339,14 @@ int GBCpu::OpCALL_NC_nn()
     PROFILE( "OpCALL_NC_nn" );
 
     int iCycles    = 12;
-    uint16 addr    = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr    = FetchOperand() | ( FetchOperand() << 8 );
 
     if( !GetRegisterFlag( CF ) )
     {
-        WriteMemory( --m_SP, m_PC >> 8 );
-        WriteMemory( --m_SP, m_PC & 0xFF );
+        WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+        WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-        m_PC = addr;
+        m_State.u16PC = addr;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2697,14 +3361,14 @@ int GBCpu::OpCALL_C_nn()
     PROFILE( "OpCALL_C_nn" );
 
     int iCycles    = 12;
-    uint16 addr    = ReadMemory( m_PC++ ) | ( ReadMemory( m_PC++ ) << 8 );
+    uint16 addr    = FetchOperand() | ( FetchOperand() << 8 );
 
     if( GetRegisterFlag( CF ) )
     {
-        WriteMemory( --m_SP, m_PC >> 8 );
-        WriteMemory( --m_SP, m_PC & 0xFF );
+        WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+        WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-        m_PC = addr;
+        m_State.u16PC = addr;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2719,10 +3383,10 @@ int GBCpu::OpRST_nn()
 {
     PROFILE( "OpRST_nn" );
 
-    WriteMemory( --m_SP, m_PC >> 8 );
-    WriteMemory( --m_SP, m_PC & 0xFF );
+    WriteMemory( --m_State.u16SP, m_State.u16PC >> 8 );
+    WriteMemory( --m_State.u16SP, m_State.u16PC & 0xFF );
 
-    m_PC = ADDR;
+    m_State.u16PC = ADDR;
 
     SimulateIO( 4 );
 
@@ -2734,10 +3398,10 @@ int GBCpu::OpRET_nn()
 {
     PROFILE( "OpRET_nn" );
 
-    ubyte lo = ReadMemory( m_SP++ );
-    ubyte hi = ReadMemory( m_SP++ );
+    ubyte lo = ReadMemory( m_State.u16SP++ );
+    ubyte hi = ReadMemory( m_State.u16SP++ );
 
-    m_PC = ( hi << 8 ) | lo;
+    m_State.u16PC = ( hi << 8 ) | lo;
 
     SimulateIO( 4 );
 
@@ -2753,10 +3417,10 @@ int GBCpu::OpRET_NZ_nn()
 
     if( !GetRegisterFlag( ZF ) )
     {
-        ubyte    lo    = ReadMemory( m_SP++ );
-        ubyte    hi    = ReadMemory( m_SP++ );
+        ubyte    lo    = ReadMemory( m_State.u16SP++ );
+        ubyte    hi    = ReadMemory( m_State.u16SP++ );
 
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2776,10 +3440,10 @@ int GBCpu::OpRET_Z_nn()
 
     if( GetRegisterFlag( ZF ) )
     {
-        ubyte    lo    = ReadMemory( m_SP++ );
-        ubyte    hi    = ReadMemory( m_SP++ );
+        ubyte    lo    = ReadMemory( m_State.u16SP++ );
+        ubyte    hi    = ReadMemory( m_State.u16SP++ );
 
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2799,10 +3463,10 @@ int GBCpu::OpRET_NC_nn()
 
     if( !GetRegisterFlag( CF ) )
     {
-        ubyte    lo    = ReadMemory( m_SP++ );
-        ubyte    hi    = ReadMemory( m_SP++ );
+        ubyte    lo    = ReadMemory( m_State.u16SP++ );
+        ubyte    hi    = ReadMemory( m_State.u16SP++ );
 
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2822,10 +3486,10 @@ int GBCpu::OpRET_C_nn()
 
     if( GetRegisterFlag( CF ) )
     {
-        ubyte    lo    = ReadMemory( m_SP++ );
-        ubyte    hi    = ReadMemory( m_SP++ );
+        ubyte    lo    = ReadMemory( m_State.u16SP++ );
+        ubyte    hi    = ReadMemory( m_State.u16SP++ );
 
-        m_PC = ( hi << 8 ) | lo;
+        m_State.u16PC = ( hi << 8 ) | lo;
         iCycles += 12;
 
         SimulateIO( 4 );
@@ -2841,13 +3505,13 @@ int GBCpu::OpRETI_nn()
 {
     PROFILE( "OpRETI_nn" );
 
-    ubyte lo = ReadMemory( m_SP++ );
-    ubyte hi = ReadMemory( m_SP++ );
+    ubyte lo = ReadMemory( m_State.u16SP++ );
+    ubyte hi = ReadMemory( m_State.u16SP++ );
 
-    m_PC = ( hi << 8 ) | lo;
+    m_State.u16PC = ( hi << 8 ) | lo;
 
     // Enable interrupts
-    m_bIME = true;
+    m_State.bIME = true;
     
     SimulateIO( 4 );
 
@@ -2858,4 +3522,539 @@ int GBCpu::OpRETI_nn()
 int GBCpu::OpExecuteExtOp()
 {
     return ExecuteExtOpcode();
+}
+
+//----------------------------------------------------------------------------------------------------
+int GBCpu::DispatchOpcode( ubyte opcode )
+{
+    // Dense switch over the same opcode templates as the handler tables. The compiler turns this into a
+    // jump table and can inline the handlers, which it can't do through the member function pointers.
+    switch( opcode )
+    {
+        case 0x00: return OpNOP();
+        case 0x01: return OpLD_rr_nn<BC>();
+        case 0x02: return OpLD_rr_r<BC,A>();
+        case 0x03: return OpINC_rr<BC>();
+        case 0x04: return OpINC_r<B>();
+        case 0x05: return OpDEC_r<B>();
+        case 0x06: return OpLD_r_n<B>();
+        case 0x07: return OpRLCA();
+        case 0x08: return OpLD_nn_SP();
+        case 0x09: return OpADD_HL_rr<BC>();
+        case 0x0a: return OpLD_r_rr<A,BC>();
+        case 0x0b: return OpDEC_rr<BC>();
+        case 0x0c: return OpINC_r<C>();
+        case 0x0d: return OpDEC_r<C>();
+        case 0x0e: return OpLD_r_n<C>();
+        case 0x0f: return OpRRCA();
+        case 0x10: return OpSTOP();
+        case 0x11: return OpLD_rr_nn<DE>();
+        case 0x12: return OpLD_rr_r<DE,A>();
+        case 0x13: return OpINC_rr<DE>();
+        case 0x14: return OpINC_r<D>();
+        case 0x15: return OpDEC_r<D>();
+        case 0x16: return OpLD_r_n<D>();
+        case 0x17: return OpRLA();
+        case 0x18: return OpJR_n();
+        case 0x19: return OpADD_HL_rr<DE>();
+        case 0x1a: return OpLD_r_rr<A,DE>();
+        case 0x1b: return OpDEC_rr<DE>();
+        case 0x1c: return OpINC_r<E>();
+        case 0x1d: return OpDEC_r<E>();
+        case 0x1e: return OpLD_r_n<E>();
+        case 0x1f: return OpRRA();
+        case 0x20: return OpJR_NZ_n();
+        case 0x21: return OpLD_rr_nn<HL>();
+        case 0x22: return OpLDI_HL_A();
+        case 0x23: return OpINC_rr<HL>();
+        case 0x24: return OpINC_r<H>();
+        case 0x25: return OpDEC_r<H>();
+        case 0x26: return OpLD_r_n<H>();
+        case 0x27: return OpDAA();
+        case 0x28: return OpJR_Z_n();
+        case 0x29: return OpADD_HL_rr<HL>();
+        case 0x2a: return OpLDI_A_HL();
+        case 0x2b: return OpDEC_rr<HL>();
+        case 0x2c: return OpINC_r<L>();
+        case 0x2d: return OpDEC_r<L>();
+        case 0x2e: return OpLD_r_n<L>();
+        case 0x2f: return OpCPL();
+        case 0x30: return OpJR_NC_n();
+        case 0x31: return OpLD_SP_nn();
+        case 0x32: return OpLDD_HL_A();
+        case 0x33: return OpINC_SP();
+        case 0x34: return OpINC_HL();
+        case 0x35: return OpDEC_HL();
+        case 0x36: return OpLD_rr_n<HL>();
+        case 0x37: return OpSCF();
+        case 0x38: return OpJR_C_n();
+        case 0x39: return OpADD_HL_SP();
+        case 0x3a: return OpLDD_A_HL();
+        case 0x3b: return OpDEC_SP();
+        case 0x3c: return OpINC_r<A>();
+        case 0x3d: return OpDEC_r<A>();
+        case 0x3e: return OpLD_r_n<A>();
+        case 0x3f: return OpCCF();
+        case 0x40: return OpLD_r_r<B,B>();
+        case 0x41: return OpLD_r_r<B,C>();
+        case 0x42: return OpLD_r_r<B,D>();
+        case 0x43: return OpLD_r_r<B,E>();
+        case 0x44: return OpLD_r_r<B,H>();
+        case 0x45: return OpLD_r_r<B,L>();
+        case 0x46: return OpLD_r_rr<B,HL>();
+        case 0x47: return OpLD_r_r<B,A>();
+        case 0x48: return OpLD_r_r<C,B>();
+        case 0x49: return OpLD_r_r<C,C>();
+        case 0x4a: return OpLD_r_r<C,D>();
+        case 0x4b: return OpLD_r_r<C,E>();
+        case 0x4c: return OpLD_r_r<C,H>();
+        case 0x4d: return OpLD_r_r<C,L>();
+        case 0x4e: return OpLD_r_rr<C,HL>();
+        case 0x4f: return OpLD_r_r<C,A>();
+        case 0x50: return OpLD_r_r<D,B>();
+        case 0x51: return OpLD_r_r<D,C>();
+        case 0x52: return OpLD_r_r<D,D>();
+        case 0x53: return OpLD_r_r<D,E>();
+        case 0x54: return OpLD_r_r<D,H>();
+        case 0x55: return OpLD_r_r<D,L>();
+        case 0x56: return OpLD_r_rr<D,HL>();
+        case 0x57: return OpLD_r_r<D,A>();
+        case 0x58: return OpLD_r_r<E,B>();
+        case 0x59: return OpLD_r_r<E,C>();
+        case 0x5a: return OpLD_r_r<E,D>();
+        case 0x5b: return OpLD_r_r<E,E>();
+        case 0x5c: return OpLD_r_r<E,H>();
+        case 0x5d: return OpLD_r_r<E,L>();
+        case 0x5e: return OpLD_r_rr<E,HL>();
+        case 0x5f: return OpLD_r_r<E,A>();
+        case 0x60: return OpLD_r_r<H,B>();
+        case 0x61: return OpLD_r_r<H,C>();
+        case 0x62: return OpLD_r_r<H,D>();
+        case 0x63: return OpLD_r_r<H,E>();
+        case 0x64: return OpLD_r_r<H,H>();
+        case 0x65: return OpLD_r_r<H,L>();
+        case 0x66: return OpLD_r_rr<H,HL>();
+        case 0x67: return OpLD_r_r<H,A>();
+        case 0x68: return OpLD_r_r<L,B>();
+        case 0x69: return OpLD_r_r<L,C>();
+        case 0x6a: return OpLD_r_r<L,D>();
+        case 0x6b: return OpLD_r_r<L,E>();
+        case 0x6c: return OpLD_r_r<L,H>();
+        case 0x6d: return OpLD_r_r<L,L>();
+        case 0x6e: return OpLD_r_rr<L,HL>();
+        case 0x6f: return OpLD_r_r<L,A>();
+        case 0x70: return OpLD_rr_r<HL,B>();
+        case 0x71: return OpLD_rr_r<HL,C>();
+        case 0x72: return OpLD_rr_r<HL,D>();
+        case 0x73: return OpLD_rr_r<HL,E>();
+        case 0x74: return OpLD_rr_r<HL,H>();
+        case 0x75: return OpLD_rr_r<HL,L>();
+        case 0x76: return OpHALT();
+        case 0x77: return OpLD_rr_r<HL,A>();
+        case 0x78: return OpLD_r_r<A,B>();
+        case 0x79: return OpLD_r_r<A,C>();
+        case 0x7a: return OpLD_r_r<A,D>();
+        case 0x7b: return OpLD_r_r<A,E>();
+        case 0x7c: return OpLD_r_r<A,H>();
+        case 0x7d: return OpLD_r_r<A,L>();
+        case 0x7e: return OpLD_r_rr<A,HL>();
+        case 0x7f: return OpLD_r_r<A,A>();
+        case 0x80: return OpADD_r_r<A,B>();
+        case 0x81: return OpADD_r_r<A,C>();
+        case 0x82: return OpADD_r_r<A,D>();
+        case 0x83: return OpADD_r_r<A,E>();
+        case 0x84: return OpADD_r_r<A,H>();
+        case 0x85: return OpADD_r_r<A,L>();
+        case 0x86: return OpADD_r_rr<A,HL>();
+        case 0x87: return OpADD_r_r<A,A>();
+        case 0x88: return OpADC_r_r<A,B>();
+        case 0x89: return OpADC_r_r<A,C>();
+        case 0x8a: return OpADC_r_r<A,D>();
+        case 0x8b: return OpADC_r_r<A,E>();
+        case 0x8c: return OpADC_r_r<A,H>();
+        case 0x8d: return OpADC_r_r<A,L>();
+        case 0x8e: return OpADC_r_rr<A,HL>();
+        case 0x8f: return OpADC_r_r<A,A>();
+        case 0x90: return OpSUB_r_r<A,B>();
+        case 0x91: return OpSUB_r_r<A,C>();
+        case 0x92: return OpSUB_r_r<A,D>();
+        case 0x93: return OpSUB_r_r<A,E>();
+        case 0x94: return OpSUB_r_r<A,H>();
+        case 0x95: return OpSUB_r_r<A,L>();
+        case 0x96: return OpSUB_r_rr<A,HL>();
+        case 0x97: return OpSUB_r_r<A,A>();
+        case 0x98: return OpSBC_r_r<A,B>();
+        case 0x99: return OpSBC_r_r<A,C>();
+        case 0x9a: return OpSBC_r_r<A,D>();
+        case 0x9b: return OpSBC_r_r<A,E>();
+        case 0x9c: return OpSBC_r_r<A,H>();
+        case 0x9d: return OpSBC_r_r<A,L>();
+        case 0x9e: return OpSBC_r_rr<A,HL>();
+        case 0x9f: return OpSBC_r_r<A,A>();
+        case 0xa0: return OpAND_r_r<A,B>();
+        case 0xa1: return OpAND_r_r<A,C>();
+        case 0xa2: return OpAND_r_r<A,D>();
+        case 0xa3: return OpAND_r_r<A,E>();
+        case 0xa4: return OpAND_r_r<A,H>();
+        case 0xa5: return OpAND_r_r<A,L>();
+        case 0xa6: return OpAND_r_rr<A,HL>();
+        case 0xa7: return OpAND_r_r<A,A>();
+        case 0xa8: return OpXOR_r_r<A,B>();
+        case 0xa9: return OpXOR_r_r<A,C>();
+        case 0xaa: return OpXOR_r_r<A,D>();
+        case 0xab: return OpXOR_r_r<A,E>();
+        case 0xac: return OpXOR_r_r<A,H>();
+        case 0xad: return OpXOR_r_r<A,L>();
+        case 0xae: return OpXOR_r_rr<A,HL>();
+        case 0xaf: return OpXOR_r_r<A,A>();
+        case 0xb0: return OpOR_r_r<A,B>();
+        case 0xb1: return OpOR_r_r<A,C>();
+        case 0xb2: return OpOR_r_r<A,D>();
+        case 0xb3: return OpOR_r_r<A,E>();
+        case 0xb4: return OpOR_r_r<A,H>();
+        case 0xb5: return OpOR_r_r<A,L>();
+        case 0xb6: return OpOR_r_rr<A,HL>();
+        case 0xb7: return OpOR_r_r<A,A>();
+        case 0xb8: return OpCMP_r_r<A,B>();
+        case 0xb9: return OpCMP_r_r<A,C>();
+        case 0xba: return OpCMP_r_r<A,D>();
+        case 0xbb: return OpCMP_r_r<A,E>();
+        case 0xbc: return OpCMP_r_r<A,H>();
+        case 0xbd: return OpCMP_r_r<A,L>();
+        case 0xbe: return OpCMP_r_rr<A,HL>();
+        case 0xbf: return OpCMP_r_r<A,A>();
+        case 0xc0: return OpRET_NZ_nn();
+        case 0xc1: return OpPOP_rr_nn<BC>();
+        case 0xc2: return OpJP_NZ_nn();
+        case 0xc3: return OpJP_nn();
+        case 0xc4: return OpCALL_NZ_nn();
+        case 0xc5: return OpPUSH_rr_nn<BC>();
+        case 0xc6: return OpADD_r_n<A>();
+        case 0xc7: return OpRST_nn<0x00>();
+        case 0xc8: return OpRET_Z_nn();
+        case 0xc9: return OpRET_nn();
+        case 0xca: return OpJP_Z_nn();
+        case 0xcb: return DispatchExtOpcode( ReadMemory( m_State.u16PC++ ) );
+        case 0xcc: return OpCALL_Z_nn();
+        case 0xcd: return OpCALL_nn();
+        case 0xce: return OpADC_r_n<A>();
+        case 0xcf: return OpRST_nn<0x08>();
+        case 0xd0: return OpRET_NC_nn();
+        case 0xd1: return OpPOP_rr_nn<DE>();
+        case 0xd2: return OpJP_NC_nn();
+        case 0xd3: return OpInvalid<0xD3>();
+        case 0xd4: return OpCALL_NC_nn();
+        case 0xd5: return OpPUSH_rr_nn<DE>();
+        case 0xd6: return OpSUB_r_n<A>();
+        case 0xd7: return OpRST_nn<0x10>();
+        case 0xd8: return OpRET_C_nn();
+        case 0xd9: return OpRETI_nn();
+        case 0xda: return OpJP_C_nn();
+        case 0xdb: return OpInvalid<0xDB>();
+        case 0xdc: return OpCALL_C_nn();
+        case 0xdd: return OpInvalid<0xDD>();
+        case 0xde: return OpSBC_r_n<A>();
+        case 0xdf: return OpRST_nn<0x18>();
+        case 0xe0: return OpLDH_n_A();
+        case 0xe1: return OpPOP_rr_nn<HL>();
+        case 0xe2: return OpLDH_C_A();
+        case 0xe3: return OpInvalid<0xE3>();
+        case 0xe4: return OpInvalid<0xE4>();
+        case 0xe5: return OpPUSH_rr_nn<HL>();
+        case 0xe6: return OpAND_r_n<A>();
+        case 0xe7: return OpRST_nn<0x20>();
+        case 0xe8: return OpADD_SP_n();
+        case 0xe9: return OpJP_HL();
+        case 0xea: return OpLD_nn_r<A>();
+        case 0xeb: return OpInvalid<0xEB>();
+        case 0xec: return OpInvalid<0xEC>();
+        case 0xed: return OpInvalid<0xED>();
+        case 0xee: return OpXOR_r_n<A>();
+        case 0xef: return OpRST_nn<0x28>();
+        case 0xf0: return OpLDH_A_n();
+        case 0xf1: return OpPOP_rr_nn<AF>();
+        case 0xf2: return OpLDH_A_C();
+        case 0xf3: return OpDI();
+        case 0xf4: return OpInvalid<0xF4>();
+        case 0xf5: return OpPUSH_rr_nn<AF>();
+        case 0xf6: return OpOR_r_n<A>();
+        case 0xf7: return OpRST_nn<0x30>();
+        case 0xf8: return OpLD_HL_SP_n();
+        case 0xf9: return OpLD_SP_HL();
+        case 0xfa: return OpLD_r_nn<A>();
+        case 0xfb: return OpEI();
+        case 0xfc: return OpInvalid<0xFC>();
+        case 0xfd: return OpInvalid<0xFD>();
+        case 0xfe: return OpCMP_r_n<A>();
+        case 0xff: return OpRST_nn<0x38>();
+    }
+
+    return 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+int GBCpu::DispatchExtOpcode( ubyte opcode )
+{
+    // 0xCB opcodes, dispatched directly instead of going through OpExecuteExtOp and the second table
+    switch( opcode )
+    {
+        case 0x00: return OpRLC_r<B>();
+        case 0x01: return OpRLC_r<C>();
+        case 0x02: return OpRLC_r<D>();
+        case 0x03: return OpRLC_r<E>();
+        case 0x04: return OpRLC_r<H>();
+        case 0x05: return OpRLC_r<L>();
+        case 0x06: return OpRLC_HL();
+        case 0x07: return OpRLC_r<A>();
+        case 0x08: return OpRRC_r<B>();
+        case 0x09: return OpRRC_r<C>();
+        case 0x0a: return OpRRC_r<D>();
+        case 0x0b: return OpRRC_r<E>();
+        case 0x0c: return OpRRC_r<H>();
+        case 0x0d: return OpRRC_r<L>();
+        case 0x0e: return OpRRC_HL();
+        case 0x0f: return OpRRC_r<A>();
+        case 0x10: return OpRL_r<B>();
+        case 0x11: return OpRL_r<C>();
+        case 0x12: return OpRL_r<D>();
+        case 0x13: return OpRL_r<E>();
+        case 0x14: return OpRL_r<H>();
+        case 0x15: return OpRL_r<L>();
+        case 0x16: return OpRL_HL();
+        case 0x17: return OpRL_r<A>();
+        case 0x18: return OpRR_r<B>();
+        case 0x19: return OpRR_r<C>();
+        case 0x1a: return OpRR_r<D>();
+        case 0x1b: return OpRR_r<E>();
+        case 0x1c: return OpRR_r<H>();
+        case 0x1d: return OpRR_r<L>();
+        case 0x1e: return OpRR_HL();
+        case 0x1f: return OpRR_r<A>();
+        case 0x20: return OpSLA_r<B>();
+        case 0x21: return OpSLA_r<C>();
+        case 0x22: return OpSLA_r<D>();
+        case 0x23: return OpSLA_r<E>();
+        case 0x24: return OpSLA_r<H>();
+        case 0x25: return OpSLA_r<L>();
+        case 0x26: return OpSLA_HL();
+        case 0x27: return OpSLA_r<A>();
+        case 0x28: return OpSRA_r<B>();
+        case 0x29: return OpSRA_r<C>();
+        case 0x2a: return OpSRA_r<D>();
+        case 0x2b: return OpSRA_r<E>();
+        case 0x2c: return OpSRA_r<H>();
+        case 0x2d: return OpSRA_r<L>();
+        case 0x2e: return OpSRA_HL();
+        case 0x2f: return OpSRA_r<A>();
+        case 0x30: return OpSWAP_r<B>();
+        case 0x31: return OpSWAP_r<C>();
+        case 0x32: return OpSWAP_r<D>();
+        case 0x33: return OpSWAP_r<E>();
+        case 0x34: return OpSWAP_r<H>();
+        case 0x35: return OpSWAP_r<L>();
+        case 0x36: return OpSWAP_HL();
+        case 0x37: return OpSWAP_r<A>();
+        case 0x38: return OpSRL_r<B>();
+        case 0x39: return OpSRL_r<C>();
+        case 0x3a: return OpSRL_r<D>();
+        case 0x3b: return OpSRL_r<E>();
+        case 0x3c: return OpSRL_r<H>();
+        case 0x3d: return OpSRL_r<L>();
+        case 0x3e: return OpSRL_HL();
+        case 0x3f: return OpSRL_r<A>();
+        case 0x40: return OpBIT_r<0,B>();
+        case 0x41: return OpBIT_r<0,C>();
+        case 0x42: return OpBIT_r<0,D>();
+        case 0x43: return OpBIT_r<0,E>();
+        case 0x44: return OpBIT_r<0,H>();
+        case 0x45: return OpBIT_r<0,L>();
+        case 0x46: return OpBIT_HL<0>();
+        case 0x47: return OpBIT_r<0,A>();
+        case 0x48: return OpBIT_r<1,B>();
+        case 0x49: return OpBIT_r<1,C>();
+        case 0x4a: return OpBIT_r<1,D>();
+        case 0x4b: return OpBIT_r<1,E>();
+        case 0x4c: return OpBIT_r<1,H>();
+        case 0x4d: return OpBIT_r<1,L>();
+        case 0x4e: return OpBIT_HL<1>();
+        case 0x4f: return OpBIT_r<1,A>();
+        case 0x50: return OpBIT_r<2,B>();
+        case 0x51: return OpBIT_r<2,C>();
+        case 0x52: return OpBIT_r<2,D>();
+        case 0x53: return OpBIT_r<2,E>();
+        case 0x54: return OpBIT_r<2,H>();
+        case 0x55: return OpBIT_r<2,L>();
+        case 0x56: return OpBIT_HL<2>();
+        case 0x57: return OpBIT_r<2,A>();
+        case 0x58: return OpBIT_r<3,B>();
+        case 0x59: return OpBIT_r<3,C>();
+        case 0x5a: return OpBIT_r<3,D>();
+        case 0x5b: return OpBIT_r<3,E>();
+        case 0x5c: return OpBIT_r<3,H>();
+        case 0x5d: return OpBIT_r<3,L>();
+        case 0x5e: return OpBIT_HL<3>();
+        case 0x5f: return OpBIT_r<3,A>();
+        case 0x60: return OpBIT_r<4,B>();
+        case 0x61: return OpBIT_r<4,C>();
+        case 0x62: return OpBIT_r<4,D>();
+        case 0x63: return OpBIT_r<4,E>();
+        case 0x64: return OpBIT_r<4,H>();
+        case 0x65: return OpBIT_r<4,L>();
+        case 0x66: return OpBIT_HL<4>();
+        case 0x67: return OpBIT_r<4,A>();
+        case 0x68: return OpBIT_r<5,B>();
+        case 0x69: return OpBIT_r<5,C>();
+        case 0x6a: return OpBIT_r<5,D>();
+        case 0x6b: return OpBIT_r<5,E>();
+        case 0x6c: return OpBIT_r<5,H>();
+        case 0x6d: return OpBIT_r<5,L>();
+        case 0x6e: return OpBIT_HL<5>();
+        case 0x6f: return OpBIT_r<5,A>();
+        case 0x70: return OpBIT_r<6,B>();
+        case 0x71: return OpBIT_r<6,C>();
+        case 0x72: return OpBIT_r<6,D>();
+        case 0x73: return OpBIT_r<6,E>();
+        case 0x74: return OpBIT_r<6,H>();
+        case 0x75: return OpBIT_r<6,L>();
+        case 0x76: return OpBIT_HL<6>();
+        case 0x77: return OpBIT_r<6,A>();
+        case 0x78: return OpBIT_r<7,B>();
+        case 0x79: return OpBIT_r<7,C>();
+        case 0x7a: return OpBIT_r<7,D>();
+        case 0x7b: return OpBIT_r<7,E>();
+        case 0x7c: return OpBIT_r<7,H>();
+        case 0x7d: return OpBIT_r<7,L>();
+        case 0x7e: return OpBIT_HL<7>();
+        case 0x7f: return OpBIT_r<7,A>();
+        case 0x80: return OpRES_r<0,B>();
+        case 0x81: return OpRES_r<0,C>();
+        case 0x82: return OpRES_r<0,D>();
+        case 0x83: return OpRES_r<0,E>();
+        case 0x84: return OpRES_r<0,H>();
+        case 0x85: return OpRES_r<0,L>();
+        case 0x86: return OpRES_HL<0>();
+        case 0x87: return OpRES_r<0,A>();
+        case 0x88: return OpRES_r<1,B>();
+        case 0x89: return OpRES_r<1,C>();
+        case 0x8a: return OpRES_r<1,D>();
+        case 0x8b: return OpRES_r<1,E>();
+        case 0x8c: return OpRES_r<1,H>();
+        case 0x8d: return OpRES_r<1,L>();
+        case 0x8e: return OpRES_HL<1>();
+        case 0x8f: return OpRES_r<1,A>();
+        case 0x90: return OpRES_r<2,B>();
+        case 0x91: return OpRES_r<2,C>();
+        case 0x92: return OpRES_r<2,D>();
+        case 0x93: return OpRES_r<2,E>();
+        case 0x94: return OpRES_r<2,H>();
+        case 0x95: return OpRES_r<2,L>();
+        case 0x96: return OpRES_HL<2>();
+        case 0x97: return OpRES_r<2,A>();
+        case 0x98: return OpRES_r<3,B>();
+        case 0x99: return OpRES_r<3,C>();
+        case 0x9a: return OpRES_r<3,D>();
+        case 0x9b: return OpRES_r<3,E>();
+        case 0x9c: return OpRES_r<3,H>();
+        case 0x9d: return OpRES_r<3,L>();
+        case 0x9e: return OpRES_HL<3>();
+        case 0x9f: return OpRES_r<3,A>();
+        case 0xa0: return OpRES_r<4,B>();
+        case 0xa1: return OpRES_r<4,C>();
+        case 0xa2: return OpRES_r<4,D>();
+        case 0xa3: return OpRES_r<4,E>();
+        case 0xa4: return OpRES_r<4,H>();
+        case 0xa5: return OpRES_r<4,L>();
+        case 0xa6: return OpRES_HL<4>();
+        case 0xa7: return OpRES_r<4,A>();
+        case 0xa8: return OpRES_r<5,B>();
+        case 0xa9: return OpRES_r<5,C>();
+        case 0xaa: return OpRES_r<5,D>();
+        case 0xab: return OpRES_r<5,E>();
+        case 0xac: return OpRES_r<5,H>();
+        case 0xad: return OpRES_r<5,L>();
+        case 0xae: return OpRES_HL<5>();
+        case 0xaf: return OpRES_r<5,A>();
+        case 0xb0: return OpRES_r<6,B>();
+        case 0xb1: return OpRES_r<6,C>();
+        case 0xb2: return OpRES_r<6,D>();
+        case 0xb3: return OpRES_r<6,E>();
+        case 0xb4: return OpRES_r<6,H>();
+        case 0xb5: return OpRES_r<6,L>();
+        case 0xb6: return OpRES_HL<6>();
+        case 0xb7: return OpRES_r<6,A>();
+        case 0xb8: return OpRES_r<7,B>();
+        case 0xb9: return OpRES_r<7,C>();
+        case 0xba: return OpRES_r<7,D>();
+        case 0xbb: return OpRES_r<7,E>();
+        case 0xbc: return OpRES_r<7,H>();
+        case 0xbd: return OpRES_r<7,L>();
+        case 0xbe: return OpRES_HL<7>();
+        case 0xbf: return OpRES_r<7,A>();
+        case 0xc0: return OpSET_r<0,B>();
+        case 0xc1: return OpSET_r<0,C>();
+        case 0xc2: return OpSET_r<0,D>();
+        case 0xc3: return OpSET_r<0,E>();
+        case 0xc4: return OpSET_r<0,H>();
+        case 0xc5: return OpSET_r<0,L>();
+        case 0xc6: return OpSET_HL<0>();
+        case 0xc7: return OpSET_r<0,A>();
+        case 0xc8: return OpSET_r<1,B>();
+        case 0xc9: return OpSET_r<1,C>();
+        case 0xca: return OpSET_r<1,D>();
+        case 0xcb: return OpSET_r<1,E>();
+        case 0xcc: return OpSET_r<1,H>();
+        case 0xcd: return OpSET_r<1,L>();
+        case 0xce: return OpSET_HL<1>();
+        case 0xcf: return OpSET_r<1,A>();
+        case 0xd0: return OpSET_r<2,B>();
+        case 0xd1: return OpSET_r<2,C>();
+        case 0xd2: return OpSET_r<2,D>();
+        case 0xd3: return OpSET_r<2,E>();
+        case 0xd4: return OpSET_r<2,H>();
+        case 0xd5: return OpSET_r<2,L>();
+        case 0xd6: return OpSET_HL<2>();
+        case 0xd7: return OpSET_r<2,A>();
+        case 0xd8: return OpSET_r<3,B>();
+        case 0xd9: return OpSET_r<3,C>();
+        case 0xda: return OpSET_r<3,D>();
+        case 0xdb: return OpSET_r<3,E>();
+        case 0xdc: return OpSET_r<3,H>();
+        case 0xdd: return OpSET_r<3,L>();
+        case 0xde: return OpSET_HL<3>();
+        case 0xdf: return OpSET_r<3,A>();
+        case 0xe0: return OpSET_r<4,B>();
+        case 0xe1: return OpSET_r<4,C>();
+        case 0xe2: return OpSET_r<4,D>();
+        case 0xe3: return OpSET_r<4,E>();
+        case 0xe4: return OpSET_r<4,H>();
+        case 0xe5: return OpSET_r<4,L>();
+        case 0xe6: return OpSET_HL<4>();
+        case 0xe7: return OpSET_r<4,A>();
+        case 0xe8: return OpSET_r<5,B>();
+        case 0xe9: return OpSET_r<5,C>();
+        case 0xea: return OpSET_r<5,D>();
+        case 0xeb: return OpSET_r<5,E>();
+        case 0xec: return OpSET_r<5,H>();
+        case 0xed: return OpSET_r<5,L>();
+        case 0xee: return OpSET_HL<5>();
+        case 0xef: return OpSET_r<5,A>();
+        case 0xf0: return OpSET_r<6,B>();
+        case 0xf1: return OpSET_r<6,C>();
+        case 0xf2: return OpSET_r<6,D>();
+        case 0xf3: return OpSET_r<6,E>();
+        case 0xf4: return OpSET_r<6,H>();
+        case 0xf5: return OpSET_r<6,L>();
+        case 0xf6: return OpSET_HL<6>();
+        case 0xf7: return OpSET_r<6,A>();
+        case 0xf8: return OpSET_r<7,B>();
+        case 0xf9: return OpSET_r<7,C>();
+        case 0xfa: return OpSET_r<7,D>();
+        case 0xfb: return OpSET_r<7,E>();
+        case 0xfc: return OpSET_r<7,H>();
+        case 0xfd: return OpSET_r<7,L>();
+        case 0xfe: return OpSET_HL<7>();
+        case 0xff: return OpSET_r<7,A>();
+    }
+
+    return 0;
 }
\ No newline at end of file
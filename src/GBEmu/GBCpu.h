@@ -13,6 +13,8 @@
 
 #include "emutypes.h"
 
+#include <malloc.h>
+
 #include "GBMMIORegister.h"
 #include "GBEmulator.h"
 
@@ -23,6 +25,24 @@
 class GBMem;
 class GBTimer;
 class GBCpuUnitTest;
+class GBCpuBenchmark;
+class GBCpuBlockCache;
+class GBCpuTrace;
+class GBCpuHotSpots;
+struct GBCpuBlock;
+struct GBCpuDecodedOp;
+
+//====================================================================================================
+// Structs
+//====================================================================================================
+
+// Tooling each CPU instance runs with. Only the windowed emulator turns any of it on, headless
+// instances would otherwise share its trace and hot spot files.
+struct GBCpuOptions
+{
+    string  strTraceFilepath;       // Empty for no trace
+    string  strHotSpotFilepath;     // Empty for no hot spot report
+};
 
 //====================================================================================================
 // Class
@@ -31,22 +51,25 @@ class GBCpuUnitTest;
 class GBCpu : public GBMMIORegister
 {
     friend class GBCpuUnitTest;
+    friend class GBCpuBenchmark;
+    friend class GBCpuBatch;
 
     // Enums
+    // Low byte of each pair first, so a pair can be read straight out of the register file
     enum
     {
-        A, F,
-        B, C,
-        D, E,
-        H, L
+        F, A,
+        C, B,
+        E, D,
+        L, H
     };
 
     enum RegisterPair
     {
-        AF = A,
-        BC = B,
-        DE = D,
-        HL = H
+        AF = F,
+        BC = C,
+        DE = E,
+        HL = L
     };
 
     enum RegisterFlag
@@ -57,11 +80,33 @@ class GBCpu : public GBMMIORegister
         CF = 1 << 4
     };
 
+    // ALU operation recorded for lazy flag evaluation
+    enum FlagOp
+    {
+        kFlagOpNone,        // F is up to date
+        kFlagOpAdd,         // ADD/ADC, result holds the 9 bit sum
+        kFlagOpSub,         // SUB/SBC/CP, result holds the 16 bit difference
+        kFlagOpAnd,
+        kFlagOpLogic,       // OR/XOR/SWAP and the CB shifts, bit 8 of the result is the carry
+        kFlagOpRotateA,     // RLCA/RLA/RRCA/RRA, bit 8 of the result is the carry
+        kFlagOpInc,         // INC/DEC/BIT keep the previous carry, it is stored in place of the operands
+        kFlagOpDec,
+        kFlagOpBit
+    };
+
     enum
     {
         DebugHistorySize    = 0x10000
     };
 
+    // Cached pending interrupt mask, the five requests plus a bit that keeps HandleInterrupts called
+    // until a delayed EI takes effect
+    enum
+    {
+        kInterruptRequests  = 0x1F,
+        kInterruptEIDelay   = 1 << 7
+    };
+
 public:
 
     // Structs
@@ -87,8 +132,8 @@ public:
             BC = pCpu->GetRegisterPair( GBCpu::BC );
             DE = pCpu->GetRegisterPair( GBCpu::DE );
             HL = pCpu->GetRegisterPair( GBCpu::HL );
-            PC = pCpu->m_PC;
-            SP = pCpu->m_SP;
+            PC = pCpu->m_State.u16PC;
+            SP = pCpu->m_State.u16SP;
         }
     };
 
@@ -96,48 +141,156 @@ public:
     // Class typedefs
     typedef int (GBCpu::*GBCpuOpcodeHandler)();
 
+    // Memory an opcode touches besides its own bytes
+    enum OpcodeMemAccess
+    {
+        kOpMemNone          = 0,
+        kOpMemRead          = 1 << 0,
+        kOpMemWrite         = 1 << 1,
+        kOpMemReadWrite     = kOpMemRead | kOpMemWrite,
+        kOpMemStack         = 1 << 2        // Addressed through SP
+    };
+
+    // Opcode descriptor shared by the interpreter and the block cache
+    struct OpcodeInfo
+    {
+        GBCpuOpcodeHandler  pfnHandler;
+        const char*         szMnemonic;     // n, nn and e stand for the immediate operands
+        ubyte               u8Length;       // Bytes including the opcode, 0 for invalid opcodes
+        ubyte               u8Cycles;       // Conditional branches are counted as not taken
+        ubyte               u8TakenCycles;  // Cycles when a conditional branch is taken
+        ubyte               u8MemAccess;    // OpcodeMemAccess flags
+    };
+
+    // Architectural state, kept in one cache line so the hot part of the CPU stays together and a
+    // snapshot is a single copy
+    struct __declspec(align(64)) MachineState
+    {
+        union
+        {
+            ubyte   u8Registers[ 8 ];           // Indexed by register
+            uint16  u16RegisterPairs[ 4 ];      // Indexed by register pair / 2
+        };
+        uint16      u16PC;
+        uint16      u16SP;
+
+        // Lazy flags
+        uint16      u16FlagResult;
+        ubyte       u8FlagOp;                   // FlagOp still to be folded into F
+        ubyte       u8FlagOperands;             // Operands xor'ed together, bit 4 gives the half carry
+
+        // Interrupts and low power modes
+        ubyte       u8InterruptFlags;
+        ubyte       u8InterruptEnable;
+        ubyte       u8InterruptLines;           // Requests held by a peripheral, raised again after every instruction
+        ubyte       u8InterruptPending;         // IE & IF, kept up to date by everything that changes either
+        ubyte       u8EIDelay;                  // Instruction ends left before EI sets IME
+        bool        bIME;
+        bool        bHalt;
+        bool        bStop;
+    };
+
     // Static constants
-    static const uint32 CLOCK_SPEED;
+    static const uint32     CLOCK_SPEED;
+    static const OpcodeInfo OPCODE_INFO[ 256 ];
+    static const OpcodeInfo EXT_OPCODE_INFO[ 256 ];     // 0xCB prefixed opcodes
 
 public:
     // Constructor / destructor
-    GBCpu( GBMem* pMemoryModule, GBTimer* pTimer );
+    GBCpu( GBMem* pMemoryModule, GBTimer* pTimer, const GBCpuOptions& oOptions );
     virtual ~GBCpu( void );
 
+    // Plain new only guarantees 8 or 16 byte alignment, the machine state needs its cache line
+    static void*    operator new( size_t size )                         { return _aligned_malloc( size, __alignof( GBCpu ) );   }
+    static void     operator delete( void* p )                          { _aligned_free( p );                                   }
+
     void            SetPC( uint16 u16PC );
     bool            m_bInit;
 
     // Cpu functions
     void            Reset();
-    inline bool     IsRunning()                                         { return !m_bHalt && !m_bStop;    }
+    inline bool     IsRunning()                                         { return !m_State.bHalt && !m_State.bStop;    }
     int             ExecuteOpcode();
     void            RaiseInterrupt( Interrupt interrupt );
+    void            SetInterruptLine( Interrupt interrupt, bool bAsserted );
     int             HandleInterrupts();
 
+    // Runs instructions and interrupts until the deadline is reached or a yield is requested, returns
+    // the cycles taken
+    int             RunUntil( int iCycleDeadline );
+
+    // Cycles a halted CPU fast-forwarded through instead of stepping
+    inline uint32   GetHaltSkippedCycles() const                        { return m_u32HaltSkippedCycles;  }
+    inline void     ResetHaltSkippedCycles()                            { m_u32HaltSkippedCycles = 0;     }
+
+    // Cycles skipped in polling loops instead of running them
+    inline uint32   GetIdleSkippedCycles() const                        { return m_u32IdleSkippedCycles;  }
+    inline void     ResetIdleSkippedCycles()                            { m_u32IdleSkippedCycles = 0;     }
+
+    // Heap the CPU holds on to for its whole life
+    uint32          GetHistoryBytes() const;
+    uint32          GetBlockCacheBytes() const;
+
 private:
     // Startup and cleanup
     void            Initialize();
     void            Terminate();
 
     // Utility functions
-    inline uint16   GetRegisterPair( RegisterPair pair )                { return m_Registers[ pair ] << 8 | m_Registers[ pair + 1 ];                                                    }
-    inline void     SetRegisterPair( RegisterPair pair, uint16 value )  { m_Registers[ pair ] = value >> 8; m_Registers[ pair + 1 ]    = ( AF != pair ) ? value & 0xFF : value & 0xF0;  }
+    inline uint16   GetRegisterPair( RegisterPair pair )                { if( AF == pair ) { MaterializeFlags(); } return m_State.u16RegisterPairs[ pair >> 1 ];                                      }
+    inline void     SetRegisterPair( RegisterPair pair, uint16 value )  { if( AF == pair ) { m_State.u8FlagOp = kFlagOpNone; } m_State.u16RegisterPairs[ pair >> 1 ] = ( AF != pair ) ? value : value & 0xFFF0;  }
+
+    inline bool     GetRegisterFlag( RegisterFlag flag );
+    inline void     SetRegisterFlag( RegisterFlag flag, bool value )    { MaterializeFlags(); value ? m_State.u8Registers[ F ] |= flag : m_State.u8Registers[ F ] &= ~flag;                             }
 
-    inline bool     GetRegisterFlag( RegisterFlag flag )                { return 0 != ( m_Registers[ F ] & flag );                                                                      }
-    inline void     SetRegisterFlag( RegisterFlag flag, bool value )    { value ? m_Registers[ F ] |= flag : m_Registers[ F ] &= ~flag;                                                 }
+    // Lazy flags, the last ALU operation is recorded and F is only computed when it gets read
+    inline void     SetLazyFlags( FlagOp op, uint16 u16Result, ubyte u8Operands );
+    inline void     SetLazyFlagsKeepCarry( FlagOp op, ubyte u8Result );
+    inline void     MaterializeFlags()                                  { if( kFlagOpNone != m_State.u8FlagOp ) { EvaluateFlags(); }                                                         }
+    void            EvaluateFlags();
 
-    inline ubyte    GetInterruptFlagsRegister() const                   { return m_u8InterruptFlags;                    }
-    inline void     SetInterruptFlagsRegsiter( ubyte u8Data )           { m_u8InterruptFlags = u8Data;                  }
+    inline ubyte    GetInterruptFlagsRegister() const                   { return m_State.u8InterruptFlags;                    }
+    inline void     SetInterruptFlagsRegsiter( ubyte u8Data )           { m_State.u8InterruptFlags = u8Data; UpdateInterruptPending();    }
 
-    inline ubyte    GetInterruptEnableRegister() const                  { return m_u8InterruptEnable;                   }
-    inline void     SetInterruptEnableRegsiter( ubyte u8Data )          { m_u8InterruptEnable = u8Data;                 }
+    inline ubyte    GetInterruptEnableRegister() const                  { return m_State.u8InterruptEnable;                   }
+    inline void     SetInterruptEnableRegsiter( ubyte u8Data )          { m_State.u8InterruptEnable = u8Data; UpdateInterruptPending();   }
+
+    // Has to be called whenever IF, IE or the EI delay change
+    inline void     UpdateInterruptPending()                            { m_State.u8InterruptPending = ( m_State.u8InterruptEnable & m_State.u8InterruptFlags & kInterruptRequests ) | ( ( 0 != m_State.u8EIDelay ) ? kInterruptEIDelay : 0 ); }
 
     ubyte           ReadMemory( uint16 u16Addr );
     void            WriteMemory( uint16 u16Addr, ubyte u8Data );
     void            SimulateIO( ubyte u8Clocks );
+    inline ubyte    FetchOperand();
 
     void            DebugDumpHistory();
 
+    // Interpreter cores, CPU_SWITCH_CORE selects which one ExecuteOpcode uses
+    template<bool SWITCH_CORE>  int     ExecuteOpcodeCore();
+    template<bool SWITCH_CORE>  int     RunUntilCore( int iCycleDeadline );
+    int             DispatchOpcode( ubyte opcode );
+    int             DispatchExtOpcode( ubyte opcode );
+
+    // Predecoded block cache, CPU_BLOCK_CACHE enables it
+    bool            GetBlockRegion( uint16 u16PC, uint32& u32Key, uint32& u32End );
+    GBCpuBlock*     DecodeBlock( uint32 u32Key, uint32 u32End );
+    const GBCpuDecodedOp*   FetchDecodedOp();
+    template<bool SWITCH_CORE>  int     ExecuteDecodedOp( const GBCpuDecodedOp* pOp );
+    void            InvalidateBlocks( uint16 u16Addr );
+    void            FlushBlockCache();
+    bool            IsIdleLoopBlock( const GBCpuBlock* pBlock ) const;
+    int             SkipIdleLoop();
+
+#if CPU_TRACE
+    void            RecordTrace();
+#endif
+
+#if CPU_HOTSPOTS
+    int             ExecuteHotSpotOpcode();
+#endif
+
+    int             SkipHalt( int iCycles );
+
     // Executes an extended opcode (0xCB)
     int             ExecuteExtOpcode();
     int             ExecuteInterrupt( uint16 addr );
@@ -289,31 +442,50 @@ private:
     
 
 private:
-    GBCpuOpcodeHandler  m_OpcodeHandlers[ 256 ];
-    GBCpuOpcodeHandler  m_OpcodeExtHandlers[ 256 ];
+    // Architectural state
+    MachineState        m_State;
 
     GBMem*              m_pMem;
     GBTimer*            m_pTimer;
+    GBCpuOptions        m_oOptions;
     bool                m_bInitialized;
 
-    // Registers
-    ubyte               m_Registers[ 8 ];
+    // Block cache
+    GBCpuBlockCache*    m_pBlockCache;
+    GBCpuBlock*         m_pBlock;           // Block being executed, NULL when running uncached
+    ubyte               m_u8BlockOp;        // Index of the next op in m_pBlock
+    uint16              m_u16BlockPC;       // PC of the next op in m_pBlock
+    const ubyte*        m_pu8Operand;       // Predecoded immediates of the op being executed
+
+    // Run budget
+    int                 m_iCycleBudget;     // Cycles left before RunUntil's deadline, idle loops stop short of it
+    bool                m_bYield;           // Set by writes the other modules have to see right away
+
+#if CPU_TRACE
+    // Trace
+    GBCpuTrace*         m_pTrace;           // NULL unless a trace file is set in the options
+#endif
+
+#if CPU_HOTSPOTS
+    // Hot spots
+    GBCpuHotSpots*      m_pHotSpots;        // NULL unless a hot spot file is set in the options
+#endif
 
     // Control & flow
-    uint16              m_PC;
-    uint16              m_SP;
-    bool                m_bHalt;
-    bool                m_bStop;
-    bool                m_bIME;
     bool                m_bBiosDisabled;
+    uint32              m_u32HaltSkippedCycles;
+    uint32              m_u32RunCount;          // RunUntil calls, the other modules update between them
 
-    // Interrupts
-    ubyte               m_u8InterruptFlags;
-    ubyte               m_u8InterruptEnable;
+    // Idle loops, state of the last entry into a loop block
+    const GBCpuBlock*   m_pIdleBlock;
+    uint32              m_u32IdleRunCount;
+    int                 m_iIdleCycleBudget;
+    MachineState        m_oIdleState;
+    uint32              m_u32IdleSkippedCycles;
 
-    // Debug data
+    // Debug data, the history is allocated separately to keep it out of the CPU object
     uint16              m_DebugPC;
-    CpuState            m_u16History[ DebugHistorySize ];
+    CpuState*           m_pHistory;
     uint32              m_u32HistoryIndex;
 };
 
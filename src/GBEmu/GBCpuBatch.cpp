@@ -0,0 +1,1051 @@
+//====================================================================================================
+// Filename:    GBCpuBatch.cpp
+// Created by:  Jeff Padgham
+// Description: Runs many copies of one cartridge on a single core. Each lane is a headless emulator
+//              with its own memory and peripherals. While the lanes sit at the same PC their registers
+//              are kept side by side (a structure of arrays) and register-only instructions are run for
+//              every lane at once, with AVX2 when the host has it. Anything else, or lanes that part
+//              ways, run on each lane's own CPU.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBCpuBatch.h"
+
+#include "GBEmulator.h"
+#include "GBCpu.h"
+#include "GBMem.h"
+#include "GBGpu.h"
+#include "GBTimer.h"
+#include "GBJoypad.h"
+#include "GBRomCache.h"
+#include "CProfileManager.h"
+#include "CLog.h"
+
+#include <windows.h>
+#include <string.h>
+#include <immintrin.h>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define CPU_BATCH_AVX2
+#else
+#define CPU_BATCH_AVX2  __attribute__(( target( "avx2" ) ))
+#endif
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+GBCpuBatch::GBCpuBatch( uint32 u32Lanes ) :
+    m_u32Lanes( ( u32Lanes > kCpuBatchMaxLanes ) ? kCpuBatchMaxLanes : u32Lanes ),
+    m_u16PC( 0 ),
+    m_bGathered( false ),
+    m_iPendingCycles( 0 ),
+    m_iTimerSlack( 0 ),
+    m_bLockstepEnabled( true ),
+    m_u64TotalCycles( 0 ),
+    m_u64LockstepCycles( 0 )
+{
+    memset( m_pLanes, 0, sizeof( m_pLanes ) );
+    memset( m_iFrameCycles, 0, sizeof( m_iFrameCycles ) );
+    memset( m_iWindowCycles, 0, sizeof( m_iWindowCycles ) );
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        m_pLanes[ i ] = new GBEmulator( true );
+    }
+
+    // Rows are padded to whole vectors so the kernels never need a tail loop, the padding lanes
+    // compute garbage nobody reads
+    m_u32Stride     = ( m_u32Lanes + kCpuBatchLaneAlignment - 1 ) & ~( kCpuBatchLaneAlignment - 1 );
+    m_pu8Registers  = static_cast<ubyte*>( _aligned_malloc( m_u32Stride * 12, kCpuBatchLaneAlignment ) );
+    memset( m_pu8Registers, 0, m_u32Stride * 12 );
+
+    for( uint32 i = 0; i < 8; ++i )
+    {
+        m_pu8Row[ i ] = m_pu8Registers + i * m_u32Stride;
+    }
+    m_pu16SP        = reinterpret_cast<uint16*>( m_pu8Registers + 8 * m_u32Stride );
+    m_pu8Immediate  = m_pu8Registers + 10 * m_u32Stride;
+
+    bool bAvx2      = IsAvx2Supported();
+    m_pfnAlu        = bAvx2 ? &GBCpuBatch::AluAvx2 : &GBCpuBatch::AluScalar;
+    m_pfnIncDec     = bAvx2 ? &GBCpuBatch::IncDecAvx2 : &GBCpuBatch::IncDecScalar;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBatch::~GBCpuBatch()
+{
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        delete m_pLanes[ i ];
+        m_pLanes[ i ] = NULL;
+    }
+
+    _aligned_free( m_pu8Registers );
+    m_pu8Registers = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::LoadCartridge( const char* szFilepath )
+{
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        m_pLanes[ i ]->LoadCartridge( szFilepath );
+        if( !m_pLanes[ i ]->IsCartridgeLoaded() )
+        {
+            return false;
+        }
+    }
+
+    Reset();
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::Reset()
+{
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        m_pLanes[ i ]->Reset();
+    }
+
+    m_bGathered         = false;
+    m_u64TotalCycles    = 0;
+    m_u64LockstepCycles = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBJoypad* GBCpuBatch::GetJoypad( uint32 u32Lane ) const
+{
+    return m_pLanes[ u32Lane ]->m_pJoypad;
+}
+
+//----------------------------------------------------------------------------------------------------
+const GBScreenPixel* GBCpuBatch::GetScreenData( uint32 u32Lane ) const
+{
+    return m_pLanes[ u32Lane ]->m_pGpu->GetScreenData();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::RunFrame()
+{
+    PROFILE( "CpuBatch::RunFrame" );
+
+    if( !m_bLockstepEnabled )
+    {
+        for( uint32 i = 0; i < m_u32Lanes; ++i )
+        {
+            m_pLanes[ i ]->Step();
+            m_u64TotalCycles += m_pLanes[ i ]->m_u32LastFrameCycles;
+        }
+        return;
+    }
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        m_iFrameCycles[ i ] = 0;
+    }
+
+    // Each pass runs the lanes up to their next GPU event, together while they agree and one by one
+    // once they don't. Lanes only come back together where their frame progress lines up again.
+    bool bFrameDone = false;
+    while( !bFrameDone )
+    {
+        if( IsConverged() )
+        {
+            RunLockstepWindow();
+        }
+        else
+        {
+            RunScalarWindows();
+        }
+
+        bFrameDone = true;
+        for( uint32 i = 0; i < m_u32Lanes; ++i )
+        {
+            if( m_iFrameCycles[ i ] < GBEmulator::kMaxCyclesPerFrame )
+            {
+                bFrameDone = false;
+                break;
+            }
+        }
+    }
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBEmulator* pLane = m_pLanes[ i ];
+
+        pLane->m_u32LastFrameCycles     = m_iFrameCycles[ i ];
+        pLane->m_dRomCycles            += m_iFrameCycles[ i ];
+        pLane->m_dRomIdleSkippedCycles += pLane->m_pCpu->GetIdleSkippedCycles();
+        pLane->m_pCpu->ResetIdleSkippedCycles();
+
+        m_u64TotalCycles += m_iFrameCycles[ i ];
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsConverged() const
+{
+    const GBCpu* pFirst = m_pLanes[ 0 ]->m_pCpu;
+    if(     m_iFrameCycles[ 0 ] >= GBEmulator::kMaxCyclesPerFrame
+        ||  pFirst->m_State.bHalt
+        ||  pFirst->m_State.bStop )
+    {
+        return false;
+    }
+
+    ubyte u8Bank = m_pLanes[ 0 ]->m_pMem->GetRomBank();
+    for( uint32 i = 1; i < m_u32Lanes; ++i )
+    {
+        const GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+        if(     m_iFrameCycles[ i ] != m_iFrameCycles[ 0 ]
+            ||  pCpu->m_State.u16PC != pFirst->m_State.u16PC
+            ||  pCpu->m_State.bHalt
+            ||  pCpu->m_State.bStop
+            ||  m_pLanes[ i ]->m_pMem->GetRomBank() != u8Bank )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsWindowConverged() const
+{
+    // Same test as IsConverged for lanes part way through a lockstep window
+    const GBCpu* pFirst = m_pLanes[ 0 ]->m_pCpu;
+    if(     pFirst->m_State.bHalt
+        ||  pFirst->m_State.bStop )
+    {
+        return false;
+    }
+
+    ubyte u8Bank = m_pLanes[ 0 ]->m_pMem->GetRomBank();
+    for( uint32 i = 1; i < m_u32Lanes; ++i )
+    {
+        const GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+        if(     m_iWindowCycles[ i ] != m_iWindowCycles[ 0 ]
+            ||  pCpu->m_State.u16PC != pFirst->m_State.u16PC
+            ||  pCpu->m_State.bHalt
+            ||  pCpu->m_State.bStop
+            ||  m_pLanes[ i ]->m_pMem->GetRomBank() != u8Bank )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::GatherLanes()
+{
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+
+        // The kernels work on concrete flags
+        pCpu->MaterializeFlags();
+
+        for( uint32 r = 0; r < 8; ++r )
+        {
+            m_pu8Row[ r ][ i ] = pCpu->m_State.u8Registers[ r ];
+        }
+        m_pu16SP[ i ] = pCpu->m_State.u16SP;
+    }
+
+    m_u16PC             = m_pLanes[ 0 ]->m_pCpu->m_State.u16PC;
+    m_iPendingCycles    = 0;
+    m_bGathered         = true;
+
+    UpdateTimerSlack();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::ScatterLanes()
+{
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+
+        for( uint32 r = 0; r < 8; ++r )
+        {
+            pCpu->m_State.u8Registers[ r ] = m_pu8Row[ r ][ i ];
+        }
+        pCpu->m_State.u8FlagOp  = GBCpu::kFlagOpNone;
+        pCpu->m_State.u16SP     = m_pu16SP[ i ];
+        pCpu->m_State.u16PC     = m_u16PC;
+    }
+
+    m_bGathered = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::UpdateTimerSlack()
+{
+    // Lockstep ops don't touch memory, IME or the interrupt registers, so the only thing that can change
+    // a lane's interrupt state under them is a timer overflow. A request that could already be taken
+    // or a delayed EI leaves no slack at all.
+    m_iTimerSlack = 0x7FFFFFFF;
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+
+        if(     0 != pCpu->m_State.u8EIDelay
+            ||  (   pCpu->m_State.bIME
+                &&  0 != ( pCpu->m_State.u8InterruptEnable & ( pCpu->m_State.u8InterruptFlags | pCpu->m_State.u8InterruptLines ) & GBCpu::kInterruptRequests ) ) )
+        {
+            m_iTimerSlack = 0;
+            return;
+        }
+
+        int iOverflow = pCpu->m_pTimer->GetCyclesUntilOverflow();
+        if( m_iTimerSlack > iOverflow )
+        {
+            m_iTimerSlack = iOverflow;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsLockstepOpNext() const
+{
+    uint16 u16PC = m_pLanes[ 0 ]->m_pCpu->m_State.u16PC;
+
+    return u16PC < 0x8000 && IsLockstepOpcode( m_pLanes[ 0 ]->m_pMem->ReadMemory( u16PC ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::RunLockstepWindow()
+{
+    PROFILE( "CpuBatch::RunLockstepWindow" );
+
+    // Every lane's frame is at the same point, the window ends at the earliest GPU event of any lane
+    int iDeadline = GBEmulator::kMaxCyclesPerFrame - m_iFrameCycles[ 0 ];
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        int iGpuCycles = m_pLanes[ i ]->m_pGpu->GetCyclesToNextEvent();
+        if( iDeadline > iGpuCycles )
+        {
+            iDeadline = iGpuCycles;
+        }
+
+        m_iWindowCycles[ i ] = 0;
+    }
+
+    // The registers are only gathered when the next op can run in lockstep, runs of memory ops stay
+    // on the lanes
+    if( IsLockstepOpNext() )
+    {
+        GatherLanes();
+    }
+
+    // Single stepping the lanes costs them their idle loop skipping, once lockstep
+    // stops paying off the rest of the window runs on the lanes
+    uint32  u32ScalarOps    = 0;
+    bool    bConverged      = true;
+    while(      bConverged
+            &&  u32ScalarOps < kCpuBatchMaxScalarOps
+            &&  m_iWindowCycles[ 0 ] + m_iPendingCycles < iDeadline )
+    {
+        int iCycles = m_bGathered ? ExecuteLockstepOp() : 0;
+        if( iCycles > 0 )
+        {
+            m_u64LockstepCycles += static_cast<uint64>( iCycles ) * m_u32Lanes;
+            u32ScalarOps         = 0;
+
+            // The lanes only have to see the cycles once a timer could overflow
+            m_iPendingCycles += iCycles;
+            if(     m_iPendingCycles < m_iTimerSlack
+                ||  FlushLockstepCycles() )
+            {
+                continue;
+            }
+        }
+        else if(    !m_bGathered
+                ||  FlushLockstepCycles() )
+        {
+            // Anything the kernels can't run goes through each lane's own CPU
+            if( m_bGathered )
+            {
+                ScatterLanes();
+            }
+
+            for( uint32 i = 0; i < m_u32Lanes; ++i )
+            {
+                m_iWindowCycles[ i ] += m_pLanes[ i ]->m_pCpu->RunUntil( 1 );
+            }
+            ++u32ScalarOps;
+
+            // A lane that wrote I/O has to let the other modules catch up before it goes on
+            for( uint32 i = 0; i < m_u32Lanes; ++i )
+            {
+                if( m_pLanes[ i ]->m_pCpu->m_bYield )
+                {
+                    iDeadline = 0;
+                    break;
+                }
+            }
+        }
+
+        bConverged = IsWindowConverged();
+        if(     bConverged
+            &&  IsLockstepOpNext() )
+        {
+            GatherLanes();
+        }
+    }
+
+    if( m_bGathered )
+    {
+        if( 0 != m_iPendingCycles )
+        {
+            FlushLockstepCycles();
+        }
+
+        if( m_bGathered )
+        {
+            ScatterLanes();
+        }
+    }
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBEmulator* pLane = m_pLanes[ i ];
+
+        if( m_iWindowCycles[ i ] < iDeadline )
+        {
+            m_iWindowCycles[ i ] += pLane->m_pCpu->RunUntil( iDeadline - m_iWindowCycles[ i ] );
+        }
+
+        pLane->m_pGpu->Update( m_iWindowCycles[ i ] );
+        m_iFrameCycles[ i ] += m_iWindowCycles[ i ];
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::FlushLockstepCycles()
+{
+    // Hands the cycles run since the last flush to every lane and does the tail of RunUntil for them.
+    // Returns false once the registers had to be handed back to the lanes to take an interrupt.
+    bool bInterrupt = false;
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+
+        pCpu->m_pTimer->Update( m_iPendingCycles );
+        m_iWindowCycles[ i ] += m_iPendingCycles;
+
+        // Lanes in lockstep are never halted, so a request only does something with IME set
+        if(     0 != ( pCpu->m_State.u8InterruptPending & GBCpu::kInterruptEIDelay )
+            ||  (   pCpu->m_State.bIME
+                &&  0 != pCpu->m_State.u8InterruptPending ) )
+        {
+            bInterrupt = true;
+        }
+    }
+
+    m_iPendingCycles = 0;
+
+    if( bInterrupt )
+    {
+        ScatterLanes();
+    }
+
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        GBCpu* pCpu = m_pLanes[ i ]->m_pCpu;
+
+        if(     bInterrupt
+            &&  0 != pCpu->m_State.u8InterruptPending )
+        {
+            m_iWindowCycles[ i ] += pCpu->HandleInterrupts();
+        }
+
+        if( 0 != ( pCpu->m_State.u8InterruptLines & ~pCpu->m_State.u8InterruptFlags ) )
+        {
+            pCpu->m_State.u8InterruptFlags |= pCpu->m_State.u8InterruptLines;
+            pCpu->UpdateInterruptPending();
+        }
+    }
+
+    if( !bInterrupt )
+    {
+        UpdateTimerSlack();
+    }
+
+    return !bInterrupt;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::RunScalarWindows()
+{
+    PROFILE( "CpuBatch::RunScalarWindows" );
+
+    // One Step window for every lane that still has frame left
+    for( uint32 i = 0; i < m_u32Lanes; ++i )
+    {
+        if( m_iFrameCycles[ i ] >= GBEmulator::kMaxCyclesPerFrame )
+        {
+            continue;
+        }
+
+        GBEmulator* pLane = m_pLanes[ i ];
+
+        int iDeadline = pLane->m_pGpu->GetCyclesToNextEvent();
+        if( iDeadline > GBEmulator::kMaxCyclesPerFrame - m_iFrameCycles[ i ] )
+        {
+            iDeadline = GBEmulator::kMaxCyclesPerFrame - m_iFrameCycles[ i ];
+        }
+
+        int iCycles = pLane->m_pCpu->RunUntil( iDeadline );
+        pLane->m_pGpu->Update( iCycles );
+        m_iFrameCycles[ i ] += iCycles;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsConditionUniform( ubyte u8Condition, bool& bTaken ) const
+{
+    // NZ, Z, NC, C
+    ubyte   u8Flag  = ( u8Condition < 2 ) ? GBCpu::ZF : GBCpu::CF;
+    ubyte   u8First = m_pu8Row[ GBCpu::F ][ 0 ] & u8Flag;
+
+    for( uint32 i = 1; i < m_u32Lanes; ++i )
+    {
+        if( ( m_pu8Row[ GBCpu::F ][ i ] & u8Flag ) != u8First )
+        {
+            return false;
+        }
+    }
+
+    bTaken = ( 0 != u8First ) == ( 0 != ( u8Condition & 1 ) );
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsLockstepOpcode( ubyte u8Opcode )
+{
+    // Register only ops and jumps, 6 is the (HL) operand
+    ubyte u8Dst = ( u8Opcode >> 3 ) & 7;
+    ubyte u8Src = u8Opcode & 7;
+
+    if( u8Opcode >= 0x40 && u8Opcode < 0x80 )
+    {
+        return 6 != u8Dst && 6 != u8Src;                // LD r,r', also rules out HALT
+    }
+
+    if( u8Opcode >= 0x80 && u8Opcode < 0xC0 )
+    {
+        return 6 != u8Src;                              // ALU A,r
+    }
+
+    if(     0x04 == ( u8Opcode & 0xC6 )                 // INC r, DEC r
+        ||  0x06 == ( u8Opcode & 0xC7 ) )               // LD r,n
+    {
+        return 6 != u8Dst;
+    }
+
+    if(     0x01 == ( u8Opcode & 0xCF )                 // LD rr,nn
+        ||  0x03 == ( u8Opcode & 0xC7 )                 // INC rr, DEC rr
+        ||  0xC6 == ( u8Opcode & 0xC7 ) )               // ALU A,n
+    {
+        return true;
+    }
+
+    switch( u8Opcode )
+    {
+        case 0x00:  // NOP
+        case 0x2F:  // CPL
+        case 0x37:  // SCF
+        case 0x3F:  // CCF
+        case 0x18:  // JR e
+        case 0x20:  // JR cc,e
+        case 0x28:
+        case 0x30:
+        case 0x38:
+        case 0xC2:  // JP cc,nn
+        case 0xC3:  // JP nn
+        case 0xCA:
+        case 0xD2:
+        case 0xDA:
+            return true;
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+int GBCpuBatch::ExecuteLockstepOp()
+{
+    // Only ROM is sure to hold the same code in every lane, all lanes have the same bank mapped
+    if( m_u16PC >= 0x8000 )
+    {
+        return 0;
+    }
+
+    GBMem*  pMem        = m_pLanes[ 0 ]->m_pMem;
+    ubyte   u8Opcode    = pMem->ReadMemory( m_u16PC );
+    if( !IsLockstepOpcode( u8Opcode ) )
+    {
+        return 0;
+    }
+
+    // Register rows in opcode order, (HL) has no row
+    static const ubyte kRegisterRow[ 8 ] = { GBCpu::B, GBCpu::C, GBCpu::D, GBCpu::E, GBCpu::H, GBCpu::L, 0xFF, GBCpu::A };
+
+    // Low and high rows of BC, DE and HL
+    static const ubyte kPairRow[ 3 ][ 2 ] = { { GBCpu::C, GBCpu::B }, { GBCpu::E, GBCpu::D }, { GBCpu::L, GBCpu::H } };
+
+    const GBCpu::OpcodeInfo&    oInfo       = GBCpu::OPCODE_INFO[ u8Opcode ];
+    ubyte                       u8Dst       = kRegisterRow[ ( u8Opcode >> 3 ) & 7 ];
+    ubyte                       u8Src       = kRegisterRow[ u8Opcode & 7 ];
+    ubyte*                      pu8A        = m_pu8Row[ GBCpu::A ];
+    ubyte*                      pu8F        = m_pu8Row[ GBCpu::F ];
+    uint16                      u16NextPC   = m_u16PC + oInfo.u8Length;
+    int                         iCycles     = oInfo.u8Cycles;
+    uint32                      u32Pair     = ( u8Opcode >> 4 ) & 3;
+
+    if( u8Opcode >= 0x40 && u8Opcode < 0x80 )
+    {
+        // LD r,r'
+        if( u8Dst != u8Src )
+        {
+            memcpy( m_pu8Row[ u8Dst ], m_pu8Row[ u8Src ], m_u32Stride );
+        }
+    }
+    else if( u8Opcode >= 0x80 && u8Opcode < 0xC0 )
+    {
+        // ALU A,r
+        m_pfnAlu( ( u8Opcode >> 3 ) & 7, pu8A, pu8F, m_pu8Row[ u8Src ], m_u32Stride );
+    }
+    else if( 0xC6 == ( u8Opcode & 0xC7 ) )
+    {
+        // ALU A,n
+        memset( m_pu8Immediate, pMem->ReadMemory( m_u16PC + 1 ), m_u32Stride );
+        m_pfnAlu( ( u8Opcode >> 3 ) & 7, pu8A, pu8F, m_pu8Immediate, m_u32Stride );
+    }
+    else if( 0x04 == ( u8Opcode & 0xC6 ) )
+    {
+        // INC r, DEC r
+        m_pfnIncDec( 0 != ( u8Opcode & 1 ), m_pu8Row[ u8Dst ], pu8F, m_u32Stride );
+    }
+    else if( 0x06 == ( u8Opcode & 0xC7 ) )
+    {
+        // LD r,n
+        memset( m_pu8Row[ u8Dst ], pMem->ReadMemory( m_u16PC + 1 ), m_u32Stride );
+    }
+    else if( 0x01 == ( u8Opcode & 0xCF ) )
+    {
+        // LD rr,nn
+        ubyte u8Low     = pMem->ReadMemory( m_u16PC + 1 );
+        ubyte u8High    = pMem->ReadMemory( m_u16PC + 2 );
+
+        if( 3 == u32Pair )
+        {
+            uint16 u16Value = ( u8High << 8 ) | u8Low;
+            for( uint32 i = 0; i < m_u32Stride; ++i )
+            {
+                m_pu16SP[ i ] = u16Value;
+            }
+        }
+        else
+        {
+            memset( m_pu8Row[ kPairRow[ u32Pair ][ 0 ] ], u8Low, m_u32Stride );
+            memset( m_pu8Row[ kPairRow[ u32Pair ][ 1 ] ], u8High, m_u32Stride );
+        }
+    }
+    else if( 0x03 == ( u8Opcode & 0xC7 ) )
+    {
+        // INC rr, DEC rr, no flags
+        int iDelta = ( 0 != ( u8Opcode & 0x08 ) ) ? -1 : 1;
+
+        if( 3 == u32Pair )
+        {
+            for( uint32 i = 0; i < m_u32Stride; ++i )
+            {
+                m_pu16SP[ i ] += iDelta;
+            }
+        }
+        else
+        {
+            ubyte* pu8Low   = m_pu8Row[ kPairRow[ u32Pair ][ 0 ] ];
+            ubyte* pu8High  = m_pu8Row[ kPairRow[ u32Pair ][ 1 ] ];
+
+            if( iDelta > 0 )
+            {
+                for( uint32 i = 0; i < m_u32Stride; ++i )
+                {
+                    ++pu8Low[ i ];
+                    pu8High[ i ] += ( 0 == pu8Low[ i ] );
+                }
+            }
+            else
+            {
+                for( uint32 i = 0; i < m_u32Stride; ++i )
+                {
+                    pu8High[ i ] -= ( 0 == pu8Low[ i ] );
+                    --pu8Low[ i ];
+                }
+            }
+        }
+    }
+    else
+    {
+        bool bTaken = true;
+
+        switch( u8Opcode )
+        {
+            case 0x00:  // NOP
+                break;
+
+            case 0x2F:  // CPL
+                for( uint32 i = 0; i < m_u32Stride; ++i )
+                {
+                    pu8A[ i ] ^= 0xFF;
+                    pu8F[ i ]  = ( pu8F[ i ] & ( GBCpu::ZF | GBCpu::CF ) ) | GBCpu::NF | GBCpu::HF;
+                }
+                break;
+
+            case 0x37:  // SCF
+                for( uint32 i = 0; i < m_u32Stride; ++i )
+                {
+                    pu8F[ i ] = ( pu8F[ i ] & GBCpu::ZF ) | GBCpu::CF;
+                }
+                break;
+
+            case 0x3F:  // CCF
+                for( uint32 i = 0; i < m_u32Stride; ++i )
+                {
+                    pu8F[ i ] = ( pu8F[ i ] & GBCpu::ZF ) | ( ( pu8F[ i ] & GBCpu::CF ) ^ GBCpu::CF );
+                }
+                break;
+
+            case 0x20:  // JR cc,e
+            case 0x28:
+            case 0x30:
+            case 0x38:
+                if( !IsConditionUniform( ( u8Opcode >> 3 ) & 3, bTaken ) )
+                {
+                    return 0;
+                }
+                // Intentional fall-through
+            case 0x18:  // JR e
+                if( bTaken )
+                {
+                    u16NextPC  += static_cast<sbyte>( pMem->ReadMemory( m_u16PC + 1 ) );
+                    iCycles     = oInfo.u8TakenCycles;
+                }
+                break;
+
+            case 0xC2:  // JP cc,nn
+            case 0xCA:
+            case 0xD2:
+            case 0xDA:
+                if( !IsConditionUniform( ( u8Opcode >> 3 ) & 3, bTaken ) )
+                {
+                    return 0;
+                }
+                // Intentional fall-through
+            case 0xC3:  // JP nn
+                if( bTaken )
+                {
+                    u16NextPC   = pMem->ReadMemory( m_u16PC + 1 ) | ( pMem->ReadMemory( m_u16PC + 2 ) << 8 );
+                    iCycles     = oInfo.u8TakenCycles;
+                }
+                break;
+        }
+    }
+
+    m_u16PC = u16NextPC;
+
+    return iCycles;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::AluScalar( uint32 u32Op, ubyte* pu8A, ubyte* pu8F, const ubyte* pu8Value, uint32 u32Count )
+{
+    for( uint32 i = 0; i < u32Count; ++i )
+    {
+        uint32  a       = pu8A[ i ];
+        uint32  v       = pu8Value[ i ];
+        uint32  c       = ( 0 != ( pu8F[ i ] & GBCpu::CF ) ) ? 1 : 0;
+        uint32  r       = 0;
+        ubyte   u8Flags = 0;
+
+        switch( u32Op )
+        {
+            case 0: r = a + v;      break;                      // ADD
+            case 1: r = a + v + c;  break;                      // ADC
+            case 2:                                             // SUB
+            case 7: r = a - v;      u8Flags = GBCpu::NF; break; // CP
+            case 3: r = a - v - c;  u8Flags = GBCpu::NF; break; // SBC
+            case 4: r = a & v;      u8Flags = GBCpu::HF; break; // AND
+            case 5: r = a ^ v;      break;                      // XOR
+            case 6: r = a | v;      break;                      // OR
+        }
+
+        if( u32Op < 4 || 7 == u32Op )
+        {
+            // Borrows wrap the 32 bit result, so bit 8 up is the carry either way
+            u8Flags |= ( 0 != ( ( a ^ v ^ r ) & 0x10 ) ) ? GBCpu::HF : 0;
+            u8Flags |= ( r > 0xFF ) ? GBCpu::CF : 0;
+        }
+
+        u8Flags |= ( 0 == ( r & 0xFF ) ) ? GBCpu::ZF : 0;
+
+        pu8F[ i ] = u8Flags;
+        if( 7 != u32Op )
+        {
+            pu8A[ i ] = static_cast<ubyte>( r );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+CPU_BATCH_AVX2 void GBCpuBatch::AluAvx2( uint32 u32Op, ubyte* pu8A, ubyte* pu8F, const ubyte* pu8Value, uint32 u32Count )
+{
+    const __m256i kOnes     = _mm256_set1_epi8( -1 );
+    const __m256i kZero     = _mm256_setzero_si256();
+    const __m256i kHalf     = _mm256_set1_epi8( 0x10 );
+    const __m256i kZF       = _mm256_set1_epi8( static_cast<char>( GBCpu::ZF ) );
+    const __m256i kNF       = _mm256_set1_epi8( GBCpu::NF );
+    const __m256i kHF       = _mm256_set1_epi8( GBCpu::HF );
+    const __m256i kCF       = _mm256_set1_epi8( GBCpu::CF );
+
+    for( uint32 i = 0; i < u32Count; i += kCpuBatchLaneAlignment )
+    {
+        __m256i a       = _mm256_load_si256( reinterpret_cast<const __m256i*>( pu8A + i ) );
+        __m256i v       = _mm256_load_si256( reinterpret_cast<const __m256i*>( pu8Value + i ) );
+        __m256i f       = _mm256_load_si256( reinterpret_cast<const __m256i*>( pu8F + i ) );
+        __m256i cin     = _mm256_cmpeq_epi8( _mm256_and_si256( f, kCF ), kCF );     // All ones where carry is set
+        __m256i r;
+        __m256i carry   = kZero;
+        __m256i flags   = kZero;
+        bool    bArith  = true;
+
+        switch( u32Op )
+        {
+            case 0:     // ADD, the sum saturates exactly when it carries
+                r       = _mm256_add_epi8( a, v );
+                carry   = _mm256_xor_si256( _mm256_cmpeq_epi8( _mm256_adds_epu8( a, v ), r ), kOnes );
+                break;
+
+            case 1:     // ADC, subtracting the all ones mask adds the carry
+            {
+                __m256i s = _mm256_add_epi8( a, v );
+                r       = _mm256_sub_epi8( s, cin );
+                carry   = _mm256_xor_si256( _mm256_cmpeq_epi8( _mm256_adds_epu8( a, v ), s ), kOnes );
+                carry   = _mm256_or_si256( carry, _mm256_and_si256( cin, _mm256_cmpeq_epi8( s, kOnes ) ) );
+                break;
+            }
+
+            case 2:     // SUB and CP borrow when v > a
+            case 7:
+                r       = _mm256_sub_epi8( a, v );
+                carry   = _mm256_xor_si256( _mm256_cmpeq_epi8( _mm256_max_epu8( a, v ), a ), kOnes );
+                flags   = kNF;
+                break;
+
+            case 3:     // SBC
+                r       = _mm256_add_epi8( _mm256_sub_epi8( a, v ), cin );
+                carry   = _mm256_xor_si256( _mm256_cmpeq_epi8( _mm256_max_epu8( a, v ), a ), kOnes );
+                carry   = _mm256_or_si256( carry, _mm256_and_si256( cin, _mm256_cmpeq_epi8( a, v ) ) );
+                flags   = kNF;
+                break;
+
+            case 4:
+                r       = _mm256_and_si256( a, v );
+                flags   = kHF;
+                bArith  = false;
+                break;
+
+            case 5:
+                r       = _mm256_xor_si256( a, v );
+                bArith  = false;
+                break;
+
+            default:
+                r       = _mm256_or_si256( a, v );
+                bArith  = false;
+                break;
+        }
+
+        if( bArith )
+        {
+            // Bit 4 of a^v^r is the carry out of the low nibble, doubled it lands on HF
+            __m256i half = _mm256_and_si256( _mm256_xor_si256( _mm256_xor_si256( a, v ), r ), kHalf );
+            flags = _mm256_or_si256( flags, _mm256_add_epi8( half, half ) );
+            flags = _mm256_or_si256( flags, _mm256_and_si256( carry, kCF ) );
+        }
+
+        flags = _mm256_or_si256( flags, _mm256_and_si256( _mm256_cmpeq_epi8( r, kZero ), kZF ) );
+
+        _mm256_store_si256( reinterpret_cast<__m256i*>( pu8F + i ), flags );
+        if( 7 != u32Op )
+        {
+            _mm256_store_si256( reinterpret_cast<__m256i*>( pu8A + i ), r );
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::IncDecScalar( bool bDec, ubyte* pu8Value, ubyte* pu8F, uint32 u32Count )
+{
+    for( uint32 i = 0; i < u32Count; ++i )
+    {
+        ubyte u8Result  = bDec ? pu8Value[ i ] - 1 : pu8Value[ i ] + 1;
+        ubyte u8Flags   = pu8F[ i ] & GBCpu::CF;
+
+        u8Flags |= bDec ? GBCpu::NF : 0;
+        u8Flags |= ( 0 == u8Result ) ? GBCpu::ZF : 0;
+        u8Flags |= ( ( u8Result & 0xF ) == ( bDec ? 0xF : 0 ) ) ? GBCpu::HF : 0;
+
+        pu8Value[ i ]   = u8Result;
+        pu8F[ i ]       = u8Flags;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+CPU_BATCH_AVX2 void GBCpuBatch::IncDecAvx2( bool bDec, ubyte* pu8Value, ubyte* pu8F, uint32 u32Count )
+{
+    const __m256i kOne      = _mm256_set1_epi8( 1 );
+    const __m256i kZero     = _mm256_setzero_si256();
+    const __m256i kNibble   = _mm256_set1_epi8( 0x0F );
+    const __m256i kHalf     = bDec ? kNibble : kZero;     // Low nibble after a half carry or borrow
+    const __m256i kZF       = _mm256_set1_epi8( static_cast<char>( GBCpu::ZF ) );
+    const __m256i kHF       = _mm256_set1_epi8( GBCpu::HF );
+    const __m256i kCF       = _mm256_set1_epi8( GBCpu::CF );
+    const __m256i kN        = bDec ? _mm256_set1_epi8( GBCpu::NF ) : kZero;
+
+    for( uint32 i = 0; i < u32Count; i += kCpuBatchLaneAlignment )
+    {
+        __m256i v = _mm256_load_si256( reinterpret_cast<const __m256i*>( pu8Value + i ) );
+        __m256i f = _mm256_load_si256( reinterpret_cast<const __m256i*>( pu8F + i ) );
+        __m256i r = bDec ? _mm256_sub_epi8( v, kOne ) : _mm256_add_epi8( v, kOne );
+
+        f = _mm256_or_si256( _mm256_and_si256( f, kCF ), kN );
+        f = _mm256_or_si256( f, _mm256_and_si256( _mm256_cmpeq_epi8( r, kZero ), kZF ) );
+        f = _mm256_or_si256( f, _mm256_and_si256( _mm256_cmpeq_epi8( _mm256_and_si256( r, kNibble ), kHalf ), kHF ) );
+
+        _mm256_store_si256( reinterpret_cast<__m256i*>( pu8Value + i ), r );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( pu8F + i ), f );
+    }
+
+    _mm256_zeroupper();
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuBatch::IsAvx2Supported()
+{
+#if defined( _MSC_VER )
+    int iInfo[ 4 ];
+
+    __cpuid( iInfo, 0 );
+    if( iInfo[ 0 ] < 7 )
+    {
+        return false;
+    }
+
+    // AVX and OSXSAVE, then the OS has to be saving the YMM registers
+    __cpuid( iInfo, 1 );
+    if(     0 == ( iInfo[ 2 ] & ( 1 << 27 ) )
+        ||  0 == ( iInfo[ 2 ] & ( 1 << 28 ) )
+        ||  6 != ( _xgetbv( 0 ) & 6 ) )
+    {
+        return false;
+    }
+
+    __cpuidex( iInfo, 7, 0 );
+    return 0 != ( iInfo[ 1 ] & ( 1 << 5 ) );
+#else
+    return 0 != __builtin_cpu_supports( "avx2" );
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBatch::RunBenchmark( const char* szFilepath, uint32 u32Lanes, uint32 u32Frames )
+{
+    float   fTime[ 2 ];
+    uint64  u64Cycles[ 2 ];
+    uint64  u64LockstepCycles = 0;
+
+    GBCpuBatch* pBatch = new GBCpuBatch( u32Lanes );
+    if( !pBatch->LoadCartridge( szFilepath ) )
+    {
+        delete pBatch;
+        return;
+    }
+
+    // Every lane runs the same game, so they should all be sharing a single image
+    Log()->Write( LOG_COLOR_WHITE, "Cpu batch: %u lanes share %u ROM image(s), %u KB",
+                  u32Lanes,
+                  RomCache()->GetImageCount(),
+                  static_cast<uint32>( RomCache()->GetImageBytes() / 1024 ) );
+    pBatch->m_pLanes[ 0 ]->LogFootprint();
+
+    // Lockstep first, then the same run with every lane stepped on its own
+    for( uint32 u32Pass = 0; u32Pass < 2; ++u32Pass )
+    {
+        LARGE_INTEGER oTicksPerSecond;
+        LARGE_INTEGER oStartTime;
+        LARGE_INTEGER oEndTime;
+
+        pBatch->Reset();
+        pBatch->SetLockstepEnabled( 0 == u32Pass );
+
+        QueryPerformanceFrequency( &oTicksPerSecond );
+        QueryPerformanceCounter( &oStartTime );
+
+        for( uint32 u32Frame = 0; u32Frame < u32Frames; ++u32Frame )
+        {
+            // Lanes press Start on a few different frames so they don't all play the same game
+            for( uint32 i = 0; i < pBatch->GetLaneCount(); ++i )
+            {
+                uint32 u32Press = 60 + ( i % 4 ) * 10;
+                if( u32Frame == u32Press )
+                {
+                    pBatch->GetJoypad( i )->SimulateKeyDown( ButtonStart );
+                }
+                else if( u32Frame == u32Press + 5 )
+                {
+                    pBatch->GetJoypad( i )->SimulateKeyUp( ButtonStart );
+                }
+            }
+
+            pBatch->RunFrame();
+        }
+
+        QueryPerformanceCounter( &oEndTime );
+
+        fTime[ u32Pass ]        = static_cast< float >( oEndTime.QuadPart - oStartTime.QuadPart ) / oTicksPerSecond.QuadPart;
+        u64Cycles[ u32Pass ]    = pBatch->GetTotalCycles();
+        if( 0 == u32Pass )
+        {
+            u64LockstepCycles = pBatch->GetLockstepCycles();
+        }
+    }
+
+    delete pBatch;
+
+    // Cycles per microsecond summed over the lanes is the emulated clock in MHz
+    Log()->Write( LOG_COLOR_WHITE, "Cpu batch benchmark (%u lanes, %u frames, AVX2 %s): lockstep %.2f MHz (%.1f%% of cycles in lockstep), independent %.2f MHz",
+                  u32Lanes,
+                  u32Frames,
+                  IsAvx2Supported() ? "on" : "off",
+                  u64Cycles[ 0 ] / ( fTime[ 0 ] * 1000000.f ),
+                  ( 0 != u64Cycles[ 0 ] ) ? 100.0 * u64LockstepCycles / u64Cycles[ 0 ] : 0.0,
+                  u64Cycles[ 1 ] / ( fTime[ 1 ] * 1000000.f ) );
+}
@@ -0,0 +1,128 @@
+#ifndef GBEMU_GBCPUBATCH_H
+#define GBEMU_GBCPUBATCH_H
+
+//====================================================================================================
+// Filename:    GBCpuBatch.h
+// Created by:  Jeff Padgham
+// Description: Runs many copies of one cartridge on a single core. Each lane is a headless emulator
+//              with its own memory and peripherals. While the lanes sit at the same PC their registers
+//              are kept side by side (a structure of arrays) and register-only instructions are run for
+//              every lane at once, with AVX2 when the host has it. Anything else, or lanes that part
+//              ways, run on each lane's own CPU.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+#include "GBGpu.h"
+
+//====================================================================================================
+// Foward Declarations
+//====================================================================================================
+
+class GBEmulator;
+class GBJoypad;
+
+//====================================================================================================
+// Global enums
+//====================================================================================================
+enum
+{
+    kCpuBatchLaneAlignment  = 32,           // One AVX2 register of lanes
+    kCpuBatchMaxLanes       = 1024,
+    kCpuBatchMaxScalarOps   = 4             // Ops in a row the lanes single step before a lockstep window gives up
+};
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBCpuBatch
+{
+public:
+    // Constructor / destructor
+    GBCpuBatch( uint32 u32Lanes );
+    ~GBCpuBatch();
+
+    bool                LoadCartridge( const char* szFilepath );
+    void                Reset();
+
+    // Runs one frame on every lane
+    void                RunFrame();
+
+    inline uint32       GetLaneCount() const                        { return m_u32Lanes;                }
+    GBJoypad*           GetJoypad( uint32 u32Lane ) const;
+    const GBScreenPixel* GetScreenData( uint32 u32Lane ) const;
+
+    // With lockstep off every lane is stepped on its own, like that many separate emulators
+    inline void         SetLockstepEnabled( bool bEnabled )         { m_bLockstepEnabled = bEnabled;    }
+
+    // Emulated cycles summed over all lanes, and the part of them that ran in lockstep
+    inline uint64       GetTotalCycles() const                      { return m_u64TotalCycles;          }
+    inline uint64       GetLockstepCycles() const                   { return m_u64LockstepCycles;       }
+
+    static bool         IsAvx2Supported();
+
+    // Runs the cartridge on u32Lanes lanes in lockstep and as independent emulators and logs the
+    // emulated clock of both
+    static void         RunBenchmark( const char* szFilepath, uint32 u32Lanes, uint32 u32Frames );
+
+private:
+    // Lockstep kernels, u32Count is a whole number of vectors
+    typedef void (*AluKernel)( uint32 u32Op, ubyte* pu8A, ubyte* pu8F, const ubyte* pu8Value, uint32 u32Count );
+    typedef void (*IncDecKernel)( bool bDec, ubyte* pu8Value, ubyte* pu8F, uint32 u32Count );
+
+    static void         AluScalar( uint32 u32Op, ubyte* pu8A, ubyte* pu8F, const ubyte* pu8Value, uint32 u32Count );
+    static void         AluAvx2( uint32 u32Op, ubyte* pu8A, ubyte* pu8F, const ubyte* pu8Value, uint32 u32Count );
+    static void         IncDecScalar( bool bDec, ubyte* pu8Value, ubyte* pu8F, uint32 u32Count );
+    static void         IncDecAvx2( bool bDec, ubyte* pu8Value, ubyte* pu8F, uint32 u32Count );
+
+    static bool         IsLockstepOpcode( ubyte u8Opcode );
+
+    bool                IsConverged() const;
+    bool                IsWindowConverged() const;
+    bool                IsLockstepOpNext() const;
+    void                GatherLanes();
+    void                ScatterLanes();
+    void                UpdateTimerSlack();
+
+    void                RunLockstepWindow();
+    void                RunScalarWindows();
+    int                 ExecuteLockstepOp();
+    bool                FlushLockstepCycles();
+    bool                IsConditionUniform( ubyte u8Condition, bool& bTaken ) const;
+
+private:
+    GBEmulator*         m_pLanes[ kCpuBatchMaxLanes ];
+    uint32              m_u32Lanes;
+    uint32              m_u32Stride;            // Lane count rounded up to a whole vector
+
+    // Structure of arrays register file, one row of m_u32Stride lanes per register. Only valid while
+    // m_bGathered is set, otherwise each lane's CPU holds its own registers.
+    ubyte*              m_pu8Registers;
+    ubyte*              m_pu8Row[ 8 ];
+    uint16*             m_pu16SP;
+    ubyte*              m_pu8Immediate;         // Immediate operand repeated for every lane
+    uint16              m_u16PC;
+    bool                m_bGathered;
+
+    // Lockstep cycles the lanes haven't been told about yet, they are handed over before any lane's
+    // timer can overflow
+    int                 m_iPendingCycles;
+    int                 m_iTimerSlack;
+
+    // Frame progress of each lane
+    int                 m_iFrameCycles[ kCpuBatchMaxLanes ];
+    int                 m_iWindowCycles[ kCpuBatchMaxLanes ];
+
+    AluKernel           m_pfnAlu;
+    IncDecKernel        m_pfnIncDec;
+
+    bool                m_bLockstepEnabled;
+    uint64              m_u64TotalCycles;
+    uint64              m_u64LockstepCycles;
+};
+
+#endif
@@ -0,0 +1,87 @@
+//====================================================================================================
+// Filename:    GBCpuBenchmark.cpp
+// Created by:  Jeff Padgham
+// Description: Runs a ROM through each CPU interpreter core from the same starting state and reports
+//              the emulated clock speed of each. The ROM runs on its own headless emulator, so the
+//              live game's state and save are never touched.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBCpuBenchmark.h"
+
+#include "GBEmulator.h"
+#include "GBCpu.h"
+#include "GBGpu.h"
+#include "CLog.h"
+
+#include <windows.h>
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+GBCpuBenchmark::GBCpuBenchmark() :
+    m_pEmulator( new GBEmulator( true ) )
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBenchmark::~GBCpuBenchmark()
+{
+    delete m_pEmulator;
+    m_pEmulator = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBenchmark::Run( const char* szFilepath, uint32 u32Cycles )
+{
+    m_pEmulator->LoadCartridge( szFilepath );
+    if( !m_pEmulator->IsCartridgeLoaded() )
+    {
+        return;
+    }
+
+    float fTableTime    = RunCore<false>( u32Cycles );
+    float fSwitchTime   = RunCore<true>( u32Cycles );
+
+    // Cycles per microsecond is the emulated clock in MHz
+    Log()->Write( LOG_COLOR_WHITE, "Cpu benchmark (%u cycles): table core %.2f MHz, switch core %.2f MHz",
+                  u32Cycles,
+                  u32Cycles / ( fTableTime * 1000000.f ),
+                  u32Cycles / ( fSwitchTime * 1000000.f ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+template<bool SWITCH_CORE>
+float GBCpuBenchmark::RunCore( uint32 u32Cycles )
+{
+    GBCpu*          pCpu                = m_pEmulator->m_pCpu;
+    GBGpu*          pGpu                = m_pEmulator->m_pGpu;
+    uint32          u32ElapsedCycles    = 0;
+    LARGE_INTEGER   oTicksPerSecond;
+    LARGE_INTEGER   oStartTime;
+    LARGE_INTEGER   oEndTime;
+
+    // Every core starts from power on, the reset also throws away blocks decoded by the last core
+    m_pEmulator->Reset();
+
+    // Timed on its own, the global timer drives the live game's frame rate display
+    QueryPerformanceFrequency( &oTicksPerSecond );
+    QueryPerformanceCounter( &oStartTime );
+
+    // Stepped the way GBEmulator::Step does it, so halts are skipped up to the GPU's events
+    while( u32ElapsedCycles < u32Cycles )
+    {
+        int iCycles = pCpu->RunUntilCore<SWITCH_CORE>( pGpu->GetCyclesToNextEvent() );
+        pGpu->Update( iCycles );
+
+        u32ElapsedCycles += iCycles;
+    }
+
+    QueryPerformanceCounter( &oEndTime );
+
+    return static_cast< float >( oEndTime.QuadPart - oStartTime.QuadPart ) / oTicksPerSecond.QuadPart;
+}
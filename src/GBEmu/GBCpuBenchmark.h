@@ -0,0 +1,44 @@
+#ifndef GBEMU_GBCPU_BENCHMARK_H
+#define GBEMU_GBCPU_BENCHMARK_H
+
+//====================================================================================================
+// Filename:    GBCpuBenchmark.h
+// Created by:  Jeff Padgham
+// Description: Runs a ROM through each CPU interpreter core from the same starting state and reports
+//              the emulated clock speed of each. The ROM runs on its own headless emulator, so the
+//              live game's state and save are never touched.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+//====================================================================================================
+// Foward Declarations
+//====================================================================================================
+
+class GBEmulator;
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBCpuBenchmark
+{
+public:
+    // Constructor / destructor
+    GBCpuBenchmark();
+    ~GBCpuBenchmark();
+
+    void    Run( const char* szFilepath, uint32 u32Cycles );
+
+private:
+    template<bool SWITCH_CORE>  float   RunCore( uint32 u32Cycles );
+
+private:
+    GBEmulator*     m_pEmulator;
+};
+
+#endif
@@ -0,0 +1,76 @@
+//====================================================================================================
+// Filename:    GBCpuBlockCache.cpp
+// Created by:  Jeff Padgham
+// Description: Cache of predecoded basic blocks for the CPU. Blocks are keyed by ROM bank and PC so
+//              the interpreter can skip the memory bus when fetching opcodes and immediates.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBCpuBlockCache.h"
+
+#include "emutypes.h"
+
+#include <memory.h>
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBCpuBlockCache::GBCpuBlockCache( void ) :
+    m_pBlocks( NULL )
+{
+    m_pBlocks = new GBCpuBlock[ kCpuBlockCacheSize ];
+
+    Flush();
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBlockCache::~GBCpuBlockCache( void )
+{
+    delete [] m_pBlocks;
+    m_pBlocks = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuBlockCache::Flush()
+{
+    for( uint32 i = 0; i < kCpuBlockCacheSize; ++i )
+    {
+        m_pBlocks[ i ].u32Key       = kCpuBlockInvalidKey;
+        m_pBlocks[ i ].u8OpCount    = 0;
+    }
+
+    memset( m_u32PageGeneration, 0, sizeof( m_u32PageGeneration ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBlock* GBCpuBlockCache::Find( uint32 u32Key )
+{
+    GBCpuBlock* pBlock = &m_pBlocks[ GetSlot( u32Key ) ];
+
+    if(     pBlock->u32Key != u32Key
+        ||  pBlock->u32Generation != m_u32PageGeneration[ pBlock->u16StartPC >> 8 ] )
+    {
+        return NULL;
+    }
+
+    return pBlock;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuBlock* GBCpuBlockCache::Allocate( uint32 u32Key )
+{
+    // Direct mapped, whatever was in the slot gets evicted
+    GBCpuBlock* pBlock = &m_pBlocks[ GetSlot( u32Key ) ];
+
+    pBlock->u32Key          = u32Key;
+    pBlock->u16StartPC      = u32Key & 0xFFFF;
+    pBlock->u32Generation   = m_u32PageGeneration[ pBlock->u16StartPC >> 8 ];
+    pBlock->u32Cycles       = 0;
+    pBlock->u8OpCount       = 0;
+    pBlock->u8IdleLoop      = kCpuBlockIdleUnknown;
+
+    return pBlock;
+}
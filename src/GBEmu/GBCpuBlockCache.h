@@ -0,0 +1,92 @@
+#ifndef GBEMU_GBCPUBLOCKCACHE_H
+#define GBEMU_GBCPUBLOCKCACHE_H
+
+//====================================================================================================
+// Filename:    GBCpuBlockCache.h
+// Created by:  Jeff Padgham
+// Description: Cache of predecoded basic blocks for the CPU. Blocks are keyed by ROM bank and PC so
+//              the interpreter can skip the memory bus when fetching opcodes and immediates.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+#include "GBCpu.h"
+
+//====================================================================================================
+// Global enums
+//====================================================================================================
+enum
+{
+    kCpuBlockMaxOps         = 16,
+#if GB_COMPACT
+    kCpuBlockCacheSize      = 128,      // Must be a power of 2, 1/8 of the blocks runs at most ~10% slower
+#else
+    kCpuBlockCacheSize      = 1024,     // Must be a power of 2
+#endif
+    kCpuBlockInvalidKey     = 0xFFFFFFFF
+};
+
+// Idle loop analysis of a block, done the first time the block is entered
+enum GBCpuBlockIdleLoop
+{
+    kCpuBlockIdleUnknown,
+    kCpuBlockIdleLoop,                  // Branches back to its own start without side effects
+    kCpuBlockNotIdle
+};
+
+//====================================================================================================
+// Global Structs
+//====================================================================================================
+struct GBCpuDecodedOp
+{
+    GBCpu::GBCpuOpcodeHandler   pfnHandler;         // Extended handler for 0xCB opcodes
+    ubyte                       u8Opcode;
+    ubyte                       u8ExtOpcode;
+    ubyte                       u8Operands[ 2 ];
+    ubyte                       u8Length;
+    ubyte                       u8Cycles;           // Cycles when a conditional branch is not taken
+};
+
+struct GBCpuBlock
+{
+    uint32                      u32Key;             // ROM bank << 16 | start PC
+    uint32                      u32Generation;      // Generation of the start page when decoded
+    uint32                      u32Cycles;
+    uint16                      u16StartPC;
+    ubyte                       u8OpCount;
+    ubyte                       u8IdleLoop;         // GBCpuBlockIdleLoop
+    GBCpuDecodedOp              oOps[ kCpuBlockMaxOps ];
+};
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBCpuBlockCache
+{
+public:
+    // Constructor / destructor
+    GBCpuBlockCache( void );
+    ~GBCpuBlockCache( void );
+
+    void                Flush();
+
+    GBCpuBlock*         Find( uint32 u32Key );
+    GBCpuBlock*         Allocate( uint32 u32Key );
+
+    // Blocks decoded from a page before it was written to are stale
+    inline void         InvalidatePage( ubyte u8Page )                  { ++m_u32PageGeneration[ u8Page ];  }
+
+private:
+    inline uint32       GetSlot( uint32 u32Key ) const                  { return ( u32Key ^ ( ( u32Key >> 16 ) * 0x9E5 ) ) & ( kCpuBlockCacheSize - 1 );    }
+
+private:
+    GBCpuBlock*         m_pBlocks;
+    uint32              m_u32PageGeneration[ 256 ];
+};
+
+#endif
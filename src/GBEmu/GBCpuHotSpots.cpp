@@ -0,0 +1,211 @@
+//====================================================================================================
+// Filename:    GBCpuHotSpots.cpp
+// Created by:  Jeff Padgham
+// Description: Guest hot spot counters. Counts the instructions and cycles spent at every bank:PC and
+//              in every opcode so we can see which guest code is worth optimising. The CPU only builds
+//              this in when CPU_HOTSPOTS is set.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBCpuHotSpots.h"
+
+#include "emutypes.h"
+#include "GBCpu.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+//====================================================================================================
+// Local Structs
+//====================================================================================================
+namespace
+{
+    enum HotSpotRowType
+    {
+        kRowAddress,
+        kRowOpcode,
+        kRowExtOpcode
+    };
+
+    struct HotSpotRow
+    {
+        const GBCpuHotSpot* pCounter;
+        uint32              u32Type;
+        uint32              u32Page;
+        uint32              u32Address;
+    };
+
+    // Addresses first and then opcodes, most cycles first within each
+    bool SortRows( const HotSpotRow& oLeft, const HotSpotRow& oRight )
+    {
+        if( ( kRowAddress == oLeft.u32Type ) != ( kRowAddress == oRight.u32Type ) )
+        {
+            return kRowAddress == oLeft.u32Type;
+        }
+
+        return oLeft.pCounter->u64Cycles > oRight.pCounter->u64Cycles;
+    }
+}
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBCpuHotSpots::GBCpuHotSpots()
+{
+    memset( m_pPages, 0, sizeof( m_pPages ) );
+
+    Reset();
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuHotSpots::~GBCpuHotSpots()
+{
+    for( uint32 i = 0; i < kHotSpotPageCount; ++i )
+    {
+        delete [] m_pPages[ i ];
+        m_pPages[ i ] = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuHotSpots::Reset()
+{
+    for( uint32 i = 0; i < kHotSpotPageCount; ++i )
+    {
+        if( NULL != m_pPages[ i ] )
+        {
+            memset( m_pPages[ i ], 0, sizeof( GBCpuHotSpot ) * kHotSpotPageSize );
+        }
+    }
+
+    memset( m_oOpcodes, 0, sizeof( m_oOpcodes ) );
+    memset( m_oExtOpcodes, 0, sizeof( m_oExtOpcodes ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuHotSpots::AllocatePage( uint32 u32Page )
+{
+    m_pPages[ u32Page ] = new GBCpuHotSpot[ kHotSpotPageSize ];
+    memset( m_pPages[ u32Page ], 0, sizeof( GBCpuHotSpot ) * kHotSpotPageSize );
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuHotSpots::WriteReport( const char* szFilepath ) const
+{
+    vector<HotSpotRow> oRows;
+    uint64 u64TotalCycles = 0;
+
+    for( uint32 u32Page = 0; u32Page < kHotSpotPageCount; ++u32Page )
+    {
+        if( NULL == m_pPages[ u32Page ] )
+        {
+            continue;
+        }
+
+        for( uint32 i = 0; i < kHotSpotPageSize; ++i )
+        {
+            if( 0 != m_pPages[ u32Page ][ i ].u64Instructions )
+            {
+                HotSpotRow oRow = { &m_pPages[ u32Page ][ i ], kRowAddress, u32Page, i };
+                oRows.push_back( oRow );
+            }
+        }
+    }
+
+    for( uint32 i = 0; i < 256; ++i )
+    {
+        u64TotalCycles += m_oOpcodes[ i ].u64Cycles + m_oExtOpcodes[ i ].u64Cycles;
+
+        if( 0 != m_oOpcodes[ i ].u64Instructions )
+        {
+            HotSpotRow oRow = { &m_oOpcodes[ i ], kRowOpcode, 0, i };
+            oRows.push_back( oRow );
+        }
+
+        if( 0 != m_oExtOpcodes[ i ].u64Instructions )
+        {
+            HotSpotRow oRow = { &m_oExtOpcodes[ i ], kRowExtOpcode, 0, i };
+            oRows.push_back( oRow );
+        }
+    }
+
+    sort( oRows.begin(), oRows.end(), SortRows );
+
+    FILE* pFile = fopen( szFilepath, "w" );
+    if( NULL == pFile )
+    {
+        return false;
+    }
+
+    fprintf( pFile, "type,bank,address,opcode,mnemonic,instructions,cycles,cycle_percent\n" );
+
+    for( auto it = oRows.begin(); it != oRows.end(); ++it )
+    {
+        const GBCpuHotSpot* pCounter    = it->pCounter;
+        double              dPercent    = ( 0 != u64TotalCycles ) ? 100.0 * pCounter->u64Cycles / u64TotalCycles : 0.0;
+        char                szBank[ 4 ] = "";
+        char                szAddress[ 8 ] = "";
+        uint32              u32Opcode;
+        uint32              u32ExtOpcode;
+
+        if( kRowAddress == it->u32Type )
+        {
+            u32Opcode       = pCounter->u8Opcode;
+            u32ExtOpcode    = pCounter->u8ExtOpcode;
+
+            // Only switchable ROM has a bank, the fixed bank and RAM are printed without one
+            if( 0 == it->u32Page )
+            {
+                sprintf( szAddress, "%04X", it->u32Address );
+            }
+            else if( it->u32Page < kHotSpotRomPage + 256 )
+            {
+                sprintf( szBank, "%02X", it->u32Page - kHotSpotRomPage );
+                sprintf( szAddress, "%04X", 0x4000 + it->u32Address );
+            }
+            else
+            {
+                sprintf( szAddress, "%04X", 0x8000 + ( it->u32Page - kHotSpotRomPage - 256 ) * kHotSpotPageSize + it->u32Address );
+            }
+        }
+        else
+        {
+            u32Opcode       = ( kRowExtOpcode == it->u32Type ) ? 0xCB : it->u32Address;
+            u32ExtOpcode    = it->u32Address;
+        }
+
+        char szOpcode[ 8 ];
+        const char* szMnemonic;
+        if( 0xCB == u32Opcode )
+        {
+            sprintf( szOpcode, "CB%02X", u32ExtOpcode );
+            szMnemonic = GBCpu::EXT_OPCODE_INFO[ u32ExtOpcode ].szMnemonic;
+        }
+        else
+        {
+            sprintf( szOpcode, "%02X", u32Opcode );
+            szMnemonic = GBCpu::OPCODE_INFO[ u32Opcode ].szMnemonic;
+        }
+
+        fprintf( pFile, "%s,%s,%s,%s,\"%s\",%llu,%llu,%.3f\n",
+                 ( kRowAddress == it->u32Type ) ? "address" : "opcode",
+                 szBank,
+                 szAddress,
+                 szOpcode,
+                 szMnemonic,
+                 pCounter->u64Instructions,
+                 pCounter->u64Cycles,
+                 dPercent );
+    }
+
+    fclose( pFile );
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef GBEMU_GBCPUHOTSPOTS_H
+#define GBEMU_GBCPUHOTSPOTS_H
+
+//====================================================================================================
+// Filename:    GBCpuHotSpots.h
+// Created by:  Jeff Padgham
+// Description: Guest hot spot counters. Counts the instructions and cycles spent at every bank:PC and
+//              in every opcode so we can see which guest code is worth optimising. The CPU only builds
+//              this in when CPU_HOTSPOTS is set.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+//====================================================================================================
+// Global enums
+//====================================================================================================
+enum
+{
+    kHotSpotPageSize        = 0x4000,
+    kHotSpotRomPage         = 1,            // First switchable ROM bank page, one per bank
+    kHotSpotPageCount       = kHotSpotRomPage + 256 + 2
+};
+
+//====================================================================================================
+// Global Structs
+//====================================================================================================
+struct GBCpuHotSpot
+{
+    uint64  u64Instructions;
+    uint64  u64Cycles;
+    ubyte   u8Opcode;                       // Last opcode seen at the address, code in RAM can change
+    ubyte   u8ExtOpcode;
+};
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBCpuHotSpots
+{
+public:
+    // Constructor / destructor
+    GBCpuHotSpots();
+    ~GBCpuHotSpots();
+
+    void                Reset();
+
+    // Writes every address and opcode that ran as CSV, most expensive first
+    bool                WriteReport( const char* szFilepath ) const;
+
+    inline void         Record( ubyte u8Bank, uint16 u16PC, ubyte u8Opcode, ubyte u8ExtOpcode, uint32 u32Cycles )
+    {
+        // 0x0000-0x3FFF, then one page per ROM bank for 0x4000-0x7FFF, then 0x8000-0xBFFF and 0xC000-0xFFFF
+        uint32 u32Page = ( u16PC < 0x4000 ) ? 0 : ( u16PC < 0x8000 ) ? kHotSpotRomPage + u8Bank : ( kHotSpotRomPage + 254 ) + ( u16PC >> 14 );
+        if( NULL == m_pPages[ u32Page ] )
+        {
+            AllocatePage( u32Page );
+        }
+
+        GBCpuHotSpot* pAddress  = &m_pPages[ u32Page ][ u16PC & ( kHotSpotPageSize - 1 ) ];
+        GBCpuHotSpot* pOpcode   = ( 0xCB == u8Opcode ) ? &m_oExtOpcodes[ u8ExtOpcode ] : &m_oOpcodes[ u8Opcode ];
+
+        ++pAddress->u64Instructions;
+        pAddress->u64Cycles    += u32Cycles;
+        pAddress->u8Opcode      = u8Opcode;
+        pAddress->u8ExtOpcode   = u8ExtOpcode;
+
+        ++pOpcode->u64Instructions;
+        pOpcode->u64Cycles     += u32Cycles;
+    }
+
+private:
+    void                AllocatePage( uint32 u32Page );
+
+private:
+    // Pages are only allocated once code runs in them, most banks of a big cartridge never hold hot code
+    GBCpuHotSpot*       m_pPages[ kHotSpotPageCount ];
+    GBCpuHotSpot        m_oOpcodes[ 256 ];
+    GBCpuHotSpot        m_oExtOpcodes[ 256 ];
+};
+
+#endif
@@ -0,0 +1,144 @@
+//====================================================================================================
+// Filename:    GBCpuTrace.cpp
+// Created by:  Jeff Padgham
+// Description: Binary instruction trace. The CPU records every instruction into a lock-free ring buffer
+//              and a background thread streams it to a compressed trace file. The CPU only builds this
+//              in when CPU_TRACE is set, the GBTraceDecode tool reads the files back.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBCpuTrace.h"
+
+#include "emutypes.h"
+
+#include "CLog.h"
+
+#include <chrono>
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBCpuTrace::GBCpuTrace() :
+    m_pFile( NULL ),
+    m_pEntries( NULL ),
+    m_pu8Packed( NULL ),
+    m_u32WriteIndex( 0 ),
+    m_u32ReadIndex( 0 ),
+    m_bStopWriter( false )
+{
+    memset( &m_oPrevious, 0, sizeof( m_oPrevious ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+GBCpuTrace::~GBCpuTrace()
+{
+    Close();
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBCpuTrace::Open( const char* szFilepath )
+{
+    Close();
+
+    m_pFile = fopen( szFilepath, "wb" );
+    if( NULL == m_pFile )
+    {
+        Log()->Write( LOG_COLOR_YELLOW, "Unable to open trace file %s", szFilepath );
+        return false;
+    }
+
+    GBCpuTraceFileHeader oHeader;
+    memcpy( oHeader.szMagic, "GBTR", sizeof( oHeader.szMagic ) );
+    oHeader.u32Version      = kCpuTraceVersion;
+    oHeader.u32EntrySize    = sizeof( GBCpuTraceEntry );
+    fwrite( &oHeader, sizeof( oHeader ), 1, m_pFile );
+
+    m_pEntries  = new GBCpuTraceEntry[ kCpuTraceBufferSize ];
+    m_pu8Packed = new ubyte[ kCpuTraceBatchSize * kCpuTraceMaxPackedSize ];
+    memset( &m_oPrevious, 0, sizeof( m_oPrevious ) );
+
+    m_u32WriteIndex = 0;
+    m_u32ReadIndex  = 0;
+    m_bStopWriter   = false;
+    m_oWriter       = std::thread( &GBCpuTrace::WriterThread, this );
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuTrace::Close()
+{
+    if( NULL == m_pFile )
+    {
+        return;
+    }
+
+    // The writer drains whatever is left in the buffer before it exits
+    m_bStopWriter = true;
+    m_oWriter.join();
+
+    fclose( m_pFile );
+    m_pFile = NULL;
+
+    delete [] m_pEntries;
+    m_pEntries = NULL;
+
+    delete [] m_pu8Packed;
+    m_pu8Packed = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuTrace::WriterThread()
+{
+    for( ;; )
+    {
+        // Read the stop flag first so the entries recorded before it was set all get written
+        bool    bStop   = m_bStopWriter.load( std::memory_order_acquire );
+        uint32  u32Read = m_u32ReadIndex.load( std::memory_order_relaxed );
+        uint32  u32End  = m_u32WriteIndex.load( std::memory_order_acquire );
+
+        if( u32Read != u32End )
+        {
+            WriteEntries( u32Read, u32End );
+        }
+        else if( bStop )
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+    }
+
+    fflush( m_pFile );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuTrace::WriteEntries( uint32 u32Read, uint32 u32End )
+{
+    while( u32Read != u32End )
+    {
+        uint32 u32Count = u32End - u32Read;
+        if( u32Count > kCpuTraceBatchSize )
+        {
+            u32Count = kCpuTraceBatchSize;
+        }
+
+        uint32 u32Size = 0;
+        for( uint32 i = 0; i < u32Count; ++i )
+        {
+            const GBCpuTraceEntry* pEntry = &m_pEntries[ ( u32Read + i ) & ( kCpuTraceBufferSize - 1 ) ];
+            u32Size += GBCpuTracePack( pEntry, &m_oPrevious, m_pu8Packed + u32Size );
+        }
+
+        // The slots can be reused as soon as they're packed, the file write doesn't hold up the CPU
+        u32Read += u32Count;
+        m_u32ReadIndex.store( u32Read, std::memory_order_release );
+
+        fwrite( m_pu8Packed, 1, u32Size, m_pFile );
+    }
+}
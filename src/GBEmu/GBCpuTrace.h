@@ -0,0 +1,175 @@
+#ifndef GBEMU_GBCPUTRACE_H
+#define GBEMU_GBCPUTRACE_H
+
+//====================================================================================================
+// Filename:    GBCpuTrace.h
+// Created by:  Jeff Padgham
+// Description: Binary instruction trace. The CPU records every instruction into a lock-free ring buffer
+//              and a background thread streams it to a compressed trace file. The CPU only builds this
+//              in when CPU_TRACE is set, the GBTraceDecode tool reads the files back.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+//====================================================================================================
+// Global enums
+//====================================================================================================
+enum
+{
+    kCpuTraceBufferSize     = 1 << 16,      // Entries, must be a power of 2
+    kCpuTraceBatchSize      = 4096,         // Entries the writer compresses per fwrite
+    kCpuTraceVersion        = 1
+};
+
+enum GBCpuTraceState
+{
+    kCpuTraceIME            = 1 << 0,
+    kCpuTraceHalt           = 1 << 1,
+    kCpuTraceStop           = 1 << 2
+};
+
+//====================================================================================================
+// Global Structs
+//====================================================================================================
+#pragma pack( push, 1 )
+
+// One instruction, with the state as it was before it ran
+struct GBCpuTraceEntry
+{
+    uint64  u64Cycle;                       // Timer cycles since reset
+    uint16  u16PC;
+    uint16  u16SP;
+    ubyte   u8Registers[ 8 ];               // F, A, C, B, E, D, L, H
+    ubyte   u8Bank;                         // ROM bank mapped at 0x4000-0x7FFF
+    ubyte   u8Opcode;
+    ubyte   u8State;                        // GBCpuTraceState flags
+    ubyte   u8Reserved;
+};
+
+struct GBCpuTraceFileHeader
+{
+    char    szMagic[ 4 ];                   // "GBTR"
+    uint32  u32Version;
+    uint32  u32EntrySize;
+};
+
+#pragma pack( pop )
+
+enum
+{
+    kCpuTraceMaskSize       = ( sizeof( GBCpuTraceEntry ) + 7 ) / 8,
+    kCpuTraceMaxPackedSize  = kCpuTraceMaskSize + sizeof( GBCpuTraceEntry )
+};
+
+//====================================================================================================
+// Global Functions
+//====================================================================================================
+
+// Entries are xor'ed with the one before, which leaves most bytes zero. Each entry is stored as a mask
+// of the non zero bytes followed by those bytes. pPrevious is updated to the new entry.
+inline uint32 GBCpuTracePack( const GBCpuTraceEntry* pEntry, GBCpuTraceEntry* pPrevious, ubyte* pu8Out )
+{
+    const ubyte*    pu8Entry    = reinterpret_cast<const ubyte*>( pEntry );
+    ubyte*          pu8Previous = reinterpret_cast<ubyte*>( pPrevious );
+    ubyte*          pu8Mask     = pu8Out;
+    uint32          u32Size     = kCpuTraceMaskSize;
+
+    memset( pu8Mask, 0, kCpuTraceMaskSize );
+
+    for( uint32 i = 0; i < sizeof( GBCpuTraceEntry ); ++i )
+    {
+        ubyte u8Delta = pu8Entry[ i ] ^ pu8Previous[ i ];
+        if( 0 != u8Delta )
+        {
+            pu8Mask[ i >> 3 ] |= 1 << ( i & 7 );
+            pu8Out[ u32Size++ ] = u8Delta;
+        }
+    }
+
+    *pPrevious = *pEntry;
+
+    return u32Size;
+}
+
+// Reads the next entry written by GBCpuTracePack, pEntry has to hold the previous entry
+inline bool GBCpuTraceUnpack( FILE* pFile, GBCpuTraceEntry* pEntry )
+{
+    ubyte u8Mask[ kCpuTraceMaskSize ];
+    if( 1 != fread( u8Mask, sizeof( u8Mask ), 1, pFile ) )
+    {
+        return false;
+    }
+
+    ubyte* pu8Entry = reinterpret_cast<ubyte*>( pEntry );
+    for( uint32 i = 0; i < sizeof( GBCpuTraceEntry ); ++i )
+    {
+        if( 0 != ( u8Mask[ i >> 3 ] & ( 1 << ( i & 7 ) ) ) )
+        {
+            int iDelta = fgetc( pFile );
+            if( EOF == iDelta )
+            {
+                return false;
+            }
+
+            pu8Entry[ i ] ^= static_cast<ubyte>( iDelta );
+        }
+    }
+
+    return true;
+}
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBCpuTrace
+{
+public:
+    // Constructor / destructor
+    GBCpuTrace();
+    ~GBCpuTrace();
+
+    bool            Open( const char* szFilepath );
+    void            Close();
+    inline bool     IsOpen() const                                  { return NULL != m_pFile;           }
+
+    // Only called from the emulation thread. Waits for the writer rather than dropping entries when the
+    // buffer is full, a trace with holes isn't much use.
+    inline void     Record( const GBCpuTraceEntry& oEntry )
+    {
+        uint32 u32Write = m_u32WriteIndex.load( std::memory_order_relaxed );
+        while( u32Write - m_u32ReadIndex.load( std::memory_order_acquire ) >= kCpuTraceBufferSize )
+        {
+            std::this_thread::yield();
+        }
+
+        m_pEntries[ u32Write & ( kCpuTraceBufferSize - 1 ) ] = oEntry;
+        m_u32WriteIndex.store( u32Write + 1, std::memory_order_release );
+    }
+
+private:
+    void            WriterThread();
+    void            WriteEntries( uint32 u32Read, uint32 u32End );
+
+private:
+    FILE*                   m_pFile;
+    GBCpuTraceEntry*        m_pEntries;
+    ubyte*                  m_pu8Packed;        // Writer's compression buffer
+    GBCpuTraceEntry         m_oPrevious;        // Last entry written, the next one is xor'ed with it
+
+    std::atomic<uint32>     m_u32WriteIndex;    // Entries recorded, only the emulation thread writes it
+    std::atomic<uint32>     m_u32ReadIndex;     // Entries written to the file, only the writer writes it
+    std::atomic<bool>       m_bStopWriter;
+    std::thread             m_oWriter;
+};
+
+#endif
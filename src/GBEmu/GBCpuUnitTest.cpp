@@ -10,29 +10,85 @@
 
 #include "GBCpuUnitTest.h"
 
+#include "GBEmulator.h"
 #include "GBCpu.h"
 #include "GBMem.h"
+#include "CLog.h"
+
+// Unlike assert, a failed check is logged and counted in every build
+#define CHECK( EXPRESSION ) Check( ( EXPRESSION ), #EXPRESSION, __LINE__ )
 
 //====================================================================================================
 // Class
 //====================================================================================================
 
-GBCpuUnitTest::GBCpuUnitTest()
+GBCpuUnitTest::GBCpuUnitTest() :
+    m_pEmulator( new GBEmulator( true ) ),
+    m_u32Checks( 0 ),
+    m_u32Failures( 0 )
 {
 }
     
 //----------------------------------------------------------------------------------------------------
 GBCpuUnitTest::~GBCpuUnitTest()
 {
+    delete m_pEmulator;
+    m_pEmulator = NULL;
 }
 
 //----------------------------------------------------------------------------------------------------
-void GBCpuUnitTest::ExecuteTests()
+uint32 GBCpuUnitTest::ExecuteTests()
 {
+    m_u32Checks     = 0;
+    m_u32Failures   = 0;
+
     TestOpLD_r_n();
+    TestStopWakesOnInput();
+
+    Log()->Write( ( 0 == m_u32Failures ) ? LOG_COLOR_GREEN : LOG_COLOR_RED, "Cpu unit tests: %u of %u checks failed", m_u32Failures, m_u32Checks );
+
+    return m_u32Failures;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuUnitTest::Check( bool bPassed, const char* szExpression, int iLine )
+{
+    ++m_u32Checks;
+
+    if( !bPassed )
+    {
+        ++m_u32Failures;
+        Log()->Write( LOG_COLOR_RED, "Cpu unit test check '%s' failed, line %d", szExpression, iLine );
+    }
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBCpuUnitTest::TestOpLD_r_n()
 {
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBCpuUnitTest::TestStopWakesOnInput()
+{
+    GBCpu* pCpu = m_pEmulator->m_pCpu;
+
+    m_pEmulator->Reset();
+
+    uint16 u16PC = pCpu->m_State.u16PC;
+
+    pCpu->m_State.bStop = true;
+    pCpu->m_State.bIME = false;
+    pCpu->SetInterruptEnableRegsiter( Timer | Input );
+
+    // Other requests leave the CPU stopped
+    pCpu->SetInterruptFlagsRegsiter( Timer );
+    pCpu->RunUntil( 4 );
+    CHECK( !pCpu->IsRunning() );
+
+    // A joypad press wakes it, and with IME clear nothing is serviced
+    pCpu->SetInterruptFlagsRegsiter( Timer | Input );
+    pCpu->RunUntil( 4 );
+    CHECK( pCpu->IsRunning() );
+    CHECK( u16PC == pCpu->m_State.u16PC );
+    CHECK( 0 != ( pCpu->m_State.u8InterruptFlags & Input ) );
+}
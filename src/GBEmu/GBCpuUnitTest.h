@@ -13,6 +13,12 @@
 
 #include "emutypes.h"
 
+//====================================================================================================
+// Foward Declarations
+//====================================================================================================
+
+class GBEmulator;
+
 //====================================================================================================
 // Class
 //====================================================================================================
@@ -26,10 +32,20 @@ public:
     GBCpuUnitTest();
     ~GBCpuUnitTest();
 
-    void    ExecuteTests();
+    // Runs every test on a headless emulator of its own and logs each failed check, returns the
+    // number of checks that failed
+    uint32  ExecuteTests();
 
 private:
     void    TestOpLD_r_n();
+    void    TestStopWakesOnInput();
+
+    void    Check( bool bPassed, const char* szExpression, int iLine );
+
+private:
+    GBEmulator*     m_pEmulator;
+    uint32          m_u32Checks;
+    uint32          m_u32Failures;
 };
 
 #endif
\ No newline at end of file
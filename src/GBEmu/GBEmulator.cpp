@@ -18,10 +18,13 @@
 #include "GBTimer.h"
 #include "GBJoypad.h"
 #include "GBCartridge.h"
+#include "GBCpuBatch.h"
+#include "GBCpuBenchmark.h"
 #include "GBUserPrefs.h"
 
 #include "CProfileManager.h"
 #include "CTimer.h"
+#include "CLog.h"
 
 #include <windows.h>
 #include <SDL.h>
@@ -42,13 +45,14 @@ const char* GB_BATTERY_DIRECTORY = "battery\\";
 // Class
 //====================================================================================================
 
-GBEmulator::GBEmulator() :
+GBEmulator::GBEmulator( bool bHeadless ) :
     m_pMem( NULL ),
     m_pCpu( NULL ),
     m_pGpu( NULL ),
     m_pJoypad( NULL ),
     m_pTimer( NULL ),
     m_pCartridge( NULL ),
+    m_bHeadless( bHeadless ),
     m_bRunning( false ),
     m_bCartridgeLoaded( false ),
     m_bDebugPaused( false ),
@@ -57,6 +61,9 @@ GBEmulator::GBEmulator() :
     m_fElapsedTime( 0 ),
     m_fIdleTime( 0 ),
     m_fAvgIdleTime( 0 ),
+    m_fHaltSkipPercent( 0 ),
+    m_dRomCycles( 0 ),
+    m_dRomIdleSkippedCycles( 0 ),
     m_u32TotalFrames( 0 ),
     m_u32LastFrameCycles( 0 ),
     m_pFpsText( NULL ),
@@ -74,6 +81,44 @@ GBEmulator::~GBEmulator()
 
 //----------------------------------------------------------------------------------------------------
 void GBEmulator::Initialize()
+{
+    // Headless instances are run by GBCpuBatch and GBCpuBenchmark, they use the prefs the windowed instance loaded
+    if( !m_bHeadless )
+    {
+        InitializeDisplay();
+
+        // Load the user preferences
+        UserPrefs()->Load();
+    }
+
+    // Make sure our battery directory exists
+    if( 0 != _access( GB_BATTERY_DIRECTORY, 0 ) )
+    {
+        _mkdir( GB_BATTERY_DIRECTORY );
+    }
+
+    // Tracing and hot spots are only for the windowed instance
+    GBCpuOptions oCpuOptions;
+    if( !m_bHeadless )
+    {
+        oCpuOptions.strTraceFilepath    = UserPrefs()->GetTraceFilepath();
+        oCpuOptions.strHotSpotFilepath  = UserPrefs()->GetHotSpotFilepath();
+    }
+
+    m_pMem          = new GBMem;
+    m_pTimer        = new GBTimer( this, m_pMem );
+    m_pCpu          = new GBCpu( m_pMem, m_pTimer, oCpuOptions );
+    m_pGpu          = new GBGpu( this, m_pMem );
+    m_pJoypad       = new GBJoypad( this, m_pMem );
+    m_pCartridge    = new GBCartridge( m_pMem );
+
+    m_bInitialized = true;
+
+    Reset();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBEmulator::InitializeDisplay()
 {
     if( -1 == SDL_Init( SDL_INIT_EVERYTHING ) )
     {
@@ -91,9 +136,6 @@ void GBEmulator::Initialize()
         exit( 1 );
     }
 
-    // Load the user preferences
-    UserPrefs()->Load();
-
     SDL_SetWindowTitle( m_pWindow, "Gameboy Emulator" );
 
     // Clear color is white
@@ -106,19 +148,6 @@ void GBEmulator::Initialize()
                                     GBScreenWidth, 
                                     GBScreenHeight );
 
-    // Make sure our battery directory exists
-    if( 0 != _access( GB_BATTERY_DIRECTORY, 0 ) )
-    {
-        _mkdir( GB_BATTERY_DIRECTORY );
-    }
-
-    m_pMem          = new GBMem;
-    m_pTimer        = new GBTimer( this, m_pMem );
-    m_pCpu          = new GBCpu( m_pMem, m_pTimer );
-    m_pGpu          = new GBGpu( this, m_pMem );
-    m_pJoypad       = new GBJoypad( this, m_pMem );
-    m_pCartridge    = new GBCartridge( m_pMem );
-
     TTF_Init();
 
     TTF_Font* pFont = TTF_OpenFont( "assets\\Charybdis.ttf", 24 );
@@ -134,10 +163,6 @@ void GBEmulator::Initialize()
     m_pFpsText->load( m_pRenderer, pFont, NFont::Color::Color() );
 
     GTimer()->Initialize();
-
-    m_bInitialized = true;
-
-    Reset();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -165,11 +190,14 @@ void GBEmulator::Terminate()
         delete m_pMem;
         m_pMem = NULL;
 
-        delete m_pFpsText;
-        m_pFpsText = NULL;
+        if( !m_bHeadless )
+        {
+            delete m_pFpsText;
+            m_pFpsText = NULL;
 
-        TTF_Quit();
-        SDL_Quit();
+            TTF_Quit();
+            SDL_Quit();
+        }
 
         m_bInitialized = false;
     }
@@ -239,6 +267,9 @@ void GBEmulator::Reset()
     m_fLastFrame            = 0.f;
     m_fIdleTime             = 0.f;
     m_fAvgIdleTime          = 0.f;
+    m_fHaltSkipPercent      = 0.f;
+    m_dRomCycles            = 0.0;
+    m_dRomIdleSkippedCycles = 0.0;
 
     m_pMem->Reset();
     m_pTimer->Reset();
@@ -253,11 +284,13 @@ void GBEmulator::LoadCartridge( const char* szFilepath )
 {
     StopAndUnloadCartridge();
 
-    if( m_pCartridge->LoadFromFile( szFilepath, GB_BATTERY_DIRECTORY ) )
+    // Headless instances (benchmark lanes) run alongside the live game and must never touch its save
+    if( m_pCartridge->LoadFromFile( szFilepath, m_bHeadless ? NULL : GB_BATTERY_DIRECTORY ) )
     {
-        m_bCartridgeLoaded = true;
+        m_bCartridgeLoaded      = true;
+        m_strCartridgeFilepath  = szFilepath;
     }
-    else
+    else if( !m_bHeadless )
     {
         SDL_ShowSimpleMessageBox( SDL_MESSAGEBOX_ERROR, "Error loading ROM", "Unable to load the selected ROM.", m_pWindow );
 
@@ -271,13 +304,48 @@ void GBEmulator::RaiseInterrupt( Interrupt interrupt )
 {
     m_pCpu->RaiseInterrupt( interrupt );
 
-    if( VBlank == interrupt )
+    if(     VBlank == interrupt
+        &&  !m_bHeadless )
     {
         // In order to avoid screen tearing, the draw must be done during the VSync
         Draw();
     }
 }
 
+//----------------------------------------------------------------------------------------------------
+void GBEmulator::SetInterruptLine( Interrupt interrupt, bool bAsserted )
+{
+    m_pCpu->SetInterruptLine( interrupt, bAsserted );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBEmulator::GetFootprint( GBFootprint& oFootprint ) const
+{
+    oFootprint.u32Memory        = sizeof( GBMem );
+    oFootprint.u32Cpu           = sizeof( GBCpu ) + m_pCpu->GetHistoryBytes();
+    oFootprint.u32Gpu           = sizeof( GBGpu );
+    oFootprint.u32CartridgeRam  = m_pCartridge->GetRamBytes();
+    oFootprint.u32BlockCache    = m_pCpu->GetBlockCacheBytes();
+    oFootprint.u32Other         = sizeof( GBTimer ) + sizeof( GBJoypad ) + sizeof( GBCartridge ) + sizeof( GBEmulator );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBEmulator::LogFootprint() const
+{
+    GBFootprint oFootprint;
+    GetFootprint( oFootprint );
+
+    Log()->Write( LOG_COLOR_WHITE, "Footprint%s: %u KB (memory %u, cpu %u, gpu %u, cartridge ram %u, block cache %u, other %u bytes)",
+                  GB_COMPACT ? " (compact)" : "",
+                  oFootprint.GetStateBytes() / 1024,
+                  oFootprint.u32Memory,
+                  oFootprint.u32Cpu,
+                  oFootprint.u32Gpu,
+                  oFootprint.u32CartridgeRam,
+                  oFootprint.u32BlockCache,
+                  oFootprint.u32Other );
+}
+
 //----------------------------------------------------------------------------------------------------
 void GBEmulator::Update()
 {
@@ -306,6 +374,11 @@ void GBEmulator::Update()
                 {
                     m_fAvgIdleTime      = static_cast<float>( m_fIdleTime / m_u32TotalFrames );
                     m_fIdleTime         = 0;
+
+                    // Share of the emulated cycles the CPU spent fast-forwarding through HALT
+                    m_fHaltSkipPercent  = 100.f * m_pCpu->GetHaltSkippedCycles() / ( static_cast<float>( m_u32TotalFrames ) * kMaxCyclesPerFrame );
+                    m_pCpu->ResetHaltSkippedCycles();
+
                     m_u32TotalFrames    = 0;
                 }
 
@@ -319,12 +392,8 @@ void GBEmulator::Update()
 
                 GTimer()->Update();
 
-                // If the cart has a battery and something has changed, we need to update our .sav file
-                if(     m_pCartridge->HasBattery()
-                    &&  m_pCartridge->IsRamDirty() )
-                {
-                    m_pCartridge->FlushRamToSaveFile( GB_BATTERY_DIRECTORY );
-                }
+                // If the cart has a battery and something has changed, the writer thread saves it
+                m_pCartridge->UpdateBattery();
             }
         }
         else if( m_fNextFrame - m_fElapsedTime > 1.f )
@@ -344,39 +413,48 @@ void GBEmulator::Step()
     // Handle the emulation for this frame
     while( iFrameCycles < kMaxCyclesPerFrame )
     {
-        iStepCycles = 0;
-
-        // Execute the next opcode
-        iStepCycles += m_pCpu->ExecuteOpcode();
+        // Nothing the GPU does can change before its next event, run the CPU up to it or the end of the frame.
+        // The joypad updates itself when its register is written or a key changes.
+        int iDeadline = m_pGpu->GetCyclesToNextEvent();
+        if( iDeadline > kMaxCyclesPerFrame - iFrameCycles )
+        {
+            iDeadline = kMaxCyclesPerFrame - iFrameCycles;
+        }
 
-        // Handle interrupts
-        iStepCycles += m_pCpu->HandleInterrupts();
+        // Execute opcodes and interrupts, I/O writes stop the CPU early
+        iStepCycles = m_pCpu->RunUntil( iDeadline );
 
         iFrameCycles += iStepCycles;
 
         // Update the GPU
         m_pGpu->Update( iStepCycles );
-
-        // Update the joypad
-        m_pJoypad->Update();
     }
     m_u32LastFrameCycles = iFrameCycles;
+
+    m_dRomCycles            += iFrameCycles;
+    m_dRomIdleSkippedCycles += m_pCpu->GetIdleSkippedCycles();
+    m_pCpu->ResetIdleSkippedCycles();
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBEmulator::Draw()
 {
-    const uint32* pu32ScreenData     = m_pGpu->GetScreenData();
-
     SDL_RenderClear( m_pRenderer );
 
     if( m_bRunning && m_bCartridgeLoaded )
     {
-        SDL_UpdateTexture( m_pTexture, NULL, pu32ScreenData, GBScreenWidth * sizeof( uint32 ) );
+        // The GPU writes the screen straight into the texture, expanding it if it only keeps shades
+        void*   pPixels = NULL;
+        int     iPitch  = 0;
+        if( 0 == SDL_LockTexture( m_pTexture, NULL, &pPixels, &iPitch ) )
+        {
+            m_pGpu->CopyScreenData( static_cast<uint32*>( pPixels ), iPitch / sizeof( uint32 ) );
+            SDL_UnlockTexture( m_pTexture );
+        }
         SDL_RenderCopy( m_pRenderer, m_pTexture, NULL, NULL );
     }
 
-    m_pFpsText->draw( m_pRenderer, 0, GBScreenHeight * kScreenScaleFactor - 20, "%.1f (Idle: %.1f)", GTimer()->GetFPS(), m_fAvgIdleTime );
+    m_pFpsText->draw( m_pRenderer, 0, GBScreenHeight * kScreenScaleFactor - 20, "%.1f (Idle: %.1f Halt: %.0f%%)", GTimer()->GetFPS(), m_fAvgIdleTime, m_fHaltSkipPercent );
     
     SDL_RenderPresent( m_pRenderer );
 }
@@ -384,6 +462,14 @@ void GBEmulator::Draw()
 //----------------------------------------------------------------------------------------------------
 void GBEmulator::StopAndUnloadCartridge()
 {
+    if( m_bCartridgeLoaded && m_dRomCycles > 0.0 && !m_bHeadless )
+    {
+        Log()->Write( LOG_COLOR_WHITE, "%s: skipped %.0f of %.0f cycles in idle loops (%.1f%%)",
+                      m_pCartridge->GetTitle().c_str(), m_dRomIdleSkippedCycles, m_dRomCycles, 100.0 * m_dRomIdleSkippedCycles / m_dRomCycles );
+
+        LogFootprint();
+    }
+
     m_pCartridge->Unload();
     m_bCartridgeLoaded = false;
     
@@ -453,5 +539,21 @@ void GBEmulator::HandleShortcuts( SDL_Event* pEvent )
                 Step();
             }
             break;
+        case SDLK_b:
+            if( m_bCartridgeLoaded )
+            {
+                // Benchmark both cpu cores over 10 seconds worth of emulated cycles
+                GBCpuBenchmark* pBenchmark = new GBCpuBenchmark();
+                pBenchmark->Run( m_strCartridgeFilepath.c_str(), GBCpu::CLOCK_SPEED * 10 );
+                delete pBenchmark;
+            }
+            break;
+        case SDLK_n:
+            if( m_bCartridgeLoaded )
+            {
+                // Run 64 copies of the cartridge for 2 seconds of emulated time, in lockstep and independently
+                GBCpuBatch::RunBenchmark( m_strCartridgeFilepath.c_str(), 64, 120 );
+            }
+            break;
     }
 }
\ No newline at end of file
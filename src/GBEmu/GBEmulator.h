@@ -13,6 +13,8 @@
 //====================================================================================================
 
 #include "emutypes.h"
+
+#include <string>
 
 //====================================================================================================
 // Namespaces
@@ -49,12 +51,33 @@ enum Interrupt
     Input       = 1 << 4
 };
 
+//====================================================================================================
+// Global Structs
+//====================================================================================================
+
+// Bytes one emulator instance holds, the ROM image is shared and not counted
+struct GBFootprint
+{
+    uint32  u32Memory;          // Address space storage, page tables and register handlers
+    uint32  u32Cpu;             // Registers and the debug history
+    uint32  u32Gpu;             // Registers and the framebuffer
+    uint32  u32CartridgeRam;
+    uint32  u32BlockCache;      // Decoded blocks, allocated up front even though they can be rebuilt
+    uint32  u32Other;           // Timer, joypad, cartridge and the emulator itself
+
+    uint32  GetStateBytes() const   { return u32Memory + u32Cpu + u32Gpu + u32CartridgeRam + u32BlockCache + u32Other;  }
+};
+
 //====================================================================================================
 // Class
 //====================================================================================================
 
 class GBEmulator
 {
+    friend class GBCpuBatch;
+    friend class GBCpuBenchmark;
+    friend class GBCpuUnitTest;
+
     // Internal constants
     enum
     {
@@ -67,7 +90,7 @@ public:
 
 public:
     // Constructor / destructor
-    GBEmulator();
+    GBEmulator( bool bHeadless = false );   // Headless instances have no window and are stepped by their owner
     ~GBEmulator();
 
     void    Initialize();
@@ -77,9 +100,16 @@ public:
     void    Reset();
 
     void    LoadCartridge( const char* szFilepath );
+    inline bool IsCartridgeLoaded() const                   { return m_bCartridgeLoaded;    }
     void    RaiseInterrupt( Interrupt interrupt );
+    void    SetInterruptLine( Interrupt interrupt, bool bAsserted );
+
+    void    GetFootprint( GBFootprint& oFootprint ) const;
+    void    LogFootprint() const;
 
 private:
+    void    InitializeDisplay();
+
     void    Update();
     void    Step();
     void    Draw();
@@ -98,8 +128,10 @@ private:
     GBCartridge*    m_pCartridge;
 
     bool            m_bInitialized;
+    bool            m_bHeadless;
     bool            m_bRunning;
     bool            m_bCartridgeLoaded;
+    string          m_strCartridgeFilepath;
 
     bool            m_bDebugPaused;
 
@@ -108,6 +140,9 @@ private:
     float           m_fLastFrame;
     float           m_fIdleTime;
     float           m_fAvgIdleTime;
+    float           m_fHaltSkipPercent;
+    double          m_dRomCycles;           // Emulated cycles since the ROM was loaded or reset
+    double          m_dRomIdleSkippedCycles;
     uint32          m_u32TotalFrames;
     uint32          m_u32LastFrameCycles;
 
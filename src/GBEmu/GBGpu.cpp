@@ -36,6 +36,7 @@ GBGpu::GBGpu( GBEmulator* pEmulator, GBMem* pMemoryModule ) :
     m_u8WindowY( 0 ),
     m_u8WindowX( 0 ),
     m_u32ScanTime( 0 ),
+    m_u32DMACycles( 0 ),
     m_bIsVSync( false ),
     m_bIsHBlank( false )
 {
@@ -52,12 +53,19 @@ GBGpu::GBGpu( GBEmulator* pEmulator, GBMem* pMemoryModule ) :
     SetMMIORegisterHandlers<GBGpu>( m_pMem, MMIOWindowY,        &GBGpu::GetWindowYRegister,         &GBGpu::SetWindowYRegister );
     SetMMIORegisterHandlers<GBGpu>( m_pMem, MMIOWindowX,        &GBGpu::GetWindowXRegister,         &GBGpu::SetWindowXRegister );
 
-    Reset();
-
+#if GB_COMPACT
+    m_PaletteLookup[ 0 ] = PaletteWhite;
+    m_PaletteLookup[ 1 ] = PaletteLight;
+    m_PaletteLookup[ 2 ] = PaletteMedium;
+    m_PaletteLookup[ 3 ] = PaletteDark;
+#else
     m_PaletteLookup[ 0 ] = ColorWhite;
     m_PaletteLookup[ 1 ] = ColorLight;
     m_PaletteLookup[ 2 ] = ColorMedium;
     m_PaletteLookup[ 3 ] = ColorDark;
+#endif
+
+    Reset();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -70,7 +78,7 @@ void GBGpu::Reset()
 {
     for( int i = 0; i < GBScreenWidth * GBScreenHeight; ++i )
     {
-        m_u32ScreenData[ i ] = ColorWhite;
+        m_ScreenData[ i ] = m_PaletteLookup[ PaletteWhite ];
     }
 
     m_u8LCDControl      = 0;
@@ -88,6 +96,10 @@ void GBGpu::Reset()
 
     m_u32ScanTime       = 0;
 
+    // Resetting the memory starts a transfer from page 0
+    m_u32DMACycles      = 0;
+    m_pMem->EndOamDma();
+
     m_bIsVSync          = false;
     m_bIsHBlank         = false;
 }
@@ -99,6 +111,20 @@ void GBGpu::Update( uint32 u32ElapsedClockCycles )
 
     m_u32ScanTime += u32ElapsedClockCycles;
 
+    // Give the bus back to the CPU once the transfer is over
+    if( 0 != m_u32DMACycles )
+    {
+        if( u32ElapsedClockCycles >= m_u32DMACycles )
+        {
+            m_u32DMACycles = 0;
+            m_pMem->EndOamDma();
+        }
+        else
+        {
+            m_u32DMACycles -= u32ElapsedClockCycles;
+        }
+    }
+
     switch( GetLCDMode() )
     {
         case ModeOam:
@@ -136,21 +162,70 @@ void GBGpu::Update( uint32 u32ElapsedClockCycles )
 }
 
 //----------------------------------------------------------------------------------------------------
-const uint32* GBGpu::GetScreenData() const
+int GBGpu::GetCyclesToNextEvent() const
+{
+    // Cycles until Update() changes the LCD mode, moves to the next scanline or ends the OAM DMA, can be
+    // negative if the last update overshot
+    int iScanTime   = static_cast<int>( m_u32ScanTime );
+    int iCycles     = 456 - iScanTime;
+
+    switch( GetLCDMode() )
+    {
+        case ModeOam:
+            iCycles = 80 - iScanTime;
+            break;
+
+        case ModeOamRam:
+            iCycles = 252 - iScanTime;
+            break;
+    }
+
+    if( 0 != m_u32DMACycles && static_cast<int>( m_u32DMACycles ) < iCycles )
+    {
+        iCycles = static_cast<int>( m_u32DMACycles );
+    }
+
+    return iCycles;
+}
+
+//----------------------------------------------------------------------------------------------------
+const GBScreenPixel* GBGpu::GetScreenData() const
 {
-    return m_u32ScreenData;
+    return m_ScreenData;
 }
 
 //----------------------------------------------------------------------------------------------------
-void GBGpu::SetDMATransferRegister( ubyte u8Data )
+void GBGpu::CopyScreenData( uint32* pu32Dest, uint32 u32Pitch ) const
 {
-    m_u8DMATransfer = u8Data;
-    for( int i = 0; i < 0x100; ++i )
+    // Pitch is in pixels
+    for( uint32 y = 0; y < GBScreenHeight; ++y )
     {
-        m_pMem->WriteMemory( 0xFE00 + i, m_pMem->ReadMemory( ( u8Data << 8 ) + i ) );
+        const GBScreenPixel*    pRow    = m_ScreenData + ( y * GBScreenWidth );
+        uint32*                 pu32Row = pu32Dest + ( y * u32Pitch );
+
+#if GB_COMPACT
+        static const uint32 s_u32ShadeColors[ 4 ] = { ColorWhite, ColorLight, ColorMedium, ColorDark };
+
+        for( uint32 x = 0; x < GBScreenWidth; ++x )
+        {
+            pu32Row[ x ] = s_u32ShadeColors[ pRow[ x ] ];
+        }
+#else
+        memcpy( pu32Row, pRow, GBScreenWidth * sizeof( uint32 ) );
+#endif
     }
 }
 
+//----------------------------------------------------------------------------------------------------
+void GBGpu::SetDMATransferRegister( ubyte u8Data )
+{
+    m_u8DMATransfer = u8Data;
+
+    // The copy is done up front, the CPU is kept off the bus until the transfer would have finished
+    m_pMem->StartOamDma( u8Data );
+    m_u32DMACycles  = kOamDmaCycles;
+}
+
 //----------------------------------------------------------------------------------------------------
 void GBGpu::DoScanline()
 {
@@ -233,7 +308,7 @@ void GBGpu::DrawLine()
     uint32 u32Offset = m_u8LCDScanline * GBScreenWidth;
     for( uint32 i = u32Offset; i < u32Offset + GBScreenWidth; ++i )
     {
-        m_u32ScreenData[ i ] = ColorWhite;
+        m_ScreenData[ i ] = m_PaletteLookup[ PaletteWhite ];
     }
 
     if( IsBackgroundEnabled() )
@@ -274,7 +349,7 @@ void GBGpu::DrawBackground()
         px &= 7;
 
         // Fill in the screen data with the current pixel color
-        m_u32ScreenData[ i ] = m_PaletteLookup[ ( m_u8BGPalette >> ( palette * 2 ) ) & 3 ];
+        m_ScreenData[ i ] = m_PaletteLookup[ ( m_u8BGPalette >> ( palette * 2 ) ) & 3 ];
 
         // If we're on a new tile, we need to grab new data
         if( 0 == px )
@@ -324,7 +399,7 @@ void GBGpu::DrawWindow()
             px &= 7;
 
             // Fill in the screen data with the current pixel color
-            m_u32ScreenData[ i ] = m_PaletteLookup[ ( m_u8BGPalette >> ( palette * 2 ) ) & 3 ];
+            m_ScreenData[ i ] = m_PaletteLookup[ ( m_u8BGPalette >> ( palette * 2 ) ) & 3 ];
 
             // If we're on a new tile, we need to grab new data
             if( 0 == px )
@@ -422,14 +497,14 @@ void GBGpu::DrawSprites()
                 // If the priority flag is set and the background/window color is not white, do not draw this pixel
                 if(     0 == u8PaletteIndex
                     ||  (   oSpriteData.attributeFlags & OamAttrPriority
-                        &&  ColorWhite != m_u32ScreenData[ u32Offset + lx ] ) )
+                        &&  m_PaletteLookup[ PaletteWhite ] != m_ScreenData[ u32Offset + lx ] ) )
                 {
                     continue;
                 }
                 u8PaletteIndex = ( u8Palette >> ( u8PaletteIndex * 2 ) ) & 3;
 
                 // Fill in the screen data with the current pixel color
-                m_u32ScreenData[ u32Offset + lx ] = m_PaletteLookup[ u8PaletteIndex ];
+                m_ScreenData[ u32Offset + lx ] = m_PaletteLookup[ u8PaletteIndex ];
                 
             }
         }
@@ -439,7 +514,7 @@ void GBGpu::DrawSprites()
 //----------------------------------------------------------------------------------------------------
 uint16 GBGpu::GetMapTileData( uint16 u16MapAddr, uint16 u16DataAddr, ubyte u8TileX, ubyte u8TileY, ubyte u8Row )
 {
-    ubyte u8TileIndex   = m_pMem->ReadMemory( u16MapAddr + ( u8TileY << 5 ) + ( u8TileX & 0x1F ) );
+    ubyte u8TileIndex   = m_pMem->ReadVideoMemory( u16MapAddr + ( u8TileY << 5 ) + ( u8TileX & 0x1F ) );
     u16DataAddr         = u16DataAddr + ( ( ( u16DataAddr == TileDataSelect1 ) ? u8TileIndex : static_cast<sbyte>( u8TileIndex ) ) << 4 ) + ( u8Row << 1 );
 
     return GetTileData( u16DataAddr );
@@ -456,8 +531,8 @@ uint16 GBGpu::GetSpriteTileData( ubyte u8TileIndex, ubyte u8Row )
 //----------------------------------------------------------------------------------------------------
 uint16 GBGpu::GetTileData( uint16 u16DataAddr )
 {
-    ubyte u8RawDataLo   = m_pMem->ReadMemory( u16DataAddr );
-    ubyte u8RawDataHi   = m_pMem->ReadMemory( u16DataAddr + 1 );
+    ubyte u8RawDataLo   = m_pMem->ReadVideoMemory( u16DataAddr );
+    ubyte u8RawDataHi   = m_pMem->ReadVideoMemory( u16DataAddr + 1 );
     uint16 u16TileData  = 0;
 
     // The raw tile format is difficult to use, so parse it into a more software-friendly format.
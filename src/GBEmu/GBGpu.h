@@ -33,12 +33,26 @@ enum
     GBScreenHeight      = 144
 };
 
+//====================================================================================================
+// Global Typedefs
+//====================================================================================================
+#if GB_COMPACT
+typedef ubyte   GBScreenPixel;      // Shade 0-3, CopyScreenData() turns it into ARGB
+#else
+typedef uint32  GBScreenPixel;      // ARGB
+#endif
+
 //====================================================================================================
 // Class
 //====================================================================================================
 
 class GBGpu : public GBMMIORegister
 {
+    enum
+    {
+        kOamDmaCycles   = 640       // 160 bytes at one byte per machine cycle
+    };
+
     enum
     {
         PaletteWhite    = 0x00,
@@ -98,7 +112,9 @@ public:
     void            Reset();
 
     void            Update( uint32 u32ElapsedClockCycles );
-    const uint32*   GetScreenData() const;
+    int             GetCyclesToNextEvent() const;
+    const GBScreenPixel* GetScreenData() const;
+    void            CopyScreenData( uint32* pu32Dest, uint32 u32Pitch ) const;
 
     bool            IsVSyncOrHBlank() const                                     { return m_bIsVSync || m_bIsHBlank;                         }
     bool            IsVSync() const                                             { return m_bIsVSync;                                        }
@@ -187,12 +203,13 @@ private:
     ubyte           m_u8WindowY;
     ubyte           m_u8WindowX;
 
-    LCDColor        m_PaletteLookup[ 4 ];
+    GBScreenPixel   m_PaletteLookup[ 4 ];
     uint32          m_u32ScanTime;
+    uint32          m_u32DMACycles;             // Left in the running OAM DMA, 0 when there is none
     bool            m_bIsVSync;
     bool            m_bIsHBlank;
 
-    uint32          m_u32ScreenData[ GBScreenWidth * GBScreenHeight ];
+    GBScreenPixel   m_ScreenData[ GBScreenWidth * GBScreenHeight ];
 };
 
 #endif
\ No newline at end of file
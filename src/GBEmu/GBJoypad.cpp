@@ -42,6 +42,8 @@ void GBJoypad::Reset()
 {
     m_u8StateRegister = -1;
     m_u32KeyStatus = -1;
+
+    Update();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -59,9 +61,12 @@ void GBJoypad::Update()
     // Left |__|B_______ 1|        |
     // Right|__|A_______ 0|________|
 
+    // Only called when the register is written or a key changes, nothing else affects the state.
     // By default, input will poll high (ignoring bits 4 and 5)
     m_u8StateRegister |= 0xcf;
 
+    bool bPressed = false;
+
     // Check if we need to poll the input
     if( 0x30 != ( m_u8StateRegister & 0x30 ) )
     {
@@ -85,12 +90,11 @@ void GBJoypad::Update()
         m_u8StateRegister &= ( 0xf0 | buttons );
 
         // Raise an interrupt if any of the edges fell low
-        // TODO: Input state currently does not persist across update cycles, so this interrupt may trigger more than intended
-        if( 0x0f != ( m_u8StateRegister & 0x0f ) )
-        {
-            m_pEmulator->RaiseInterrupt( Input );
-        }
+        // TODO: The line is held while a button is down, so this interrupt may trigger more than intended
+        bPressed = ( 0x0f != ( m_u8StateRegister & 0x0f ) );
     }
+
+    m_pEmulator->SetInterruptLine( Input, bPressed );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -98,6 +102,8 @@ void GBJoypad::SimulateKeyDown( JoypadButton button )
 {
     // Turn bit off when key is down
     m_u32KeyStatus &= ~button;
+
+    Update();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -105,4 +111,6 @@ void GBJoypad::SimulateKeyUp( JoypadButton button )
 {
     // Turn bit on when key is up
     m_u32KeyStatus |= button;
+
+    Update();
 }
\ No newline at end of file
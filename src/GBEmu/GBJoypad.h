@@ -56,7 +56,7 @@ public:
     void            SimulateKeyUp( JoypadButton button );
 
     inline ubyte    GetStateRegister() const                { return m_u8StateRegister;             }
-    inline void     SetStateRegister( ubyte u8Data )        { m_u8StateRegister = u8Data & 0x3f;    }
+    inline void     SetStateRegister( ubyte u8Data )        { m_u8StateRegister = u8Data & 0x3f; Update();  }
 
 private:
     GBEmulator*     m_pEmulator;
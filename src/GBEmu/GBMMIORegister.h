@@ -83,19 +83,4 @@ void GBMMIORegister::SetMMIORegisterHandlers( GBMem* pMem, MMIORegister eMMIOReg
                                 static_cast<MMIOWriteHandler>( fnWriteHandler ) );
 }
 
-//====================================================================================================
-// Class
-//====================================================================================================
-class GBNullMMIORegister : public GBMMIORegister
-{
-public:
-    GBNullMMIORegister( void )                              { m_u8Data = 0x00;      }
-    virtual ~GBNullMMIORegister() {}
-
-    void    WriteRegisterNoop( ubyte u8Data )               { m_u8Data = u8Data;    }
-    ubyte   ReadRegisterNoop() const                        { return m_u8Data;      }
-
-private:
-    ubyte   m_u8Data;
-};
 #endif
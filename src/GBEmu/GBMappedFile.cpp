@@ -0,0 +1,173 @@
+//====================================================================================================
+// Filename:    GBMappedFile.cpp
+// Created by:  Jeff Padgham
+// Description: Memory mapping of a file. The pages come straight from the OS file cache, so nothing is
+//              copied up front and processes mapping the same file share them. Writable mappings are
+//              written back by the OS, Flush only asks for it to happen now.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBMappedFile.h"
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBMappedFile::GBMappedFile() :
+    m_pu8Data( NULL ),
+    m_Size( 0 )
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+GBMappedFile::~GBMappedFile()
+{
+    Close();
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBMappedFile::Open( const char* szFilepath )
+{
+    Close();
+
+#if defined( _WIN32 )
+    HANDLE hFile = CreateFileA( szFilepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( INVALID_HANDLE_VALUE == hFile )
+    {
+        return false;
+    }
+
+    LARGE_INTEGER oSize;
+    if(     FILE_TYPE_DISK == GetFileType( hFile )
+        &&  GetFileSizeEx( hFile, &oSize )
+        &&  oSize.QuadPart > 0 )
+    {
+        HANDLE hMapping = CreateFileMappingA( hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if( NULL != hMapping )
+        {
+            // The view keeps the mapping alive on its own
+            m_pu8Data       = static_cast<ubyte*>( MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) );
+            m_Size          = ( NULL != m_pu8Data ) ? static_cast<size_t>( oSize.QuadPart ) : 0;
+            CloseHandle( hMapping );
+        }
+    }
+
+    CloseHandle( hFile );
+#else
+    int iFile = open( szFilepath, O_RDONLY );
+    if( iFile < 0 )
+    {
+        return false;
+    }
+
+    struct stat oStat;
+    if(     0 == fstat( iFile, &oStat )
+        &&  S_ISREG( oStat.st_mode )
+        &&  oStat.st_size > 0 )
+    {
+        // The mapping stays valid after the descriptor is closed
+        void* pData = mmap( NULL, static_cast<size_t>( oStat.st_size ), PROT_READ, MAP_PRIVATE, iFile, 0 );
+        if( MAP_FAILED != pData )
+        {
+            m_pu8Data       = static_cast<ubyte*>( pData );
+            m_Size          = static_cast<size_t>( oStat.st_size );
+        }
+    }
+
+    close( iFile );
+#endif
+
+    return IsOpen();
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBMappedFile::OpenWritable( const char* szFilepath, size_t Size )
+{
+    Close();
+
+#if defined( _WIN32 )
+    HANDLE hFile = CreateFileA( szFilepath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( INVALID_HANDLE_VALUE == hFile )
+    {
+        return false;
+    }
+
+    if( FILE_TYPE_DISK == GetFileType( hFile ) )
+    {
+        // Mapping a larger size than the file grows it
+        HANDLE hMapping = CreateFileMappingA( hFile, NULL, PAGE_READWRITE, 0, static_cast<DWORD>( Size ), NULL );
+        if( NULL != hMapping )
+        {
+            m_pu8Data       = static_cast<ubyte*>( MapViewOfFile( hMapping, FILE_MAP_WRITE, 0, 0, Size ) );
+            m_Size          = ( NULL != m_pu8Data ) ? Size : 0;
+            CloseHandle( hMapping );
+        }
+    }
+
+    CloseHandle( hFile );
+#else
+    int iFile = open( szFilepath, O_RDWR );
+    if( iFile < 0 )
+    {
+        return false;
+    }
+
+    struct stat oStat;
+    if(     0 == fstat( iFile, &oStat )
+        &&  S_ISREG( oStat.st_mode )
+        &&  (   static_cast<size_t>( oStat.st_size ) >= Size
+            ||  0 == ftruncate( iFile, static_cast<off_t>( Size ) ) ) )
+    {
+        void* pData = mmap( NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, iFile, 0 );
+        if( MAP_FAILED != pData )
+        {
+            m_pu8Data       = static_cast<ubyte*>( pData );
+            m_Size          = Size;
+        }
+    }
+
+    close( iFile );
+#endif
+
+    return IsOpen();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMappedFile::Flush( bool bWait )
+{
+    if( NULL != m_pu8Data )
+    {
+#if defined( _WIN32 )
+        FlushViewOfFile( m_pu8Data, m_Size );
+#else
+        msync( m_pu8Data, m_Size, bWait ? MS_SYNC : MS_ASYNC );
+#endif
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMappedFile::Close()
+{
+    if( NULL != m_pu8Data )
+    {
+#if defined( _WIN32 )
+        UnmapViewOfFile( m_pu8Data );
+#else
+        munmap( m_pu8Data, m_Size );
+#endif
+        m_pu8Data = NULL;
+    }
+
+    m_Size          = 0;
+}
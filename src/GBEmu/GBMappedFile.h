@@ -0,0 +1,54 @@
+#ifndef GBEMU_GBMAPPEDFILE_H
+#define GBEMU_GBMAPPEDFILE_H
+
+//====================================================================================================
+// Filename:    GBMappedFile.h
+// Created by:  Jeff Padgham
+// Description: Memory mapping of a file. The pages come straight from the OS file cache, so nothing is
+//              copied up front and processes mapping the same file share them. Writable mappings are
+//              written back by the OS, Flush only asks for it to happen now.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+
+#include <stddef.h>
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBMappedFile
+{
+public:
+    // Constructor / destructor
+    GBMappedFile();
+    ~GBMappedFile();
+
+    // Fails for anything that is not a regular, non empty file
+    bool                    Open( const char* szFilepath );
+
+    // Maps exactly Size bytes of an existing file, growing it first if it is shorter. A missing file is
+    // not created, so nothing appears on disk until its owner writes one.
+    bool                    OpenWritable( const char* szFilepath, size_t Size );
+    void                    Flush( bool bWait );
+    void                    Close();
+
+    inline bool             IsOpen() const                          { return NULL != m_pu8Data;         }
+    inline ubyte*           GetData() const                         { return m_pu8Data;                 }
+    inline size_t           GetSize() const                         { return m_Size;                    }
+
+private:
+    // Not copyable, the mapping has a single owner
+    GBMappedFile( const GBMappedFile& );
+    GBMappedFile&           operator=( const GBMappedFile& );
+
+private:
+    ubyte*                  m_pu8Data;
+    size_t                  m_Size;
+};
+
+#endif
@@ -22,15 +22,19 @@
 
 GBMem::GBMem( void ) :
     m_pMemBankController( NULL ),
-    m_bBiosEnabled( true )
+    m_pu8FixedRomBank( NULL ),
+    m_pu8RomBank( NULL ),
+    m_pu8RamBank( NULL ),
+    m_u32RamBankSize( 0x2000 ),
+    m_bRamEnabled( false ),
+    m_bBiosEnabled( true ),
+    m_bOamDmaActive( false )
 {
-    // Map the default MMIO handlers
-    for( int i = MMIORegisterStart; i <= MMIORegisterEnd; ++i )
+    // Registers nobody claims read back what was written to them
+    for( uint32 i = 0; i < kMMIOHandlerCount; ++i )
     {
-        RegisterMMIOHandlers( (MMIORegister)i, 
-                              &m_oNullMMIORegister[ i & 0xff ], 
-                              static_cast<MMIOReadHandler>( &GBNullMMIORegister::ReadRegisterNoop ),
-                              static_cast<MMIOWriteHandler>( &GBNullMMIORegister::WriteRegisterNoop ) );
+        m_MMIOReadHandlers[ i ]     = MMIOReadHandlerEntry( NULL, NULL );
+        m_MMIOWriteHandlers[ i ]    = MMIOWriteHandlerEntry( NULL, NULL );
     }
 
     SetMMIORegisterHandlers<GBMem>( this, MMIOBiosDisabled, &GBMem::GetBiosDisabledRegister, &GBMem::SetBiosDisabledRegister );
@@ -54,46 +58,125 @@ GBMem::~GBMem( void )
 void GBMem::Reset()
 {
     m_pMemBankController    = NULL;
+    m_pu8FixedRomBank       = NULL;
+    m_pu8RomBank            = NULL;
+    m_pu8RamBank            = NULL;
+    m_u32RamBankSize        = 0x2000;
+    m_bRamEnabled           = false;
 
     m_bBiosEnabled          = GBUserPrefs::Instance()->IsBiosEnabled();
+    m_bOamDmaActive         = false;
 
-    memset( m_pu8Memory, 0, sizeof( m_pu8Memory ) );
+    memset( m_pu8Storage, 0, sizeof( m_pu8Storage ) );
+    MarkPagesDirty( 0, kGBTotalMemSizeBytes );
+
+    // Drop the cartridge pages before the handlers run, a DMA reset reads through them
+    UpdatePageTables();
 
     // Reset all of the MMIO handlers
     // TODO: Investigate if setting predetermined values is necessary when skipping bios
-    for( int i = MMIORegisterStart; i <= MMIORegisterEnd; ++i )
+    for( uint32 i = 0; i < kMMIOHandlerCount; ++i )
     {
-        auto callback = m_MMIOWriteHandlers[ (MMIORegister)i ];
+        const MMIOWriteHandlerEntry& callback = m_MMIOWriteHandlers[ i ];
         auto pController = callback.first;
         auto pfnHandler = callback.second;
 
         // Invoke the register handler
-        ( pController->*pfnHandler )( 0 );
+        if( NULL != pController )
+        {
+            ( pController->*pfnHandler )( 0 );
+        }
     }
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBMem::LoadMemory( ubyte* pData, uint32 u32Offset, size_t size )
 {
-    memcpy( m_pu8Memory + u32Offset, pData, size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        ubyte* pu8Data = GetStorage( static_cast<uint16>( u32Offset + i ) );
+        if( NULL != pu8Data )
+        {
+            *pu8Data = pData[ i ];
+        }
+    }
+    MarkPagesDirty( u32Offset, static_cast<uint32>( size ) );
 }
 
 //----------------------------------------------------------------------------------------------------
-ubyte GBMem::ReadMemory( uint16 u16Address )
+void GBMem::UpdatePageTables()
 {
-    if(     m_bBiosEnabled
-        &&  u16Address < kGBBiosSizeBytes )
+    for( uint32 u32Page = 0; u32Page < kPageCount; ++u32Page )
     {
-        return m_pu8GBBios[ u16Address ];
+        uint32  u32Address  = u32Page << kPageShift;
+        ubyte*  pu8Page     = GetStorage( static_cast<uint16>( u32Address ) );
+
+        // VRAM, WRAM and OAM are plain memory. The MMIO page needs a handler, ROM writes
+        // program the MBC and cartridge RAM writes go through it to mark the battery dirty.
+        bool    bPlainRam   =   ( u32Address >= 0x8000 && u32Address < 0xA000 )
+                            ||  ( u32Address >= 0xC000 && u32Address < 0xE000 )
+                            ||  0xFE00 == u32Address;
+
+        // Echo RAM is the WRAM it mirrors, not a copy of it
+        if( u32Address >= 0xE000 && u32Address < 0xFE00 )
+        {
+            bPlainRam   = true;
+        }
+
+        m_pReadPages[ u32Page ]     = bPlainRam ? pu8Page : NULL;
+        m_pWritePages[ u32Page ]    = bPlainRam ? pu8Page : NULL;
+
+        // Bank 0 is read straight from the cartridge image
+        if( u32Address < 0x4000 && NULL != m_pu8FixedRomBank )
+        {
+            m_pReadPages[ u32Page ] = m_pu8FixedRomBank + u32Address;
+        }
+    }
+
+    // Switchable ROM and cartridge RAM read straight from the banks published by the MBC
+    MapRomBank( m_pu8RomBank );
+    MapRamBank( m_pu8RamBank, m_u32RamBankSize, m_bRamEnabled );
+
+    // The BIOS covers the first page until 0xFF50 unmaps it
+    if( m_bBiosEnabled )
+    {
+        m_pReadPages[ 0 ] = m_pu8GBBios;
+    }
+
+    // Nothing is plain memory to the CPU while OAM DMA owns the bus
+    if( m_bOamDmaActive )
+    {
+        memset( m_pReadPages, 0, sizeof( m_pReadPages ) );
+        memset( m_pWritePages, 0, sizeof( m_pWritePages ) );
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+ubyte GBMem::ReadMemorySlow( uint16 u16Address )
+{
+    if( m_bOamDmaActive && u16Address < 0xFF00 )
+    {
+        return 0xFF;
+    }
+
+    // HRAM shares the last page with the registers but is plain memory
+    if( u16Address >= 0xFF80 && u16Address < 0xFFFF )
+    {
+        return m_pu8Storage[ kStorageHigh + ( u16Address & 0xFF ) ];
     }
 
     // Handle MMIO registers if the address begins with 0xffxx
     if( 0xFF00 == ( u16Address & 0xFF00 ) )
     {
-        auto callback    = m_MMIROReadHandlers[ (MMIORegister)u16Address ];
+        const MMIOReadHandlerEntry& callback = m_MMIOReadHandlers[ GetMMIOHandlerIndex( u16Address ) ];
         auto pController = callback.first;
         auto pfnHandler  = callback.second;
 
+        if( NULL == pController )
+        {
+            return m_pu8Storage[ kStorageHigh + ( u16Address & 0xFF ) ];
+        }
+
         // Invoke the register handler
         return ( pController->*pfnHandler )( );
     }
@@ -105,7 +188,7 @@ ubyte GBMem::ReadMemory( uint16 u16Address )
 
     if( u16Address >= 0xA000 && u16Address < 0xC000 )
     {
-        if( m_pMemBankController->IsRamEnabled() )
+        if( m_bRamEnabled )
         {
             return m_pMemBankController->ReadRamBank( u16Address );
         }
@@ -115,19 +198,39 @@ ubyte GBMem::ReadMemory( uint16 u16Address )
         }
     }
 
-    return m_pu8Memory[ u16Address ];
+    // ROM before a cartridge is mapped
+    return 0x00;
 }
 
 //----------------------------------------------------------------------------------------------------
-void GBMem::WriteMemory( uint16 u16Address, ubyte u8Data )
+void GBMem::WriteMemorySlow( uint16 u16Address, ubyte u8Data )
 {
+    if( m_bOamDmaActive && u16Address < 0xFF00 )
+    {
+        return;
+    }
+
+    // HRAM shares the last page with the registers but is plain memory
+    if( u16Address >= 0xFF80 && u16Address < 0xFFFF )
+    {
+        m_pu8Storage[ kStorageHigh + ( u16Address & 0xFF ) ] = u8Data;
+        MarkPageDirty( u16Address );
+        return;
+    }
+
     // Handle MMIO registers if the address begins with 0xffxx
     if( 0xFF00 == ( u16Address & 0xFF00 ) )
     {
-        auto callback    = m_MMIOWriteHandlers[ (MMIORegister)u16Address ];
+        const MMIOWriteHandlerEntry& callback = m_MMIOWriteHandlers[ GetMMIOHandlerIndex( u16Address ) ];
         auto pController = callback.first;
         auto pfnHandler  = callback.second;
 
+        if( NULL == pController )
+        {
+            m_pu8Storage[ kStorageHigh + ( u16Address & 0xFF ) ] = u8Data;
+            return;
+        }
+
         // Invoke the register handler
         ( pController->*pfnHandler )( u8Data );
         return;
@@ -136,36 +239,145 @@ void GBMem::WriteMemory( uint16 u16Address, ubyte u8Data )
     if(     u16Address < 0x8000
         ||    ( u16Address >= 0xA000
             &&  u16Address < 0xC000
-            &&  m_pMemBankController->IsRamEnabled() ) )
+            &&  m_bRamEnabled ) )
     {
         m_pMemBankController->WriteMemory( u16Address, u8Data );
-    }
-    else
-    {
-        m_pu8Memory[ u16Address ] = u8Data;
 
-        // Handle echo ram
-        if( u16Address >= 0xC000 && u16Address < 0xDE00 )
+        // ROM writes only program the controller
+        if( u16Address >= 0xA000 )
         {
-            m_pu8Memory[ u16Address + 0x2000 ] = u8Data;
+            MarkPageDirty( u16Address );
         }
-        if( u16Address >= 0xE000 && u16Address < 0xFE00 )
+    }
+
+    // Cartridge RAM writes while it is disabled go nowhere
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::SetMemBankController( IGBMemBankController* pMBC )
+{
+    m_pMemBankController    = pMBC;
+    m_pu8RomBank            = NULL;
+    m_pu8RamBank            = NULL;
+    m_u32RamBankSize        = 0x2000;
+    m_bRamEnabled           = false;
+
+    UpdatePageTables();
+
+    // The controller publishes its initial banks
+    if( NULL != pMBC )
+    {
+        pMBC->AttachMemory( this );
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::MapFixedRomBank( ubyte* pu8RomBank )
+{
+    m_pu8FixedRomBank = pu8RomBank;
+
+    UpdatePageTables();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::MapRomBank( ubyte* pu8RomBank )
+{
+    m_pu8RomBank = pu8RomBank;
+    if( m_bOamDmaActive )
+    {
+        return;
+    }
+
+    for( uint32 u32Page = ( 0x4000 >> kPageShift ); u32Page < ( 0x8000 >> kPageShift ); ++u32Page )
+    {
+        m_pReadPages[ u32Page ] = ( NULL != pu8RomBank ) ? pu8RomBank + ( ( u32Page << kPageShift ) - 0x4000 ) : NULL;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::MapRamBank( ubyte* pu8RamBank, uint32 u32RamBankSize, bool bRamEnabled )
+{
+    // Everything under the window changes when another bank is switched in
+    if( pu8RamBank != m_pu8RamBank || u32RamBankSize != m_u32RamBankSize || bRamEnabled != m_bRamEnabled )
+    {
+        MarkPagesDirty( 0xA000, 0x2000 );
+    }
+
+    m_pu8RamBank        = pu8RamBank;
+    m_u32RamBankSize    = u32RamBankSize;
+    m_bRamEnabled       = bRamEnabled;
+    if( m_bOamDmaActive )
+    {
+        return;
+    }
+
+    for( uint32 u32Page = ( 0xA000 >> kPageShift ); u32Page < ( 0xC000 >> kPageShift ); ++u32Page )
+    {
+        m_pReadPages[ u32Page ] = ( bRamEnabled && NULL != pu8RamBank ) ? pu8RamBank + ( ( ( u32Page << kPageShift ) - 0xA000 ) & ( u32RamBankSize - 1 ) ) : NULL;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::StartOamDma( ubyte u8SourcePage )
+{
+    // A transfer restarted before the last one finished reads through the unrestricted tables
+    EndOamDma();
+
+    // Sources past WRAM read its echo
+    uint16          u16Source   = u8SourcePage << kPageShift;
+    if( u16Source >= 0xE000 )
+    {
+        u16Source -= 0x2000;
+    }
+
+    // Plain memory and mapped banks are copied in one go, the rest asks the MBC or the registers
+    const ubyte*    pu8Source   = m_pReadPages[ u16Source >> kPageShift ];
+    if( NULL != pu8Source )
+    {
+        memcpy( m_pu8Storage + kStorageOam, pu8Source, kOamSizeBytes );
+    }
+    else
+    {
+        for( uint16 i = 0; i < kOamSizeBytes; ++i )
         {
-            m_pu8Memory[ u16Address - 0x2000 ] = u8Data;
+            m_pu8Storage[ kStorageOam + i ] = ReadMemorySlow( u16Source + i );
         }
     }
+    MarkPageDirty( kOamAddress );
+
+    // Everything goes to the slow path until the transfer ends
+    m_bOamDmaActive = true;
+    memset( m_pReadPages, 0, sizeof( m_pReadPages ) );
+    memset( m_pWritePages, 0, sizeof( m_pWritePages ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::EndOamDma()
+{
+    if( m_bOamDmaActive )
+    {
+        m_bOamDmaActive = false;
+        UpdatePageTables();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+ubyte GBMem::GetRomBank() const
+{
+    // Bank currently mapped at 0x4000-0x7FFF
+    return m_pMemBankController->GetRomBank();
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBMem::RegisterMMIOReadHandler( MMIORegister eMMIORegister, GBMMIORegister* pRegisterController, MMIOReadHandler fnHandler )
 {
-    m_MMIROReadHandlers[ eMMIORegister ] = std::make_pair( pRegisterController, fnHandler );
+    m_MMIOReadHandlers[ GetMMIOHandlerIndex( eMMIORegister ) ] = std::make_pair( pRegisterController, fnHandler );
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBMem::RegisterMMIOWriteHandler( MMIORegister eMMIORegister, GBMMIORegister* pRegisterController, MMIOWriteHandler fnHandler )
 {
-    m_MMIOWriteHandlers[ eMMIORegister ] = std::make_pair( pRegisterController, fnHandler );
+    m_MMIOWriteHandlers[ GetMMIOHandlerIndex( eMMIORegister ) ] = std::make_pair( pRegisterController, fnHandler );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -175,16 +387,64 @@ void GBMem::RegisterMMIOHandlers( MMIORegister eMMIORegister, GBMMIORegister* pR
     RegisterMMIOWriteHandler( eMMIORegister, pRegisterController, fnWriteHandler );
 }
 
+//----------------------------------------------------------------------------------------------------
+void GBMem::TakeDirtyPages( uint64 pu64DirtyPages[ kDirtyWordCount ] )
+{
+    FoldEchoDirtyPages();
+
+    memcpy( pu64DirtyPages, m_pu64DirtyPages, sizeof( m_pu64DirtyPages ) );
+    memset( m_pu64DirtyPages, 0, sizeof( m_pu64DirtyPages ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+bool GBMem::TakeDirtyPage( uint32 u32Page )
+{
+    FoldEchoDirtyPages();
+
+    uint64  u64Bit      = 1ull << ( u32Page & 63 );
+    bool    bDirty      = 0 != ( m_pu64DirtyPages[ u32Page >> 6 ] & u64Bit );
+
+    m_pu64DirtyPages[ u32Page >> 6 ] &= ~u64Bit;
+
+    return bDirty;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::FoldEchoDirtyPages()
+{
+    // Writes through echo RAM mark the echo page, move them onto the WRAM page they landed in. Pages
+    // 0xC0-0xDD and 0xE0-0xFD are the low and high halves of the last word.
+    const uint64    u64EchoMask = ( 1ull << ( ( 0xFE00 - 0xE000 ) >> kPageShift ) ) - 1;
+    uint64&         u64Word     = m_pu64DirtyPages[ kDirtyWordCount - 1 ];
+
+    u64Word = ( u64Word & ~( u64EchoMask << 32 ) ) | ( ( u64Word >> 32 ) & u64EchoMask );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMem::MarkPagesDirty( uint32 u32Address, uint32 u32Size )
+{
+    if( 0 == u32Size )
+    {
+        return;
+    }
+
+    uint32 u32LastPage = ( u32Address + u32Size - 1 ) >> kPageShift;
+    for( uint32 u32Page = u32Address >> kPageShift; u32Page <= u32LastPage && u32Page < kPageCount; ++u32Page )
+    {
+        m_pu64DirtyPages[ u32Page >> 6 ] |= 1ull << ( u32Page & 63 );
+    }
+}
+
 //----------------------------------------------------------------------------------------------------
 OamData GBMem::ReadSpriteData( uint32 u32Slot ) const
 {
-    OamData   oSpriteData;
-    uint16    u16BaseAddress    = 0xFE00 + ( u32Slot * sizeof( oSpriteData ) );
+    OamData         oSpriteData;
+    const ubyte*    pu8Sprite   = m_pu8Storage + kStorageOam + ( u32Slot * sizeof( oSpriteData ) );
 
-    oSpriteData.y               = m_pu8Memory[ u16BaseAddress + 0 ];
-    oSpriteData.x               = m_pu8Memory[ u16BaseAddress + 1 ];
-    oSpriteData.tileIndex       = m_pu8Memory[ u16BaseAddress + 2 ];
-    oSpriteData.attributeFlags  = m_pu8Memory[ u16BaseAddress + 3 ];
+    oSpriteData.y               = pu8Sprite[ 0 ];
+    oSpriteData.x               = pu8Sprite[ 1 ];
+    oSpriteData.tileIndex       = pu8Sprite[ 2 ];
+    oSpriteData.attributeFlags  = pu8Sprite[ 3 ];
 
     return oSpriteData;
 }
@@ -192,20 +452,20 @@ OamData GBMem::ReadSpriteData( uint32 u32Slot ) const
 //----------------------------------------------------------------------------------------------------
 ubyte GBMem::DebugReadMemory( uint16 u16Address )
 {
-    return m_pu8Memory[ u16Address ];
+    // Only the storage this module owns, ROM and cartridge RAM read as 0
+    const ubyte* pu8Data = GetStorage( u16Address );
+
+    return ( NULL != pu8Data ) ? *pu8Data : 0x00;
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBMem::DebugWriteMemory( uint16 u16Address, ubyte u8Data )
 {
-    m_pu8Memory[ u16Address ] = u8Data;
+    LoadMemory( &u8Data, u16Address, 1 );
 }
 
 //----------------------------------------------------------------------------------------------------
 void GBMem::DebugWriteMemory( uint16 u16Address, ubyte u8Data[], uint16 u16Size )
 {
-    for( uint16 i = 0; i < u16Size; ++i )
-    {
-        m_pu8Memory[ u16Address + i ] = u8Data[ i ];
-    }
+    LoadMemory( u8Data, u16Address, u16Size );
 }
\ No newline at end of file
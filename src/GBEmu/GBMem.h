@@ -13,7 +13,6 @@
 
 #include "emutypes.h"
 
-#include <map>
 #include <utility>
 
 #include "GBMMIORegister.h"
@@ -44,10 +43,37 @@ class GBMem : public GBMMIORegister
     //====================================================================================================
     // Class Typedefs
     //====================================================================================================
-    typedef std::map<MMIORegister, std::pair<GBMMIORegister*, MMIOReadHandler>> MMIOReadHandlers;
-    typedef std::map<MMIORegister, std::pair<GBMMIORegister*, MMIOWriteHandler>> MMIOWriteHandlers;
+    typedef std::pair<GBMMIORegister*, MMIOReadHandler>     MMIOReadHandlerEntry;
+    typedef std::pair<GBMMIORegister*, MMIOWriteHandler>    MMIOWriteHandlerEntry;
 
 public:
+    // Class constants
+    enum
+    {
+        kPageShift          = 8,
+        kPageSize           = 1 << kPageShift,
+        kPageCount          = kGBTotalMemSizeBytes >> kPageShift,
+        kDirtyWordCount     = kPageCount / 64,
+        kOamAddress         = 0xFE00,
+        kOamSizeBytes       = 0xA0
+    };
+
+private:
+    // Only the RAM backed parts of the address space have storage, ROM and cartridge RAM belong to the
+    // cartridge and echo RAM is WRAM
+    enum
+    {
+        kStorageVRam        = 0x0000,   // 0x8000-0x9FFF
+        kStorageWRam        = 0x2000,   // 0xC000-0xDFFF
+        kStorageOam         = 0x4000,   // 0xFE00-0xFEFF
+        kStorageHigh        = 0x4100,   // 0xFF00-0xFFFF, HRAM and the registers nothing has claimed
+        kStorageSizeBytes   = 0x4200,
+
+        kMMIOHandlerCount   = 0x81      // 0xFF00-0xFF7F and 0xFFFF, HRAM sits between them
+    };
+
+public:
+
     // Constructor / destructor
     GBMem( void );
     virtual ~GBMem( void );
@@ -56,38 +82,141 @@ public:
 
     void                    LoadMemory( ubyte* pData, uint32 u32Offset, size_t size );
 
-    ubyte                   ReadMemory( uint16 u16Address );
-    void                    WriteMemory( uint16 u16Address, ubyte u8Data );
+    // Plain memory is reached through the page tables, everything else goes to the slow path
+    inline ubyte            ReadMemory( uint16 u16Address );
+    inline void             WriteMemory( uint16 u16Address, ubyte u8Data );
+
+    // The GPU reads VRAM on its own bus, it isn't affected by the CPU's view of memory
+    inline ubyte            ReadVideoMemory( uint16 u16Address ) const                      { return m_pu8Storage[ kStorageVRam + u16Address - 0x8000 ]; }
 
     OamData                 ReadSpriteData( uint32 u32Slot ) const;
     void                    WriteSpriteData( uint32 u32Slot );
 
-    inline void             SetMemBankController( IGBMemBankController* pMBC )              { m_pMemBankController = pMBC;      }
+    void                    SetMemBankController( IGBMemBankController* pMBC );
+    ubyte                   GetRomBank() const;
+
+    // Points 0x0000-0x3FFF at the cartridge image
+    void                    MapFixedRomBank( ubyte* pu8RomBank );
+
+    // Published by the memory bank controller whenever its bank selection or ram enable changes. A NULL
+    // ram bank with ram enabled leaves reads to the controller (e.g. MBC3 clock registers). Banks smaller
+    // than the 8k window repeat across it, so nothing past the cartridge's ram is ever mapped.
+    void                    MapRomBank( ubyte* pu8RomBank );
+    void                    MapRamBank( ubyte* pu8RamBank, uint32 u32RamBankSize, bool bRamEnabled );
+
+    // Copies the source page into OAM at once. Until EndOamDma() the CPU only reaches HRAM and the
+    // registers, everything else reads 0xFF and ignores writes.
+    void                    StartOamDma( ubyte u8SourcePage );
+    void                    EndOamDma();
+    inline bool             IsOamDmaActive() const                                          { return m_bOamDmaActive;           }
 
     void                    RegisterMMIOReadHandler( MMIORegister eMMIORegister, GBMMIORegister* pRegisterController, MMIOReadHandler fnHandler );
     void                    RegisterMMIOWriteHandler( MMIORegister eMMIORegister, GBMMIORegister* pRegisterController, MMIOWriteHandler fnHandler );
     void                    RegisterMMIOHandlers( MMIORegister eMMIORegister, GBMMIORegister* pRegisterController, MMIOReadHandler fnReadHandler, MMIOWriteHandler fnWriteHandler );
 
+    // One bit per page written since it was last taken, bit ( page & 63 ) of word ( page >> 6 ).
+    // Cartridge RAM pages are also marked when a different bank is switched in under them, echo RAM
+    // writes are reported on the WRAM page they land in.
+    void                    TakeDirtyPages( uint64 pu64DirtyPages[ kDirtyWordCount ] );
+    bool                    TakeDirtyPage( uint32 u32Page );
+    void                    MarkPagesDirty( uint32 u32Address, uint32 u32Size );
+
     ubyte                   DebugReadMemory( uint16 u16Address );
     void                    DebugWriteMemory( uint16 u16Address, ubyte u8Data );
     void                    DebugWriteMemory( uint16 u16Address, ubyte u8Data[], uint16 u16Size );
 
 private:
     inline ubyte            GetBiosDisabledRegister() const                                 { return !m_bBiosEnabled;           }
-    inline void             SetBiosDisabledRegister( ubyte u8Data )                         { m_bBiosEnabled = ( 0 == u8Data ); }
+    inline void             SetBiosDisabledRegister( ubyte u8Data )                         { m_bBiosEnabled = ( 0 == u8Data ); UpdatePageTables(); }
+    inline ubyte*           GetStorage( uint16 u16Address );
+    static inline uint32    GetMMIOHandlerIndex( uint32 u32Address )                        { return ( u32Address & 0x80 ) ? 0x80 : ( u32Address & 0x7F ); }
+    inline void             MarkPageDirty( uint16 u16Address )                              { m_pu64DirtyPages[ u16Address >> 14 ] |= 1ull << ( ( u16Address >> kPageShift ) & 63 ); }
+
+    void                    UpdatePageTables();
+    void                    FoldEchoDirtyPages();
+    ubyte                   ReadMemorySlow( uint16 u16Address );
+    void                    WriteMemorySlow( uint16 u16Address, ubyte u8Data );
 
 private:
     ubyte                   m_pu8GBBios[ kGBBiosSizeBytes ];
 
-    ubyte                   m_pu8Memory[ kGBTotalMemSizeBytes ];
+    ubyte                   m_pu8Storage[ kStorageSizeBytes ];
 
-    GBNullMMIORegister      m_oNullMMIORegister[ kGBMMIORegisterCount ];
-    MMIOReadHandlers        m_MMIROReadHandlers;
-    MMIOWriteHandlers       m_MMIOWriteHandlers;
+    // Host memory behind each 256 byte page, NULL for pages that need a handler
+    ubyte*                  m_pReadPages[ kPageCount ];
+    ubyte*                  m_pWritePages[ kPageCount ];
+
+    // Indexed by GetMMIOHandlerIndex(), registers without a controller are plain memory
+    MMIOReadHandlerEntry    m_MMIOReadHandlers[ kMMIOHandlerCount ];
+    MMIOWriteHandlerEntry   m_MMIOWriteHandlers[ kMMIOHandlerCount ];
+
+    uint64                  m_pu64DirtyPages[ kDirtyWordCount ];
 
     IGBMemBankController*   m_pMemBankController;
+    ubyte*                  m_pu8FixedRomBank;
+    ubyte*                  m_pu8RomBank;
+    ubyte*                  m_pu8RamBank;
+    uint32                  m_u32RamBankSize;
+    bool                    m_bRamEnabled;
 
     bool                    m_bBiosEnabled;
+    bool                    m_bOamDmaActive;
 };
 
+//====================================================================================================
+// Inline Methods
+//====================================================================================================
+
+inline ubyte GBMem::ReadMemory( uint16 u16Address )
+{
+    const ubyte* pu8Page = m_pReadPages[ u16Address >> kPageShift ];
+    if( NULL != pu8Page )
+    {
+        return pu8Page[ u16Address & ( kPageSize - 1 ) ];
+    }
+
+    return ReadMemorySlow( u16Address );
+}
+
+//----------------------------------------------------------------------------------------------------
+inline ubyte* GBMem::GetStorage( uint16 u16Address )
+{
+    // NULL for the parts that aren't backed by this module
+    if( u16Address >= 0xFE00 )
+    {
+        return m_pu8Storage + kStorageOam + ( u16Address - 0xFE00 );
+    }
+
+    if( u16Address >= 0xE000 )
+    {
+        u16Address -= 0x2000;
+    }
+
+    if( u16Address >= 0xC000 )
+    {
+        return m_pu8Storage + kStorageWRam + ( u16Address - 0xC000 );
+    }
+
+    if( u16Address >= 0x8000 && u16Address < 0xA000 )
+    {
+        return m_pu8Storage + kStorageVRam + ( u16Address - 0x8000 );
+    }
+
+    return NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+inline void GBMem::WriteMemory( uint16 u16Address, ubyte u8Data )
+{
+    ubyte* pu8Page = m_pWritePages[ u16Address >> kPageShift ];
+    if( NULL != pu8Page )
+    {
+        pu8Page[ u16Address & ( kPageSize - 1 ) ] = u8Data;
+        MarkPageDirty( u16Address );
+        return;
+    }
+
+    WriteMemorySlow( u16Address, u8Data );
+}
+
 #endif
\ No newline at end of file
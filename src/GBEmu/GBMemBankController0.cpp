@@ -10,6 +10,8 @@
 
 #include "GBMemBankController0.h"
 
+#include "GBMem.h"
+
 //====================================================================================================
 // Class
 //====================================================================================================
@@ -42,4 +44,12 @@ ubyte GBMemBankController0::ReadRamBank( uint16 u16Address )
 void GBMemBankController0::WriteMemory( uint16 u16Address, ubyte u8Data )
 {
 
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController0::AttachMemory( GBMem* pMem )
+{
+    // Nothing to switch, the second rom bank is mapped for good
+    pMem->MapRomBank( m_pRomBank + 0x4000 );
+    pMem->MapRamBank( NULL, 0x2000, false );
 }
\ No newline at end of file
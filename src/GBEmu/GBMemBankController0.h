@@ -32,6 +32,9 @@ public:
     bool            IsRamEnabled() const            { return false;        }
     bool            IsRamDirty() const              { return false;        }
     void            SetRamDirty( bool bFlag )       {}
+    ubyte           GetRomBank() const              { return 1;            }
+
+    void            AttachMemory( GBMem* pMem );
 
 private:
     ubyte*          m_pRomBank;
@@ -10,14 +10,20 @@
 
 #include "GBMemBankController1.h"
 
+#include "GBMem.h"
+
 #include <cassert>
 
 //====================================================================================================
 // Class
 //====================================================================================================
-GBMemBankController1::GBMemBankController1( ubyte* pRomBank, ubyte* pRamBank ) :
+GBMemBankController1::GBMemBankController1( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank, uint32 u32RamBytes ) :
     m_pRomBank( pRomBank ),
     m_pRamBank( pRamBank ),
+    m_pMem( NULL ),
+    m_u8RomBankMask( static_cast<ubyte>( u32RomBanks - 1 ) ),
+    m_u8RamBankMask( static_cast<ubyte>( ( u32RamBytes > 0x2000 ) ? ( u32RamBytes >> 13 ) - 1 : 0 ) ),
+    m_u16RamAddressMask( static_cast<uint16>( ( ( u32RamBytes < 0x2000 ) ? u32RamBytes : 0x2000 ) - 1 ) ),
     m_bRamEnabled( false ),
     m_bRamBankMode( false ),
     m_bRamDirty( false ),
@@ -48,7 +54,7 @@ ubyte GBMemBankController1::ReadRomBank( uint16 u16Address )
 ubyte GBMemBankController1::ReadRamBank( uint16 u16Address )
 {
     uint32 u32RamOffset    = m_bRamEnabled ? ( ( 1 << 13 ) * ( m_u8SelectedRamBank ) ) : 0;
-    uint32 u32Address = u16Address + u32RamOffset - 0xA000;
+    uint32 u32Address = ( ( u16Address - 0xA000 ) & m_u16RamAddressMask ) + u32RamOffset;
     return m_pRamBank[ u32Address ];
 }
 
@@ -58,6 +64,7 @@ void GBMemBankController1::WriteMemory( uint16 u16Address, ubyte u8Data )
     if( u16Address >= 0x0000 && u16Address < 0x2000 )
     {
         m_bRamEnabled = 0 != ( u8Data & 0x0A );
+        PublishBanks();
     }
     else if( u16Address >= 0x2000 && u16Address < 0x4000 )
     {
@@ -79,7 +86,7 @@ void GBMemBankController1::WriteMemory( uint16 u16Address, ubyte u8Data )
     else if( u16Address >= 0xA000 && u16Address < 0xC000 )
     {
         uint32 u32RamOffset    = m_bRamEnabled ? ( ( 1 << 13 ) * ( m_u8SelectedRamBank ) ) : 0;
-        uint32 u32Address = u16Address + u32RamOffset - 0xA000;
+        uint32 u32Address = ( ( u16Address - 0xA000 ) & m_u16RamAddressMask ) + u32RamOffset;
         
         m_pRamBank[ u32Address ] = u8Data;
 
@@ -99,7 +106,7 @@ void GBMemBankController1::UpdateBankValues()
     if( m_bRamBankMode )
     {
         m_u8SelectedRomBank = m_u8BankSelect0;
-        m_u8SelectedRamBank = m_u8BankSelect1;
+        m_u8SelectedRamBank = m_u8BankSelect1 & m_u8RamBankMask;
     }
     else
     {
@@ -117,4 +124,30 @@ void GBMemBankController1::UpdateBankValues()
             m_u8SelectedRomBank++;
         break;
     }
+
+    // Selects past the end of the ROM wrap around, as the unconnected bank lines do on hardware
+    m_u8SelectedRomBank &= m_u8RomBankMask;
+
+    PublishBanks();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController1::AttachMemory( GBMem* pMem )
+{
+    m_pMem = pMem;
+    PublishBanks();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController1::PublishBanks()
+{
+    if( NULL == m_pMem )
+    {
+        return;
+    }
+
+    ubyte* pu8RamBank = ( NULL != m_pRamBank ) ? m_pRamBank + ( ( 1 << 13 ) * m_u8SelectedRamBank ) : NULL;
+
+    m_pMem->MapRomBank( m_pRomBank + ( m_u8SelectedRomBank << 14 ) );
+    m_pMem->MapRamBank( pu8RamBank, m_u16RamAddressMask + 1, IsRamEnabled() );
 }
\ No newline at end of file
@@ -22,7 +22,7 @@
 class GBMemBankController1 : public IGBMemBankController
 {
 public:
-    GBMemBankController1( ubyte* pRomBank, ubyte* pRamBank );
+    GBMemBankController1( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank, uint32 u32RamBytes );
     ~GBMemBankController1();
 
     ubyte           ReadRomBank( uint16 u16Address );
@@ -32,12 +32,20 @@ public:
     bool            IsRamEnabled() const;
     bool            IsRamDirty() const              { return m_bRamDirty;   }
     inline void     SetRamDirty( bool bFlag )       { m_bRamDirty = bFlag;  }
+    ubyte           GetRomBank() const              { return m_u8SelectedRomBank;   }
+
+    void            AttachMemory( GBMem* pMem );
 
 private:
+    void            PublishBanks();
     void            UpdateBankValues();
 
     ubyte*          m_pRomBank;
     ubyte*          m_pRamBank;
+    GBMem*          m_pMem;
+    ubyte           m_u8RomBankMask;        // Bank selects wrap at the ROM's size, the header bank count is a power of two
+    ubyte           m_u8RamBankMask;        // Same for the ram banks
+    uint16          m_u16RamAddressMask;    // Ram smaller than the 8k window repeats across it
 
     ubyte           m_u8BankSelect0;
     ubyte           m_u8BankSelect1;
@@ -10,14 +10,18 @@
 
 #include "GBMemBankController2.h"
 
+#include "GBMem.h"
+
 #include <cassert>
 
 //====================================================================================================
 // Class
 //====================================================================================================
-GBMemBankController2::GBMemBankController2( ubyte* pRomBank, ubyte* pRamBank ) :
+GBMemBankController2::GBMemBankController2( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank ) :
     m_pRomBank( pRomBank ),
     m_pRamBank( pRamBank ),
+    m_pMem( NULL ),
+    m_u8RomBankMask( static_cast<ubyte>( u32RomBanks - 1 ) ),
     m_bRamEnabled( false ),
     m_bRamDirty( false ),
     m_u8SelectedRomBank( 1 )
@@ -45,7 +49,7 @@ ubyte GBMemBankController2::ReadRamBank( uint16 u16Address )
 {
     if( m_bRamEnabled )
     {
-        uint32 u32Address = u16Address - 0xA000;
+        uint32 u32Address = ( u16Address - 0xA000 ) & ( kRamSize - 1 );
         return m_pRamBank[ u32Address ];
     }
     return 0x00;
@@ -59,13 +63,15 @@ void GBMemBankController2::WriteMemory( uint16 u16Address, ubyte u8Data )
         if( !( u16Address & 0x0100 ) )
         {
             m_bRamEnabled = ( 0x0A == ( u8Data & 0x0F ) );
+            PublishBanks();
         }
     }
     else if( u16Address >= 0x2000 && u16Address < 0x4000 )
     {
         if( u16Address & 0x0100 )
         {
-            m_u8SelectedRomBank = ( u8Data & 0x0F ) + ( (u8Data & 0x0F ) == 0 );
+            m_u8SelectedRomBank = ( ( u8Data & 0x0F ) + ( (u8Data & 0x0F ) == 0 ) ) & m_u8RomBankMask;
+            PublishBanks();
         }
     }
     else if( u16Address >= 0xA000 && u16Address < 0xA200 )
@@ -82,4 +88,23 @@ void GBMemBankController2::WriteMemory( uint16 u16Address, ubyte u8Data )
 bool GBMemBankController2::IsRamEnabled() const
 {
     return m_bRamEnabled && NULL != m_pRamBank;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController2::AttachMemory( GBMem* pMem )
+{
+    m_pMem = pMem;
+    PublishBanks();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController2::PublishBanks()
+{
+    if( NULL == m_pMem )
+    {
+        return;
+    }
+
+    m_pMem->MapRomBank( m_pRomBank + ( m_u8SelectedRomBank << 14 ) );
+    m_pMem->MapRamBank( m_pRamBank, kRamSize, IsRamEnabled() );
 }
\ No newline at end of file
@@ -21,8 +21,14 @@
 
 class GBMemBankController2 : public IGBMemBankController
 {
+    // 512 four bit cells built into the controller, they repeat across the ram window
+    enum
+    {
+        kRamSize    = 0x200
+    };
+
 public:
-    GBMemBankController2( ubyte* pRomBank, ubyte* pRamBank );
+    GBMemBankController2( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank );
     ~GBMemBankController2();
 
     ubyte           ReadRomBank( uint16 u16Address );
@@ -32,10 +38,17 @@ public:
     bool            IsRamEnabled() const;
     bool            IsRamDirty() const              { return m_bRamDirty;   }
     inline void     SetRamDirty( bool bFlag )       { m_bRamDirty = bFlag;  }
+    ubyte           GetRomBank() const              { return m_u8SelectedRomBank;   }
+
+    void            AttachMemory( GBMem* pMem );
 
 private:
+    void            PublishBanks();
+
     ubyte*          m_pRomBank;
     ubyte*          m_pRamBank;
+    GBMem*          m_pMem;
+    ubyte           m_u8RomBankMask;        // Bank selects wrap at the ROM's size, the header bank count is a power of two
 
     bool            m_bRamEnabled;
     bool            m_bRamDirty;
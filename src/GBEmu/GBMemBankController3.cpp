@@ -10,14 +10,20 @@
 
 #include "GBMemBankController3.h"
 
+#include "GBMem.h"
+
 #include <cassert>
 
 //====================================================================================================
 // Class
 //====================================================================================================
-GBMemBankController3::GBMemBankController3( ubyte* pRomBank, ubyte* pRamBank, bool bHasTimer ) :
+GBMemBankController3::GBMemBankController3( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank, uint32 u32RamBytes, bool bHasTimer ) :
     m_pRomBank( pRomBank ),
     m_pRamBank( pRamBank ),
+    m_pMem( NULL ),
+    m_u8RomBankMask( static_cast<ubyte>( u32RomBanks - 1 ) ),
+    m_u8RamBankMask( static_cast<ubyte>( ( u32RamBytes > 0x2000 ) ? ( u32RamBytes >> 13 ) - 1 : 0 ) ),
+    m_u16RamAddressMask( static_cast<uint16>( ( ( u32RamBytes < 0x2000 ) ? u32RamBytes : 0x2000 ) - 1 ) ),
     m_bHasTimer( bHasTimer ),
     m_bLatched( false ),
     m_bRamEnabled( false ),
@@ -58,8 +64,8 @@ ubyte GBMemBankController3::ReadRamBank( uint16 u16Address )
     {
         if( m_u8SelectedRamBank < 0x04 )
         {
-            uint32 u32RamOffset = ( 1 << 13 ) * ( m_u8SelectedRamBank );
-            uint32 u32Address = u16Address + u32RamOffset - 0xA000;
+            uint32 u32RamOffset = ( 1 << 13 ) * ( m_u8SelectedRamBank & m_u8RamBankMask );
+            uint32 u32Address = ( ( u16Address - 0xA000 ) & m_u16RamAddressMask ) + u32RamOffset;
             return m_pRamBank[ u32Address ];
         }
         else if( m_bHasTimer )
@@ -92,14 +98,17 @@ void GBMemBankController3::WriteMemory( uint16 u16Address, ubyte u8Data )
     if( u16Address >= 0x0000 && u16Address < 0x2000 )
     {
         m_bRamEnabled = 0 != ( u8Data & 0x0A );
+        PublishBanks();
     }
     else if( u16Address >= 0x2000 && u16Address < 0x4000 )
     {
-        m_u8SelectedRomBank = u8Data & 0x7F;
+        m_u8SelectedRomBank = u8Data & 0x7F & m_u8RomBankMask;
+        PublishBanks();
     }
     else if( u16Address >= 0x4000 && u16Address < 0x6000 )
     {
         m_u8SelectedRamBank = u8Data;
+        PublishBanks();
     }
     else if( u16Address >= 0x6000 && u16Address < 0x8000 )
     {
@@ -123,8 +132,8 @@ void GBMemBankController3::WriteMemory( uint16 u16Address, ubyte u8Data )
         {
             if( m_u8SelectedRamBank < 4 )
             {
-                uint32 u32RamOffset = m_bRamEnabled ? ( ( 1 << 13 ) * ( m_u8SelectedRamBank ) ) : 0;
-                uint32 u32Address   = u16Address + u32RamOffset - 0xA000;
+                uint32 u32RamOffset = m_bRamEnabled ? ( ( 1 << 13 ) * ( m_u8SelectedRamBank & m_u8RamBankMask ) ) : 0;
+                uint32 u32Address   = ( ( u16Address - 0xA000 ) & m_u16RamAddressMask ) + u32RamOffset;
                 
                 m_pRamBank[ u32Address ] = u8Data;
             }
@@ -154,4 +163,26 @@ void GBMemBankController3::WriteMemory( uint16 u16Address, ubyte u8Data )
 bool GBMemBankController3::IsRamEnabled() const
 {
     return m_bRamEnabled && NULL != m_pRamBank;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController3::AttachMemory( GBMem* pMem )
+{
+    m_pMem = pMem;
+    PublishBanks();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBMemBankController3::PublishBanks()
+{
+    if( NULL == m_pMem )
+    {
+        return;
+    }
+
+    // Banks 0x08-0x0C are the clock registers, which stay behind ReadRamBank
+    ubyte* pu8RamBank = ( NULL != m_pRamBank && m_u8SelectedRamBank < 0x04 ) ? m_pRamBank + ( ( 1 << 13 ) * ( m_u8SelectedRamBank & m_u8RamBankMask ) ) : NULL;
+
+    m_pMem->MapRomBank( m_pRomBank + ( m_u8SelectedRomBank << 14 ) );
+    m_pMem->MapRamBank( pu8RamBank, m_u16RamAddressMask + 1, IsRamEnabled() );
 }
\ No newline at end of file
@@ -22,7 +22,7 @@
 class GBMemBankController3 : public IGBMemBankController
 {
 public:
-    GBMemBankController3( ubyte* pRomBank, ubyte* pRamBank, bool bHasTimer = false );
+    GBMemBankController3( ubyte* pRomBank, uint32 u32RomBanks, ubyte* pRamBank, uint32 u32RamBytes, bool bHasTimer = false );
     ~GBMemBankController3();
 
     ubyte           ReadRomBank( uint16 u16Address );
@@ -32,10 +32,19 @@ public:
     bool            IsRamEnabled() const;
     bool            IsRamDirty() const              { return m_bRamDirty;   }
     inline void     SetRamDirty( bool bFlag )       { m_bRamDirty = bFlag;  }
+    ubyte           GetRomBank() const              { return m_u8SelectedRomBank;   }
+
+    void            AttachMemory( GBMem* pMem );
 
 private:
+    void            PublishBanks();
+
     ubyte*          m_pRomBank;
     ubyte*          m_pRamBank;
+    GBMem*          m_pMem;
+    ubyte           m_u8RomBankMask;        // Bank selects wrap at the ROM's size, the header bank count is a power of two
+    ubyte           m_u8RamBankMask;        // Same for the ram banks
+    uint16          m_u16RamAddressMask;    // Ram smaller than the 8k window repeats across it
 
     bool            m_bHasTimer;
     bool            m_bLatched;
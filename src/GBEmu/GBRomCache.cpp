@@ -0,0 +1,211 @@
+//====================================================================================================
+// Filename:    GBRomCache.cpp
+// Created by:  Jeff Padgham
+// Description: A singleton registry of read only ROM images, keyed by a hash of their contents. Every
+//              cartridge holding the same game shares one image, which is freed with the last reference.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "GBRomCache.h"
+
+#include <string.h>
+#include <fstream>
+
+#include "CLog.h"
+
+//====================================================================================================
+// Static initializers
+//====================================================================================================
+
+GBRomCache* GBRomCache::s_pInstance = NULL;
+
+//====================================================================================================
+// Struct
+//====================================================================================================
+GBRomImage::GBRomImage() :
+    u64Hash( 0 ),
+    u32Size( 0 ),
+    u32RefCount( 0 ),
+    pu8Data( NULL )
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+GBRomImage::~GBRomImage()
+{
+    if( oFile.IsOpen() )
+    {
+        oFile.Close();
+    }
+    else
+    {
+        delete[] pu8Data;
+    }
+
+    pu8Data = NULL;
+}
+
+//====================================================================================================
+// Class
+//====================================================================================================
+GBRomCache::GBRomCache( void )
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+GBRomCache::~GBRomCache( void )
+{
+    for( size_t i = 0; i < m_Images.size(); ++i )
+    {
+        delete m_Images[ i ];
+    }
+    m_Images.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+GBRomCache* GBRomCache::Instance()
+{
+    if( NULL == s_pInstance )
+    {
+        s_pInstance = new GBRomCache();
+    }
+
+    return s_pInstance;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBRomImage* GBRomCache::Acquire( const char* szFilepath, uint32 u32RomSize )
+{
+    // Load and hash outside the lock, another instance of the same game only costs the hash
+    GBRomImage* pImage = LoadImage( szFilepath, u32RomSize );
+    if( NULL == pImage )
+    {
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    for( size_t i = 0; i < m_Images.size(); ++i )
+    {
+        GBRomImage* pCached = m_Images[ i ];
+        if(     pCached->u64Hash == pImage->u64Hash
+            &&  pCached->u32Size == pImage->u32Size
+            &&  0 == memcmp( pCached->pu8Data, pImage->pu8Data, pImage->u32Size ) )
+        {
+            delete pImage;
+
+            ++pCached->u32RefCount;
+            return pCached;
+        }
+    }
+
+    pImage->u32RefCount = 1;
+    m_Images.push_back( pImage );
+
+    return pImage;
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBRomCache::Release( GBRomImage* pImage )
+{
+    if( NULL == pImage )
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    if( 0 == --pImage->u32RefCount )
+    {
+        for( size_t i = 0; i < m_Images.size(); ++i )
+        {
+            if( m_Images[ i ] == pImage )
+            {
+                m_Images.erase( m_Images.begin() + i );
+                break;
+            }
+        }
+
+        delete pImage;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+uint32 GBRomCache::GetImageCount()
+{
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    return static_cast<uint32>( m_Images.size() );
+}
+
+//----------------------------------------------------------------------------------------------------
+size_t GBRomCache::GetImageBytes()
+{
+    std::lock_guard<std::mutex> oLock( m_oMutex );
+
+    size_t Bytes = 0;
+    for( size_t i = 0; i < m_Images.size(); ++i )
+    {
+        Bytes += m_Images[ i ]->u32Size;
+    }
+
+    return Bytes;
+}
+
+//----------------------------------------------------------------------------------------------------
+GBRomImage* GBRomCache::LoadImage( const char* szFilepath, uint32 u32RomSize )
+{
+    GBRomImage* pImage = new GBRomImage();
+    pImage->u32Size = u32RomSize;
+
+    // Map the file when it covers every bank the header declares, so nothing is copied up front.
+    // Short dumps and non regular files are read into a zero filled buffer instead.
+    if(     pImage->oFile.Open( szFilepath )
+        &&  pImage->oFile.GetSize() >= u32RomSize )
+    {
+        pImage->pu8Data = pImage->oFile.GetData();
+    }
+    else
+    {
+        pImage->oFile.Close();
+
+        std::ifstream oFile( szFilepath, std::ios::binary );
+        if( !oFile )
+        {
+            Log()->Write( LOG_COLOR_YELLOW, "Unable to load ROM file!" );
+
+            delete pImage;
+            return NULL;
+        }
+
+        pImage->pu8Data = new ubyte[ u32RomSize ];
+        memset( pImage->pu8Data, 0, u32RomSize );
+
+        oFile.read( reinterpret_cast<char*>( pImage->pu8Data ), u32RomSize );
+        oFile.close();
+    }
+
+    pImage->u64Hash = HashImage( pImage->pu8Data, u32RomSize );
+
+    return pImage;
+}
+
+//----------------------------------------------------------------------------------------------------
+uint64 GBRomCache::HashImage( const ubyte* pu8Data, uint32 u32Size )
+{
+    // FNV-1a over 64 bit words, ROM sizes are always a multiple of 8
+    uint64 u64Hash = 14695981039346656037ULL;
+
+    for( uint32 i = 0; i + sizeof( uint64 ) <= u32Size; i += sizeof( uint64 ) )
+    {
+        uint64 u64Word;
+        memcpy( &u64Word, pu8Data + i, sizeof( u64Word ) );
+
+        u64Hash = ( u64Hash ^ u64Word ) * 1099511628211ULL;
+    }
+
+    return u64Hash;
+}
@@ -0,0 +1,82 @@
+#ifndef GBEMU_GBROMCACHE_H
+#define GBEMU_GBROMCACHE_H
+
+//====================================================================================================
+// Filename:    GBRomCache.h
+// Created by:  Jeff Padgham
+// Description: A singleton registry of read only ROM images, keyed by a hash of their contents. Every
+//              cartridge holding the same game shares one image, which is freed with the last reference.
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "emutypes.h"
+#include "GBMappedFile.h"
+
+#include <mutex>
+#include <vector>
+
+//====================================================================================================
+// Global Structs
+//====================================================================================================
+
+// Treat as read only, the same image backs every instance of the game
+struct GBRomImage
+{
+    uint64                  u64Hash;
+    uint32                  u32Size;
+    uint32                  u32RefCount;
+    ubyte*                  pu8Data;
+    GBMappedFile            oFile;              // Backs pu8Data when the file could be mapped
+
+    GBRomImage();
+    ~GBRomImage();
+};
+
+//====================================================================================================
+// Class
+//====================================================================================================
+
+class GBRomCache
+{
+public:
+    static GBRomCache* Instance();
+
+public:
+    // Returns NULL when the file can't be read. Every image handed out needs a matching Release.
+    GBRomImage*             Acquire( const char* szFilepath, uint32 u32RomSize );
+    void                    Release( GBRomImage* pImage );
+
+    uint32                  GetImageCount();
+    size_t                  GetImageBytes();
+
+private:
+    GBRomImage*             LoadImage( const char* szFilepath, uint32 u32RomSize );
+    static uint64           HashImage( const ubyte* pu8Data, uint32 u32Size );
+
+private:
+    std::mutex              m_oMutex;
+    std::vector<GBRomImage*> m_Images;
+
+protected:
+    // Protected constructor for singleton
+    GBRomCache( void );
+    ~GBRomCache( void );
+
+private:
+    // Static singleton instance
+    static GBRomCache*      s_pInstance;
+};
+
+//====================================================================================================
+// Global Functions
+//====================================================================================================
+
+static GBRomCache* RomCache()
+{
+    return GBRomCache::Instance();
+}
+
+#endif
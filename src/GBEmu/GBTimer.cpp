@@ -16,6 +16,21 @@
 
 #include "CProfileManager.h"
 
+//====================================================================================================
+// Global tables
+//====================================================================================================
+
+// TIMA period as a power of 2 for each timer mode
+static const ubyte kTimerPeriodShift[ 4 ] =
+{
+    10,     // 4096Hz
+    4,      // 262144Hz
+    6,      // 65536Hz
+    8       // 16384Hz
+};
+
+static const uint64 kTimerNever = 0xFFFFFFFFFFFFFFFFULL;
+
 //====================================================================================================
 // Class
 //====================================================================================================
@@ -26,8 +41,9 @@ GBTimer::GBTimer( GBEmulator* pEmulator, GBMem* pMemoryModule ) :
     m_u8DividerRegister( 0 ),
     m_u8CounterRegister( 0 ),
     m_u8ModuloRegister( 0 ),
-    m_u32TimerCycles( 0 ),
-    m_u32TimerDiv( 0 )
+    m_u64Cycles( 0 ),
+    m_u64SyncCycles( 0 ),
+    m_u64OverflowCycle( kTimerNever )
 {
     SetMMIORegisterHandlers<GBTimer>( m_pMem, MMIOTimerControl, &GBTimer::GetControlRegister, &GBTimer::SetControlRegister );
     SetMMIORegisterHandlers<GBTimer>( m_pMem, MMIODivider,      &GBTimer::GetDividerRegister, &GBTimer::SetDividerRegister );
@@ -48,87 +64,119 @@ void GBTimer::Reset()
     m_u8CounterRegister    = 0;
     m_u8ModuloRegister     = 0;
 
-    m_u32TimerCycles       = 0;
-    m_u32TimerDiv          = 0;
+    m_u64Cycles            = 0;
+    m_u64SyncCycles        = 0;
+    m_u64OverflowCycle     = kTimerNever;
 }
 
 //----------------------------------------------------------------------------------------------------
-void GBTimer::Update( uint32 u32ElapsedClockCycles )
+void GBTimer::CatchUp()
 {
-    PROFILE( "Timer::Update" );
+    PROFILE( "Timer::CatchUp" );
 
-    int multiples = u32ElapsedClockCycles >> 2;
-    for( int i = 0; i < multiples; ++i )
-    {
-        // Update the div counter
-        m_u32TimerDiv += 4;
+    // DIV counts up whenever the clock passes a multiple of 256 cycles, writes to it don't reset the phase
+    m_u8DividerRegister += static_cast<ubyte>( ( m_u64Cycles >> 8 ) - ( m_u64SyncCycles >> 8 ) );
 
-        // Update the timer counter
-        m_u32TimerCycles += 4;
+    // TIMA counts up whenever the clock passes a multiple of the period. The clock speed is a multiple of
+    // every period so the ticks line up with the cycles since reset.
+    if( IsTimerEnabled( m_u8ControlRegister ) )
+    {
+        ubyte  u8Shift  = kTimerPeriodShift[ GetTimerMode( m_u8ControlRegister ) ];
+        uint64 u64Ticks = ( m_u64Cycles >> u8Shift ) - ( m_u64SyncCycles >> u8Shift );
 
-        // Keep the counter from overflowing
-        // TODO: Update MBC3's timer here
-        if( m_u32TimerCycles >= GBCpu::CLOCK_SPEED )
+        while( u64Ticks > 0 )
         {
-            m_u32TimerCycles -= GBCpu::CLOCK_SPEED;
-        }
+            uint32 u32TicksToOverflow = 0x100 - m_u8CounterRegister;
+            if( u64Ticks < u32TicksToOverflow )
+            {
+                m_u8CounterRegister += static_cast<ubyte>( u64Ticks );
+                break;
+            }
 
-        if( m_u32TimerDiv >= 256 )
-        {
-            // Update the divider register
-            ++m_u8DividerRegister;
-            m_u32TimerDiv -= 256;
+            u64Ticks -= u32TicksToOverflow;
+
+            // Set the TIMA value to TMA and raise a timer interrupt
+            m_u8CounterRegister = m_u8ModuloRegister;
+            m_pEmulator->RaiseInterrupt( Timer );
         }
+    }
 
-        // Update the timer at the set frequency
-        if( IsTimerEnabled( m_u8ControlRegister ) )
-        {
-            bool bUpdateTimer = false;
+    m_u64SyncCycles = m_u64Cycles;
 
-            switch( GetTimerMode( m_u8ControlRegister ) )
-            {
-                case Freq4096Hz:
-                    if( 0 == ( m_u32TimerCycles & 1023 ) )
-                    {
-                        bUpdateTimer = true;
-                    }
-                    break;
-                case Freq262144Hz:    
-                    if( 0 == ( m_u32TimerCycles & 15 ) )
-                    {
-                        bUpdateTimer = true;
-                    }
-                    break;
-                case Freq65536Hz:
-                    if( 0 == ( m_u32TimerCycles & 63 ) )
-                    {
-                        bUpdateTimer = true;
-                    }    
-                    break;
-                case Freq16384Hz:
-                    if( 0 == ( m_u32TimerCycles & 255 ) )
-                    {
-                        bUpdateTimer = true;
-                    }        
-                    break;
-            }
+    ScheduleOverflow();
+}
 
-            if( bUpdateTimer )
-            {
-                if( 0xFF != m_u8CounterRegister )
-                {
-                    // Just write the updated value to TIMA
-                    ++m_u8CounterRegister;
-                }
-                else
-                {
-                    // Set the TIMA value to TMA
-                    m_u8CounterRegister = m_u8ModuloRegister;
-
-                    // Raise a timer interrupt
-                    m_pEmulator->RaiseInterrupt( Timer );
-                }
-            }
-        }
+//----------------------------------------------------------------------------------------------------
+void GBTimer::ScheduleOverflow()
+{
+    // TIMA has to be caught up to m_u64SyncCycles
+    if( IsTimerEnabled( m_u8ControlRegister ) )
+    {
+        ubyte u8Shift = kTimerPeriodShift[ GetTimerMode( m_u8ControlRegister ) ];
+        m_u64OverflowCycle = ( ( m_u64SyncCycles >> u8Shift ) + 0x100 - m_u8CounterRegister ) << u8Shift;
+    }
+    else
+    {
+        m_u64OverflowCycle = kTimerNever;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBTimer::SetControlRegister( ubyte u8Data )
+{
+    CatchUp();
+    m_u8ControlRegister = u8Data;
+    ScheduleOverflow();
+}
+
+//----------------------------------------------------------------------------------------------------
+ubyte GBTimer::GetDividerRegister() const
+{
+    return m_u8DividerRegister + static_cast<ubyte>( ( m_u64Cycles >> 8 ) - ( m_u64SyncCycles >> 8 ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBTimer::SetDividerRegister( ubyte u8Data )
+{
+    CatchUp();
+    m_u8DividerRegister = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+ubyte GBTimer::GetCounterRegister() const
+{
+    if( !IsTimerEnabled( m_u8ControlRegister ) )
+    {
+        return m_u8CounterRegister;
+    }
+
+    // Update() catches up as soon as TIMA overflows, the ticks since then can't wrap it
+    ubyte u8Shift = kTimerPeriodShift[ GetTimerMode( m_u8ControlRegister ) ];
+    return m_u8CounterRegister + static_cast<ubyte>( ( m_u64Cycles >> u8Shift ) - ( m_u64SyncCycles >> u8Shift ) );
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBTimer::SetCounterRegister( ubyte u8Data )
+{
+    CatchUp();
+    m_u8CounterRegister = u8Data;
+    ScheduleOverflow();
+}
+
+//----------------------------------------------------------------------------------------------------
+void GBTimer::SetModuloRegister( ubyte u8Data )
+{
+    // TMA is only read on overflow, which always catches up first
+    m_u8ModuloRegister = u8Data;
+}
+
+//----------------------------------------------------------------------------------------------------
+int GBTimer::GetCyclesUntilOverflow() const
+{
+    if( !IsTimerEnabled( m_u8ControlRegister ) )
+    {
+        return 0x7FFFFFFF;
     }
+
+    return static_cast<int>( m_u64OverflowCycle - m_u64Cycles );
 }
\ No newline at end of file
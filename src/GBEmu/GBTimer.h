@@ -44,25 +44,30 @@ public:
 
     void            Reset();
 
-    void            Update( uint32 u32ElapsedClockCycles );
-    inline uint32   GetTotalCycles()                                { return m_u32TimerCycles;                  }
+    // Only advances the clock, the registers catch up when they're accessed or TIMA overflows
+    inline void     Update( uint32 u32ElapsedClockCycles )          { m_u64Cycles += u32ElapsedClockCycles; if( m_u64Cycles >= m_u64OverflowCycle ) { CatchUp(); }  }
+    inline uint64   GetTotalCycles() const                          { return m_u64Cycles;                       }
+    int             GetCyclesUntilOverflow() const;
 
     inline ubyte    GetControlRegister() const                      { return m_u8ControlRegister;               }
-    inline void     SetControlRegister( ubyte u8Data )              { m_u8ControlRegister = u8Data;             }
+    void            SetControlRegister( ubyte u8Data );
 
-    inline ubyte    GetDividerRegister() const                      { return m_u8DividerRegister;               }
-    inline void     SetDividerRegister( ubyte u8Data )              { m_u8DividerRegister = 0;                  }
+    ubyte           GetDividerRegister() const;
+    void            SetDividerRegister( ubyte u8Data );
 
-    inline ubyte    GetCounterRegister() const                      { return m_u8CounterRegister;               }
-    inline void     SetCounterRegister( ubyte u8Data )              { m_u8CounterRegister = u8Data;             }
+    ubyte           GetCounterRegister() const;
+    void            SetCounterRegister( ubyte u8Data );
 
     inline ubyte    GetModuloRegister() const                       { return m_u8ModuloRegister;                }
-    inline void     SetModuloRegister( ubyte u8Data )               { m_u8ModuloRegister = u8Data;              }
+    void            SetModuloRegister( ubyte u8Data );
 
 private:
     inline bool     IsTimerEnabled( ubyte u8TimerControl ) const    { return 0 != ( u8TimerControl & 0x04 );    }
     inline ubyte    GetTimerMode( ubyte u8TimerControl ) const      { return u8TimerControl & 0x03;             }
 
+    void            CatchUp();
+    void            ScheduleOverflow();
+
 private:
     GBEmulator*     m_pEmulator;
     GBMem*          m_pMem;
@@ -73,8 +78,10 @@ private:
     ubyte           m_u8CounterRegister;
     ubyte           m_u8ModuloRegister;
 
-    uint32          m_u32TimerCycles;
-    uint32          m_u32TimerDiv;
+    // Cycles since reset, DIV and TIMA hold their values as of m_u64SyncCycles
+    uint64          m_u64Cycles;
+    uint64          m_u64SyncCycles;
+    uint64          m_u64OverflowCycle;     // Cycle TIMA overflows on, never while the timer is off
 };
 
 #endif
\ No newline at end of file
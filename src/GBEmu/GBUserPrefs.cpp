@@ -55,6 +55,7 @@ void GBUserPrefs::Load()
         {
             if( strLine.front() != ';' )
             {
+                oKeyValue.clear();
                 SplitString( strLine, '=', oKeyValue );
                 if( oKeyValue.size() > 1 )
                 {
@@ -67,6 +68,9 @@ void GBUserPrefs::Load()
 
     m_strBiosFilepath = GetPref( "bios_file" );
     m_bBiosEnabled = ValidateBiosFile();
+
+    m_strTraceFilepath = GetPref( "trace_file" );
+    m_strHotSpotFilepath = GetPref( "hotspot_file" );
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -75,6 +79,18 @@ bool GBUserPrefs::IsBiosEnabled() const
     return m_bBiosEnabled;
 }
 
+//----------------------------------------------------------------------------------------------------
+const string& GBUserPrefs::GetTraceFilepath() const
+{
+    return m_strTraceFilepath;
+}
+
+//----------------------------------------------------------------------------------------------------
+const string& GBUserPrefs::GetHotSpotFilepath() const
+{
+    return m_strHotSpotFilepath;
+}
+
 //----------------------------------------------------------------------------------------------------
 void GBUserPrefs::LoadBiosData( ubyte* pDstBuffer )
 {
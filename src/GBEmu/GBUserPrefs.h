@@ -35,6 +35,8 @@ public:
 public:
     void                Load();
     bool                IsBiosEnabled() const;
+    const string&       GetTraceFilepath() const;
+    const string&       GetHotSpotFilepath() const;
     void                LoadBiosData( ubyte* pDstBuffer );
 
 private:
@@ -49,6 +51,8 @@ private:
     map<string,string>  m_UserPrefsMap;
     string              m_strBiosFilepath;
     bool                m_bBiosEnabled;
+    string              m_strTraceFilepath;
+    string              m_strHotSpotFilepath;
 
 protected:
     // Protected constructor for singleton
@@ -13,6 +13,12 @@
 
 #include "emutypes.h"
 
+//====================================================================================================
+// Forward Declarations
+//====================================================================================================
+
+class GBMem;
+
 //====================================================================================================
 // Class
 //====================================================================================================
@@ -26,6 +32,10 @@ public:
     virtual bool    IsRamEnabled() const                            = 0;
     virtual bool    IsRamDirty() const                              = 0;
     virtual void    SetRamDirty( bool bFlag )                       = 0;
+    virtual ubyte   GetRomBank() const                              = 0;
+
+    // Called once by GBMem; the controller then publishes its banks on every change
+    virtual void    AttachMemory( GBMem* pMem )                     = 0;
 };
 
 #endif
\ No newline at end of file
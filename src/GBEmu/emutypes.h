@@ -12,6 +12,9 @@
 // Global typedefs
 //====================================================================================================
 
+typedef unsigned long long  uint64;
+typedef signed long long    sint64;
+
 typedef unsigned int    uint32;
 typedef signed int      sint32;
 
@@ -40,6 +43,30 @@ enum GBGlobalConstants
 
 #define RUN_PROFILE 0
 
+// CPU interpreter core: 1 dispatches through a switch, 0 through the member function pointer tables
+#define CPU_SWITCH_CORE 1
+
+// CPU block cache: 1 executes ROM/WRAM/HRAM code from predecoded basic blocks
+#define CPU_BLOCK_CACHE 1
+
+// CPU lazy flags: 1 records the last ALU operation and only computes Z/N/H/C when something reads F
+#define CPU_LAZY_FLAGS 1
+
+// CPU idle loops: 1 skips polling loops that can't see a change before the next event (needs CPU_BLOCK_CACHE)
+#define CPU_IDLE_LOOPS 1
+
+// CPU trace: 1 records every instruction to the file set by trace_file in userprefs.ini.
+// Read the file back with GBTraceDecode
+#define CPU_TRACE 0
+
+// CPU hot spots: 1 counts instructions and cycles per bank:PC and per opcode and writes them as CSV to
+// the file set by hotspot_file in userprefs.ini on shutdown
+#define CPU_HOTSPOTS 0
+
+// Compact instances: 1 drops the CPU debug history, keeps the screen as shades instead of ARGB and
+// shrinks the block cache, for packing many emulators into one process. The footprint is logged with the other stats.
+#define GB_COMPACT 0
+
 inline void _assert( const char* expression, const char* file, int line )
 {
     fprintf( stderr, "Assertion '%s' failed, file '%s' line '%d'.", expression, file, line );
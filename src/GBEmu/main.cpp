@@ -1,12 +1,25 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "CLog.h"
 #include "GBEmulator.h"
+#include "GBCpuUnitTest.h"
 
 int main( int argc, char* argv[] )
 {
     Log()->Initialize();
 
+    // -test runs the cpu unit tests instead of the emulator, the exit code is the number of failed checks
+    if( argc > 1 && 0 == strcmp( argv[ 1 ], "-test" ) )
+    {
+        GBCpuUnitTest oUnitTest;
+        int iFailures = static_cast<int>( oUnitTest.ExecuteTests() );
+
+        Log()->Terminate();
+
+        return iFailures;
+    }
+
     GBEmulator oEmulator;
     oEmulator.Run();
 
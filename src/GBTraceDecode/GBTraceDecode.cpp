@@ -0,0 +1,87 @@
+//====================================================================================================
+// Filename:    GBTraceDecode.cpp
+// Created by:  Jeff Padgham
+// Description: Prints the instruction traces GBEmu writes when it's built with CPU_TRACE, one line per
+//              instruction.
+//
+//              Usage: GBTraceDecode <trace file> [first entry] [entry count]
+//====================================================================================================
+
+//====================================================================================================
+// Includes
+//====================================================================================================
+
+#include "../GBEmu/GBCpuTrace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//====================================================================================================
+// Main
+//====================================================================================================
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        fprintf( stderr, "Usage: %s <trace file> [first entry] [entry count]\n", argv[ 0 ] );
+        return 1;
+    }
+
+    FILE* pFile = fopen( argv[ 1 ], "rb" );
+    if( NULL == pFile )
+    {
+        fprintf( stderr, "Unable to open %s\n", argv[ 1 ] );
+        return 1;
+    }
+
+    GBCpuTraceFileHeader oHeader;
+    if(     1 != fread( &oHeader, sizeof( oHeader ), 1, pFile )
+        ||  0 != memcmp( oHeader.szMagic, "GBTR", sizeof( oHeader.szMagic ) ) )
+    {
+        fprintf( stderr, "%s is not a trace file\n", argv[ 1 ] );
+        fclose( pFile );
+        return 1;
+    }
+
+    if(     kCpuTraceVersion != oHeader.u32Version
+        ||  sizeof( GBCpuTraceEntry ) != oHeader.u32EntrySize )
+    {
+        fprintf( stderr, "%s is trace version %u, this tool reads version %u\n", argv[ 1 ], oHeader.u32Version, kCpuTraceVersion );
+        fclose( pFile );
+        return 1;
+    }
+
+    uint64 u64First = ( argc > 2 ) ? strtoull( argv[ 2 ], NULL, 0 ) : 0;
+    uint64 u64Count = ( argc > 3 ) ? strtoull( argv[ 3 ], NULL, 0 ) : 0xFFFFFFFFFFFFFFFFULL;
+
+    // Every entry is a delta, the ones before the first printed still have to be read
+    GBCpuTraceEntry oEntry;
+    memset( &oEntry, 0, sizeof( oEntry ) );
+
+    uint64 u64Index = 0;
+    while(      ( u64Index < u64First || u64Index - u64First < u64Count )
+            &&  GBCpuTraceUnpack( pFile, &oEntry ) )
+    {
+        if( u64Index++ < u64First )
+        {
+            continue;
+        }
+
+        const ubyte* r = oEntry.u8Registers;
+        printf( "%12llu  %02X:%04X  %02X  AF=%02X%02X BC=%02X%02X DE=%02X%02X HL=%02X%02X SP=%04X %s%s%s\n",
+            oEntry.u64Cycle,
+            oEntry.u8Bank,
+            oEntry.u16PC,
+            oEntry.u8Opcode,
+            r[ 1 ], r[ 0 ], r[ 3 ], r[ 2 ], r[ 5 ], r[ 4 ], r[ 7 ], r[ 6 ],
+            oEntry.u16SP,
+            ( oEntry.u8State & kCpuTraceIME ) ? "IME " : "",
+            ( oEntry.u8State & kCpuTraceHalt ) ? "HALT " : "",
+            ( oEntry.u8State & kCpuTraceStop ) ? "STOP " : "" );
+    }
+
+    fclose( pFile );
+
+    return 0;
+}